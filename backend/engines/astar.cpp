@@ -1,8 +1,12 @@
 #include <bits/stdc++.h>
+#include "engine_io.hpp"
+#include "bucket_queue.hpp"
 using namespace std;
 
 /*
   A* 4-dir, coste 1, heurística Manhattan.
+  Cola de Dial (bucket_queue.hpp): f de un vecino es f o f+2, así que basta un
+  anillo de 4 cubetas.
   Entrada:
     rows cols sr sc er ec
     grid (0 libre, 1 obstáculo)
@@ -16,78 +20,66 @@ using namespace std;
     Path:
     r c
     ...
+
+  Con --server queda como proceso persistente (INIT/UPDATE/QUERY, ver engine_io.hpp).
 */
 
-struct Node{ int r,c,g,f; };
-struct Cmp{ bool operator()(const Node&a,const Node&b)const{ return (a.f!=b.f)? a.f>b.f : a.g>b.g; } };
 static const int DR[4]={-1,1,0,0}, DC[4]={0,0,-1,1};
-static inline bool inb(int r,int c,int R,int C){ return r>=0&&r<R&&c>=0&&c<C; }
 static inline int H(int r,int c,int er,int ec){ return abs(r-er)+abs(c-ec); }
 
-int main(){
-  ios::sync_with_stdio(false); cin.tie(nullptr);
-  int R,C,sr,sc,er,ec;
-  if(!(cin>>R>>C>>sr>>sc>>er>>ec)){ cout<<"Visited:\nParents:\nPath:\n"; return 0; }
-
-  vector<vector<int>> g(R, vector<int>(C));
-  for(int r=0;r<R;r++) for(int c=0;c<C;c++){ int v; cin>>v; g[r][c]=v?1:0; }
+struct AStarSolver {
+  // Buffers reutilizados entre consultas; solo se limpian las celdas tocadas.
+  vector<int> gCost, par;
+  vector<char> closed;
+  vector<int> touched;
+  DialQueue open;
 
-  auto freeCell=[&](int r,int c){ return inb(r,c,R,C)&&g[r][c]==0; };
-  if(!freeCell(sr,sc) || !freeCell(er,ec)){ cout<<"Visited:\nParents:\nPath:\n"; return 0; }
-  if(sr==er && sc==ec){ cout<<"Visited:\n"<<sr<<" "<<sc<<"\nParents:\nPath:\n"<<sr<<" "<<sc<<"\n"; return 0; }
+  void reset(int N){
+    const int INF=INT_MAX;
+    if((int)gCost.size()!=N){ gCost.assign(N,INF); par.assign(N,-1); closed.assign(N,0); }
+    else for(int v:touched){ gCost[v]=INF; par[v]=-1; closed[v]=0; }
+    touched.clear();
+    open.reset(N,2);
+  }
 
-  const int INF=INT_MAX;
-  vector<vector<int>> gCost(R, vector<int>(C, INF));
-  vector<vector<pair<int,int>>> par(R, vector<pair<int,int>>(C, {-1,-1}));
-  vector<vector<bool>> closed(R, vector<bool>(C,false));
-  priority_queue<Node, vector<Node>, Cmp> open;
-  vector<pair<int,int>> visitedOrder;
+  void solve(const GridMap& G,int sr,int sc,int er,int ec,SearchOutput& out){
+    if(!G.freeCell(sr,sc) || !G.freeCell(er,ec)) return;
+    int s=G.id(sr,sc), t=G.id(er,ec);
+    if(s==t){ out.visit(s); out.path.push_back(s); return; }
 
-  gCost[sr][sc]=0; open.push({sr,sc,0,H(sr,sc,er,ec)});
+    const int INF=INT_MAX;
+    reset(G.R*G.C);
+    gCost[s]=0; touched.push_back(s); open.push(s,H(sr,sc,er,ec));
 
-  while(!open.empty()){
-    auto cur=open.top(); open.pop();
-    int r=cur.r,c=cur.c;
-    if(closed[r][c]) continue;
-    closed[r][c]=true;
-    visitedOrder.push_back({r,c});
-    if(r==er && c==ec) break;
+    while(!open.empty()){
+      uint32_t f;
+      int u=open.pop(f);
+      if(closed[u]) continue;
+      closed[u]=1;
+      out.visit(u);
+      if(u==t) break;
 
-    for(int k=0;k<4;k++){
-      int nr=r+DR[k], nc=c+DC[k];
-      if(!inb(nr,nc,R,C) || g[nr][nc]==1) continue;
-      int ng = gCost[r][c] + 1;
-      if(ng < gCost[nr][nc]){
-        gCost[nr][nc]=ng;
-        par[nr][nc]={r,c};
-        open.push({nr,nc,ng, ng + H(nr,nc,er,ec)});
+      int r=u/G.C, c=u%G.C;
+      // vecinos libres en una sola consulta a la grilla de bits
+      for(unsigned m=G.freeMask4(r,c); m; m&=m-1){
+        int k=__builtin_ctz(m);
+        int nr=r+DR[k], nc=c+DC[k];
+        int v=G.id(nr,nc), ng=gCost[u]+1;
+        if(ng < gCost[v]){
+          if(gCost[v]==INF) touched.push_back(v);
+          gCost[v]=ng;
+          par[v]=u;
+          open.push(v, ng + H(nr,nc,er,ec));
+        }
       }
     }
-  }
 
-  vector<pair<int,int>> path;
-  if(gCost[er][ec]!=INF){
-    int r=er,c=ec;
-    while(!(r==sr && c==sc)){
-      path.push_back({r,c});
-      auto [pr,pc]=par[r][c];
-      if(pr==-1&&pc==-1){ path.clear(); break; }
-      r=pr;c=pc;
-    }
-    if(!path.empty()){ path.push_back({sr,sc}); reverse(path.begin(),path.end()); }
+    if(gCost[t]!=INF) buildPath(s,t,par,out);
+    collectParents(touched,par,out);
   }
+};
 
-  cout<<"Visited:\n";
-  for(auto [r,c]:visitedOrder) cout<<r<<" "<<c<<"\n";
-
-  cout<<"Parents:\n";
-  for(int r=0;r<R;r++) for(int c=0;c<C;c++){
-    auto [pr,pc]=par[r][c];
-    if(pr!=-1 || pc!=-1) cout<<r<<" "<<c<<" "<<pr<<" "<<pc<<"\n";
-  }
-
-  cout<<"Path:\n";
-  for(auto [r,c]:path) cout<<r<<" "<<c<<"\n";
-  return 0;
+int main(int argc, char** argv){
+  AStarSolver solver;
+  return engineMain(argc, argv, solver);
 }
-
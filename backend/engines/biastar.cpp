@@ -0,0 +1,29 @@
+#include <bits/stdc++.h>
+#include "engine_io.hpp"
+#include "bidir.hpp"
+using namespace std;
+
+/*
+  A* bidireccional 4-dir, coste 1, potencial promedio de Manhattan
+  (ver bidir.hpp).
+  Entrada:
+    rows cols sr sc er ec
+    grid (0 libre, 1 obstáculo)
+  Salida:
+    Visited:    celdas expandidas desde el inicio y desde la meta, intercaladas
+    r c
+    ...
+    Parents:
+    r c pr pc
+    ...
+    Path:
+    r c
+    ...
+
+  Con --server queda como proceso persistente (INIT/UPDATE/QUERY, ver engine_io.hpp).
+*/
+
+int main(int argc, char** argv){
+  BidirSolver<true> solver;
+  return engineMain(argc, argv, solver);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "engine_io.hpp"
+#include "bucket_queue.hpp"
+
+/*
+  Búsqueda bidireccional en grilla 4-dir, coste 1 (bidijkstra.cpp, biastar.cpp).
+
+  Un lado avanza desde el inicio y otro desde la meta (la grilla es simétrica,
+  los dos usan freeMask4), alternando una expansión cada uno.
+  mu = mejor df(v) + db(v) visto; se revisa cada vez que un lado mejora una
+  celda que el otro ya alcanzó.
+
+  Con heurística (A*) se usa el potencial promedio p(v) = (h_t(v) - h_s(v)) / 2
+  hacia adelante y -p(v) hacia atrás (Manhattan, consistente): los costes
+  reducidos de ambos lados son iguales y no negativos, así que vale la misma
+  parada que en Dijkstra bidireccional. Claves enteras (todo x2):
+    kf(v) = 2*df(v) + h_t(v) - h_s(v) + H     kb(v) = 2*db(v) + h_s(v) - h_t(v) + H
+  con H = h(s,t). Se para cuando la última kf extraída + la última kb
+  extraída >= 2*mu + 2H. Cada paso sube una clave en 0..4: colas de Dial.
+
+  Salida:
+    Visited: celdas expandidas por ambos lados, en orden
+    Parents: árbol hacia adelante (padre) y, para las celdas que solo alcanzó
+             el lado de atrás, la celda siguiente hacia la meta
+    Path:    inicio -> encuentro -> meta
+*/
+
+template <bool UseHeuristic>
+struct BidirSolver {
+    static constexpr int DR[4] = {-1, 1, 0, 0}, DC[4] = {0, 0, -1, 1};
+
+    // Buffers reutilizados entre consultas; solo se limpian las celdas tocadas.
+    std::vector<int> df, db, par, succ;
+    std::vector<char> doneF, doneB;
+    std::vector<int> touched;
+    DialQueue qf, qb;
+
+    void reset(int N) {
+        const int INF = INT_MAX;
+        if ((int)df.size() != N) {
+            df.assign(N, INF); db.assign(N, INF); par.assign(N, -1); succ.assign(N, -1);
+            doneF.assign(N, 0); doneB.assign(N, 0);
+        } else {
+            for (int v : touched) { df[v] = db[v] = INF; par[v] = succ[v] = -1; doneF[v] = doneB[v] = 0; }
+        }
+        touched.clear();
+        qf.reset(N, 4); qb.reset(N, 4);
+    }
+
+    void solve(const GridMap& G, int sr, int sc, int er, int ec, SearchOutput& out) {
+        if (!G.freeCell(sr, sc) || !G.freeCell(er, ec)) return;
+        int s = G.id(sr, sc), t = G.id(er, ec);
+        if (s == t) { out.visit(s); out.path.push_back(s); return; }
+
+        const int INF = INT_MAX;
+        reset(G.R * G.C);
+
+        auto h = [&](int v, int r0, int c0) {
+            return UseHeuristic ? std::abs(v / G.C - r0) + std::abs(v % G.C - c0) : 0;
+        };
+        const int H = h(s, er, ec);
+        auto keyF = [&](int v) { return (uint32_t)(2 * df[v] + h(v, er, ec) - h(v, sr, sc) + H); };
+        auto keyB = [&](int v) { return (uint32_t)(2 * db[v] + h(v, sr, sc) - h(v, er, ec) + H); };
+
+        long long mu = LLONG_MAX;
+        int meet = -1;
+
+        // Expande u de un lado; 'mine'/'other' son las distancias de cada lado
+        auto expand = [&](int u, std::vector<int>& mine, const std::vector<int>& other,
+                          std::vector<char>& done, std::vector<int>& link, DialQueue& q, bool fwd) {
+            done[u] = 1;
+            out.visit(u);
+            int r = u / G.C, c = u % G.C;
+            for (unsigned m = G.freeMask4(r, c); m; m &= m - 1) {
+                int k = __builtin_ctz(m);
+                int v = G.id(r + DR[k], c + DC[k]), nd = mine[u] + 1;
+                if (done[v] || nd >= mine[v]) continue;
+                if (df[v] == INF && db[v] == INF) touched.push_back(v);
+                mine[v] = nd;
+                link[v] = u;
+                q.push(v, fwd ? keyF(v) : keyB(v));
+                if (other[v] != INF && (long long)nd + other[v] < mu) { mu = (long long)nd + other[v]; meet = v; }
+            }
+        };
+
+        df[s] = 0; db[t] = 0;
+        touched.push_back(s); touched.push_back(t);
+        qf.push(s, keyF(s)); qb.push(t, keyB(t));
+        uint32_t lastF = 0, lastB = 0;
+        bool forward = true;
+
+        while (!qf.empty() && !qb.empty()) {
+            uint32_t k;
+            if (forward) {
+                int u = qf.pop(k);
+                lastF = k;
+                if (meet != -1 && (long long)lastF + lastB >= 2 * mu + 2 * H) break;
+                expand(u, df, db, doneF, par, qf, true);
+            } else {
+                int u = qb.pop(k);
+                lastB = k;
+                if (meet != -1 && (long long)lastF + lastB >= 2 * mu + 2 * H) break;
+                expand(u, db, df, doneB, succ, qb, false);
+            }
+            forward = !forward;
+        }
+
+        if (meet != -1) {
+            buildPath(s, meet, par, out);
+            for (int v = meet; v != t; ) { v = succ[v]; out.path.push_back(v); }
+        }
+
+        if (!out.keepParents()) return;
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (int v : touched) {
+            if (par[v] != -1) out.parents.push_back({v, par[v]});
+            else if (succ[v] != -1) out.parents.push_back({v, succ[v]});
+        }
+    }
+};
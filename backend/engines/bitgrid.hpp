@@ -0,0 +1,100 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+  Grilla de ocupación empaquetada: 1 bit por celda (1 = obstáculo), cada fila
+  rellenada a palabras de 64 bits. Los bits de relleno a la derecha de la última
+  columna se marcan como obstáculo, así los barridos por palabra nunca "salen"
+  de la fila y countFree() es un simple popcount.
+
+  Orden de vecinos de freeMask4 (igual que DR/DC de los motores):
+    bit 0 = arriba, bit 1 = abajo, bit 2 = izquierda, bit 3 = derecha
+*/
+
+struct BitGrid {
+    int R = 0, C = 0;
+    int W = 0;                   // palabras por fila
+    std::vector<uint64_t> bits;  // R*W palabras
+
+    int id(int r, int c) const { return r * C + c; }
+    bool inb(int r, int c) const { return r >= 0 && r < R && c >= 0 && c < C; }
+
+    const uint64_t* row(int r) const { return bits.data() + (size_t)r * W; }
+    uint64_t* row(int r) { return bits.data() + (size_t)r * W; }
+
+    // Mapa R x C totalmente libre
+    void reset(int rows, int cols) {
+        R = rows; C = cols;
+        W = (cols + 63) / 64;
+        bits.assign((size_t)R * W, 0);
+        if (C % 64) {
+            uint64_t pad = ~0ULL << (C % 64);
+            for (int r = 0; r < R; r++) row(r)[W - 1] = pad;
+        }
+    }
+
+    bool blocked(int r, int c) const { return (row(r)[c >> 6] >> (c & 63)) & 1; }
+    bool blockedId(int v) const { return blocked(v / C, v % C); }
+    bool freeCell(int r, int c) const { return inb(r, c) && !blocked(r, c); }
+
+    void set(int r, int c, bool b) {
+        uint64_t m = 1ULL << (c & 63);
+        if (b) row(r)[c >> 6] |= m;
+        else   row(r)[c >> 6] &= ~m;
+    }
+
+    // Marca (b=true) o libera el rectángulo [r0,r1] x [c0,c1] (inclusive, recortado)
+    // por palabras; changed(r, c) se llama por cada celda que cambió de estado
+    template <class F>
+    void setRect(int r0, int c0, int r1, int c1, bool b, F&& changed) {
+        r0 = std::max(r0, 0); c0 = std::max(c0, 0);
+        r1 = std::min(r1, R - 1); c1 = std::min(c1, C - 1);
+        if (r0 > r1 || c0 > c1) return;
+        int w0 = c0 >> 6, w1 = c1 >> 6;
+        for (int r = r0; r <= r1; r++) {
+            uint64_t* p = row(r);
+            for (int w = w0; w <= w1; w++) {
+                uint64_t m = ~0ULL;
+                if (w == w0) m &= ~0ULL << (c0 & 63);
+                if (w == w1 && (c1 & 63) != 63) m &= (1ULL << ((c1 & 63) + 1)) - 1;
+                for (uint64_t d = (b ? ~p[w] : p[w]) & m; d; d &= d - 1)
+                    changed(r, (w << 6) + __builtin_ctzll(d));
+                if (b) p[w] |= m;
+                else   p[w] &= ~m;
+            }
+        }
+    }
+    void setRect(int r0, int c0, int r1, int c1, bool b) { setRect(r0, c0, r1, c1, b, [](int, int) {}); }
+
+    // Celdas libres (popcount sobre las palabras; el relleno cuenta como obstáculo)
+    long long countFree() const {
+        long long blockedBits = 0;
+        for (uint64_t w : bits) blockedBits += __builtin_popcountll(w);
+        return (long long)R * W * 64 - blockedBits;
+    }
+
+    // Vecinos 4-dir libres de (r,c) como máscara de 4 bits (ver orden arriba)
+    unsigned freeMask4(int r, int c) const {
+        int w = c >> 6, b = c & 63;
+        const uint64_t* p = row(r);
+        unsigned m = 0;
+        if (r > 0     && !((row(r - 1)[w] >> b) & 1)) m |= 1;
+        if (r + 1 < R && !((row(r + 1)[w] >> b) & 1)) m |= 2;
+        if (c > 0     && !((b ? p[w] >> (b - 1) : p[w - 1] >> 63) & 1)) m |= 4;
+        if (c + 1 < C && !((b < 63 ? p[w] >> (b + 1) : p[w + 1]) & 1)) m |= 8;
+        return m;
+    }
+
+    // Carga desde R filas de ceil(C/8) bytes (bit c%8 del byte c/8), el mismo
+    // layout little-endian que las palabras de 64 bits.
+    void loadPacked(int rows, int cols, const unsigned char* p) {
+        reset(rows, cols);
+        size_t rowBytes = (size_t)(cols + 7) / 8;
+        for (int r = 0; r < R; r++, p += rowBytes) {
+            uint64_t* dst = row(r);
+            uint64_t pad = dst[W - 1];
+            std::memcpy(dst, p, rowBytes);
+            dst[W - 1] |= pad;
+        }
+    }
+};
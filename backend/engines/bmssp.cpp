@@ -4,6 +4,7 @@
 // Duan, Mao, Mao, Shu, Yin (2025)
 
 #include <bits/stdc++.h>
+#include "engine_io.hpp"
 using namespace std;
 
 /*
@@ -13,24 +14,20 @@ using namespace std;
   con complejidad O(m log^(2/3) n).
   
   Ideas principales:
-  1. Divide-and-conquer en conjuntos de vértices
-  2. Reducción de frontera usando pivotes
-  3. Combinación de enfoque Dijkstra + Bellman-Ford
-  4. Evita ordenamiento completo usando fronteras parciales
-*/
+  1. Divide-and-conquer por niveles: BMSSP(l, B, S) completa los vértices
+     con distancia < B' <= B que dependen de S
+  2. FindPivots: k pasos de Bellman-Ford reducen la frontera a los pivotes
+     con árboles de camino mínimo grandes
+  3. Estructura de bloques D (Insert / BatchPrepend / Pull): entrega los M
+     menores sin ordenar la frontera completa
+  4. Caso base: mini-Dijkstra hasta k+1 vértices
 
-struct Node {
-    int r, c;      // posición
-    int dist;      // distancia actual
-    int hops;      // número de saltos
-    
-    bool operator>(const Node& o) const {
-        if (dist != o.dist) return dist > o.dist;
-        if (hops != o.hops) return hops > o.hops;
-        if (r != o.r) return r > o.r;
-        return c > o.c;
-    }
-};
+  Solo se tocan las celdas de la frontera; las celdas completas salen en
+  Visited en el orden en que se completan (no es el orden de Dijkstra).
+
+  Con --server queda como proceso persistente (INIT/UPDATE/QUERY, ver engine_io.hpp).
+  BMSSP_BOUND y BMSSP_EXTRA_SOURCES se leen una vez al arrancar el proceso.
+*/
 
 static const int INF = 1e9;
 static const int dr[4] = {-1, 1, 0, 0};
@@ -56,113 +53,302 @@ static vector<pair<int,int>> parseExtraSources(const string& s){
     return out;
 }
 
-// Clase principal del algoritmo BMSSP
+// Clave (dist, id): orden total compatible con la distancia; hace de
+// desempate para cotas y elementos de D (el paper supone distancias distintas)
+typedef pair<int,int> Key;
+static const Key KEY_INF = {INF, INT_MAX};
+
+// Estructura D del Lemma 3.3: D0 con los bloques de BatchPrepend (el primero
+// es el menor) y D1 con bloques por cota superior que se parten en la
+// mediana al pasar de M. 'cur' guarda el valor vigente de cada clave; los
+// elementos que no coinciden están muertos y se descartan al recorrer.
+class BlockList {
+    typedef vector<Key> Block;
+    deque<Block> d0;
+    map<Key, Block> d1;
+    unordered_map<int,int> cur;
+    size_t M = 1;
+    Key B = KEY_INF;
+
+    bool live(const Key& e) const {
+        auto it = cur.find(e.second);
+        return it != cur.end() && it->second == e.first;
+    }
+    void compact(Block& b) const {
+        b.erase(remove_if(b.begin(), b.end(), [&](const Key& e){ return !live(e); }), b.end());
+    }
+    static Key blockMin(const Block& b) { return b.empty() ? KEY_INF : *min_element(b.begin(), b.end()); }
+    // Parte L[lo, hi) en bloques de <= cap por medianas, en orden
+    static void splitByMedian(Block& L, size_t lo, size_t hi, size_t cap, vector<Block>& out) {
+        if (hi - lo <= cap) { out.emplace_back(L.begin() + lo, L.begin() + hi); return; }
+        size_t mid = lo + (hi - lo) / 2;
+        nth_element(L.begin() + lo, L.begin() + mid, L.begin() + hi);
+        splitByMedian(L, lo, mid, cap, out);
+        splitByMedian(L, mid, hi, cap, out);
+    }
+
+public:
+    void init(size_t m, Key bound) {
+        M = max<size_t>(1, m); B = bound;
+        d0.clear(); d1.clear(); cur.clear();
+        d1.emplace(B, Block{});
+    }
+    bool empty() const { return cur.empty(); }
+
+    void insert(int v, int d) {
+        auto c = cur.find(v);
+        if (c != cur.end() && c->second <= d) return;
+        cur[v] = d;
+        auto it = d1.lower_bound(Key{d, v});
+        if (it == d1.end()) it = d1.emplace(B, Block{}).first;
+        Block& b = it->second;
+        b.push_back({d, v});
+        if (b.size() <= M) return;
+        compact(b);
+        if (b.size() <= M) return;
+        size_t mid = b.size() / 2;
+        nth_element(b.begin(), b.begin() + mid - 1, b.end());
+        Key lowBound = *max_element(b.begin(), b.begin() + mid);
+        Block low(b.begin(), b.begin() + mid);
+        b.erase(b.begin(), b.begin() + mid);
+        d1.emplace(lowBound, move(low));
+    }
+
+    // L: valores menores que todo lo que hay en D
+    void batchPrepend(const vector<Key>& L) {
+        Block keep;
+        for (const Key& e : L) {
+            auto c = cur.find(e.second);
+            if (c != cur.end() && c->second <= e.first) continue;
+            cur[e.second] = e.first;
+            keep.push_back(e);
+        }
+        compact(keep); // repetidos dentro de L: queda el menor
+        if (keep.empty()) return;
+        if (keep.size() <= M) { d0.push_front(move(keep)); return; }
+        vector<Block> parts;
+        splitByMedian(keep, 0, keep.size(), (M + 1) / 2, parts);
+        for (size_t i = parts.size(); i-- > 0; ) d0.push_front(move(parts[i]));
+    }
+
+    // Hasta M claves menores en S; devuelve la cota x que las separa del resto
+    Key pull(vector<int>& S) {
+        S.clear();
+        Block cand;
+        size_t i0 = 0, got = 0;
+        for (; i0 < d0.size() && got < M; ++i0) {
+            compact(d0[i0]);
+            cand.insert(cand.end(), d0[i0].begin(), d0[i0].end());
+            got += d0[i0].size();
+        }
+        auto it1 = d1.begin();
+        for (got = 0; it1 != d1.end() && got < M; ++it1) {
+            compact(it1->second);
+            cand.insert(cand.end(), it1->second.begin(), it1->second.end());
+            got += it1->second.size();
+        }
+
+        size_t m = min(M, cand.size());
+        if (m == cur.size()) {
+            for (const Key& e : cand) S.push_back(e.second);
+            init(M, B);
+            return B;
+        }
+        nth_element(cand.begin(), cand.begin() + m, cand.end());
+        Key x = KEY_INF;
+        for (size_t i = m; i < cand.size(); ++i) x = min(x, cand[i]);
+        for (size_t i = 0; i < m; ++i) { S.push_back(cand[i].second); cur.erase(cand[i].second); }
+
+        // Lo no juntado también cuenta para x: el primer bloque no vacío de cada lista
+        for (size_t i = 0; i < i0; ++i) compact(d0[i]);
+        for (; i0 < d0.size(); ++i0) {
+            compact(d0[i0]);
+            if (!d0[i0].empty()) { x = min(x, blockMin(d0[i0])); break; }
+        }
+        size_t end0 = min(i0 + 1, d0.size());
+        d0.erase(remove_if(d0.begin(), d0.begin() + end0, [](const Block& b){ return b.empty(); }),
+                 d0.begin() + end0);
+        for (auto it = d1.begin(); it != d1.end(); ) {
+            bool collected = it != it1;
+            compact(it->second);
+            if (it->second.empty()) { if (it == it1) ++it1; it = d1.erase(it); continue; }
+            if (!collected) { x = min(x, blockMin(it->second)); break; }
+            ++it;
+        }
+        return x;
+    }
+};
+
+// Clase principal del algoritmo BMSSP (Algoritmos 1-3 del paper)
 class BMSSPSolver {
 private:
-    int R, C;
-    vector<int> grid;
+    const GridMap* G = nullptr;
+    int R = 0, C = 0;
+    int S = -1, T = -1; // inicio/fin de la consulta actual (siempre transitables)
     vector<int> dist;
     vector<int> hops;
     vector<pair<int,int>> parent;
-    vector<pair<int,int>> visitedOrder;
-    int k, t; // parámetros del algoritmo
-    
+    vector<char> processed; // completos (distancia definitiva)
+    vector<int> touched; // celdas modificadas en la consulta anterior
+    SearchOutput* trace = nullptr; // salida de la consulta en curso (visited en orden, con streaming)
+    int k = 1, t = 1, L = 1; // parámetros del algoritmo
+
+    // FindPivots: W marcado por época, padre en el bosque de W y tamaño por raíz
+    vector<int> inW, fpar, treeSize;
+    int wEpoch = 0;
+    vector<int> W;
+    vector<BlockList> D;       // uno por nivel: hay a lo sumo una llamada activa en cada uno
+    vector<vector<int>> pulled;
+
+    // Opciones del proceso (variables de entorno)
+    int B = INF;
+    string extraSources;
+
     inline int id(int r, int c) const { return r * C + c; }
-    
-    // Encuentra pivotes: vértices importantes en la frontera
-    // Basado en Lemma 3.2 del paper
-    vector<pair<int,int>> findPivots(const vector<pair<int,int>>& frontier, int B, int targetSize) {
-        if (frontier.size() <= targetSize) return frontier;
-        
-        // Ejecutar k pasos de Bellman-Ford desde la frontera
-        // para identificar vértices que tienen árboles de caminos cortos grandes
-        vector<int> treeSize(R * C, 0);
-        
-        // Marcar vértices alcanzables en k pasos
-        for (int step = 0; step < k && step < frontier.size(); step++) {
-            for (auto [r, c] : frontier) {
-                for (int dir = 0; dir < 4; dir++) {
-                    int nr = r + dr[dir], nc = c + dc[dir];
-                    if (!inBounds(nr, nc, R, C)) continue;
-                    if (grid[id(nr, nc)] == 1) continue;
-                    
-                    int newDist = dist[id(r, c)] + 1;
-                    if (newDist < dist[id(nr, nc)] && newDist < B) {
-                        dist[id(nr, nc)] = newDist;
-                        hops[id(nr, nc)] = hops[id(r, c)] + 1;
-                        parent[id(nr, nc)] = {r, c};
-                        treeSize[id(r, c)]++;
-                    }
-                }
-            }
+    inline bool isFree(int r, int c) const {
+        if (!inBounds(r, c, R, C)) return false;
+        int v = id(r, c);
+        return v == S || v == T || !G->blocked(r, c);
+    }
+    inline void touch(int v) {
+        if (dist[v] == INF && parent[v].first == -1) touched.push_back(v);
+    }
+    inline Key key(int v) const { return {dist[v], v}; }
+
+    // Vecinos libres de u (coste unitario)
+    template<class F> void forEachOut(int u, F f) {
+        int r = u / C, c = u % C;
+        for (int dir = 0; dir < 4; dir++) {
+            int nr = r + dr[dir], nc = c + dc[dir];
+            if (isFree(nr, nc)) f(id(nr, nc));
         }
-        
-        // Seleccionar pivotes: vértices con árboles grandes
-        vector<pair<int, pair<int,int>>> pivotCandidates;
-        for (auto [r, c] : frontier) {
-            pivotCandidates.push_back({-treeSize[id(r, c)], {r, c}});
+    }
+
+    // Relajación con <=: v vuelve a D aunque ya tuviera esa distancia
+    bool relax(int u, int v) {
+        int nd = dist[u] + 1;
+        if (nd > dist[v]) return false;
+        if (nd < dist[v]) {
+            touch(v);
+            dist[v] = nd;
+            hops[v] = hops[u] + 1;
+            parent[v] = {u / C, u % C};
         }
-        
-        // Ordenar por tamaño de árbol (descendente)
-        nth_element(pivotCandidates.begin(), 
-                   pivotCandidates.begin() + min(targetSize, (int)pivotCandidates.size()),
-                   pivotCandidates.end());
-        
-        vector<pair<int,int>> pivots;
-        for (int i = 0; i < min(targetSize, (int)pivotCandidates.size()); i++) {
-            pivots.push_back(pivotCandidates[i].second);
+        return true;
+    }
+
+    // Marca v como completo (una vez) y lo agrega a U
+    void complete(int v, vector<int>& U) {
+        if (processed[v]) return;
+        processed[v] = 1;
+        trace->visit(v);
+        U.push_back(v);
+    }
+
+    // Encuentra pivotes (Lemma 3.2): k pasos de Bellman-Ford acotados por B.
+    // Si W crece más de k|S| todo S es pivote; si no, solo las raíces de S
+    // cuyo árbol dentro de W tiene al menos k vértices.
+    void findPivots(Key bound, const vector<int>& frontier, vector<int>& P) {
+        ++wEpoch;
+        W.clear();
+        for (int v : frontier) { inW[v] = wEpoch; fpar[v] = -1; treeSize[v] = 0; W.push_back(v); }
+        vector<int> layer = frontier, next;
+        bool big = false;
+        for (int step = 0; step < k && !layer.empty() && !big; step++) {
+            next.clear();
+            for (int u : layer) {
+                forEachOut(u, [&](int v) {
+                    if (!relax(u, v) || !(key(v) < bound)) return;
+                    if (inW[v] != wEpoch) { inW[v] = wEpoch; treeSize[v] = 0; W.push_back(v); next.push_back(v); }
+                    fpar[v] = u;
+                });
+            }
+            layer.swap(next);
+            big = W.size() > (size_t)k * frontier.size();
         }
-        
-        return pivots;
+        if (big) { P = frontier; return; }
+
+        P.clear();
+        for (int v : W) {
+            int r = v;
+            for (size_t guard = 0; fpar[r] != -1 && inW[fpar[r]] == wEpoch && guard < W.size(); ++guard) r = fpar[r];
+            treeSize[r]++;
+        }
+        for (int v : frontier)
+            if (fpar[v] == -1 && treeSize[v] >= k) P.push_back(v);
     }
-    
-    // BFS/Dijkstra mejorado con ideas de BMSSP
-    // Usa reducción de frontera y búsqueda acotada
-    void runBMSSPSearch(const vector<pair<int,int>>& sources, int targetR, int targetC) {
-        priority_queue<Node, vector<Node>, greater<Node>> pq;
-        vector<vector<bool>> processed(R, vector<bool>(C, false));
-        
-        // Inicializar desde las fuentes
-        for (auto [r, c] : sources) {
-            pq.push({r, c, dist[id(r, c)], hops[id(r, c)]});
+
+    // Caso base: Dijkstra desde x hasta completar k+1 vértices
+    Key baseCase(Key bound, int x, vector<int>& U) {
+        priority_queue<Key, vector<Key>, greater<Key>> pq;
+        vector<int> U0;
+        pq.push(key(x));
+        while (!pq.empty() && (int)U0.size() < k + 1) {
+            auto [d, u] = pq.top(); pq.pop();
+            if (d != dist[u] || find(U0.begin(), U0.end(), u) != U0.end()) continue;
+            U0.push_back(u);
+            forEachOut(u, [&](int v) {
+                if (Key{d + 1, v} < bound && relax(u, v)) pq.push(key(v));
+            });
         }
-        
-        while (!pq.empty()) {
-            Node curr = pq.top(); pq.pop();
-            
-            int r = curr.r, c = curr.c;
-            
-            // Verificar si ya procesamos este nodo
-            if (processed[r][c]) continue;
-            if (curr.dist != dist[id(r, c)]) continue;
-            
-            processed[r][c] = true;
-            visitedOrder.push_back({r, c});
-            
-            // Si llegamos al objetivo, podemos terminar
-            if (r == targetR && c == targetC) break;
-            
-            // Relajar aristas
-            for (int dir = 0; dir < 4; dir++) {
-                int nr = r + dr[dir], nc = c + dc[dir];
-                if (!inBounds(nr, nc, R, C)) continue;
-                if (grid[id(nr, nc)] == 1) continue;
-                
-                int newDist = dist[id(r, c)] + 1;
-                
-                if (newDist < dist[id(nr, nc)]) {
-                    dist[id(nr, nc)] = newDist;
-                    hops[id(nr, nc)] = hops[id(r, c)] + 1;
-                    parent[id(nr, nc)] = {r, c};
-                    
-                    if (!processed[nr][nc]) {
-                        pq.push({nr, nc, newDist, hops[id(nr, nc)]});
-                    }
-                }
+        if ((int)U0.size() <= k) {
+            for (int v : U0) complete(v, U);
+            return bound;
+        }
+        Key Bp = key(U0[0]);
+        for (int v : U0) Bp = max(Bp, key(v));
+        for (int v : U0) if (key(v) < Bp) complete(v, U);
+        return Bp;
+    }
+
+    // BMSSP(l, B, S): completa en U los vértices con clave < B' (el valor devuelto)
+    Key bmssp(int l, Key bound, const vector<int>& frontier, vector<int>& U) {
+        if (l == 0) return baseCase(bound, frontier[0], U);
+
+        vector<int> P;
+        findPivots(bound, frontier, P);
+        vector<int> Wl = W; // W se reutiliza en los niveles de abajo
+
+        BlockList& Dl = D[l];
+        int sh = (l - 1) * t;
+        Dl.init(sh >= 31 ? (size_t)INT_MAX : (size_t)1 << sh, bound);
+        Key Bp = bound;
+        for (int x : P) { Dl.insert(x, dist[x]); Bp = min(Bp, key(x)); }
+
+        int lt = l * t;
+        size_t limit = lt >= 31 ? SIZE_MAX : (size_t)k << lt;
+        vector<int>& Si = pulled[l];
+        vector<int> Ui;
+        vector<Key> K;
+        while (U.size() < limit && !Dl.empty()) {
+            Key Bi = Dl.pull(Si);
+            Ui.clear();
+            Bp = bmssp(l - 1, Bi, Si, Ui);
+            U.insert(U.end(), Ui.begin(), Ui.end());
+
+            K.clear();
+            for (int u : Ui) {
+                forEachOut(u, [&](int v) {
+                    if (!relax(u, v)) return;
+                    Key kv = key(v);
+                    if (!(kv < bound)) return;
+                    if (!(kv < Bi)) Dl.insert(v, kv.first);
+                    else if (!(kv < Bp)) K.push_back(kv);
+                });
+            }
+            for (int x : Si) {
+                Key kx = key(x);
+                if (!(kx < Bp) && kx < Bi) K.push_back(kx);
             }
+            Dl.batchPrepend(K);
+            // Consulta s->t: al nivel superior basta con que T esté completo
+            if (l == L && processed[T]) break;
         }
+        Bp = min(Bp, bound);
+        for (int x : Wl) if (key(x) < Bp) complete(x, U);
+        return Bp;
     }
-    
+
     // Reconstruir camino desde objetivo hasta inicio
     vector<pair<int,int>> reconstructPath(int targetR, int targetC, int startR, int startC) {
         vector<pair<int,int>> path;
@@ -184,99 +370,82 @@ private:
         
         return path;
     }
-    
-public:
-    BMSSPSolver(int rows, int cols, const vector<int>& g) 
-        : R(rows), C(cols), grid(g) {
-        
-        // Calcular parámetros óptimos según el paper
-        int n = R * C;
-        k = max(1, (int)pow(log2(n), 1.0/3.0)); // k = log^(1/3)(n)
-        t = max(1, (int)pow(log2(n), 2.0/3.0)); // t = log^(2/3)(n)
-        
-        dist.assign(R * C, INF);
-        hops.assign(R * C, 0);
-        parent.assign(R * C, {-1, -1});
-    }
-    
-    void solve(const vector<pair<int,int>>& sources, int targetR, int targetC) {
-        // Inicializar fuentes
-        for (auto [r, c] : sources) {
-            dist[id(r, c)] = 0;
-            hops[id(r, c)] = 0;
+
+    // Prepara buffers para un mapa R x C, limpiando solo lo tocado antes
+    void reset(const GridMap& g) {
+        G = &g;
+        int n = g.R * g.C;
+        if (g.R != R || g.C != C || (int)dist.size() != n) {
+            R = g.R; C = g.C;
+            // Calcular parámetros según el paper
+            double lg = log2(max(2, n));
+            k = max(1, (int)cbrt(lg));            // k = log^(1/3)(n)
+            t = max(1, (int)pow(lg, 2.0 / 3.0));  // t = log^(2/3)(n)
+            L = max(1, (int)ceil(lg / t));        // niveles de recursión
+
+            dist.assign(n, INF);
+            hops.assign(n, 0);
+            parent.assign(n, {-1, -1});
+            processed.assign(n, 0);
+            inW.assign(n, 0); fpar.assign(n, -1); treeSize.assign(n, 0);
+            wEpoch = 0;
+            D.assign(L + 1, BlockList());
+            pulled.assign(L + 1, {});
+        } else {
+            for (int v : touched) {
+                dist[v] = INF; hops[v] = 0; parent[v] = {-1, -1}; processed[v] = 0;
+            }
         }
-        
-        // Ejecutar algoritmo BMSSP
-        runBMSSPSearch(sources, targetR, targetC);
+        touched.clear();
     }
     
-    const vector<pair<int,int>>& getVisitedOrder() const { return visitedOrder; }
-    vector<pair<int,int>> getPath(int targetR, int targetC, int startR, int startC) {
-        return reconstructPath(targetR, targetC, startR, startC);
+public:
+    BMSSPSolver() {
+        // Bound opcional
+        if (const char* b = getenv("BMSSP_BOUND")) {
+            long long v = INF;
+            try { v = stoll(string(b)); } catch(...) { v = INF; }
+            if (v >= 1 && v < INF) B = (int)v;
+        }
+        // Multi-source opcional
+        if (const char* ex = getenv("BMSSP_EXTRA_SOURCES")) extraSources = ex;
     }
-};
-
-int main() {
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr);
-
-    int R, C, sr, sc, er, ec;
-    if (!(cin >> R >> C >> sr >> sc >> er >> ec)) return 0;
-
-    vector<int> grid(R * C, 0);
-    auto id = [&](int r, int c) { return r * C + c; };
-
-    for (int r = 0; r < R; r++)
-        for (int c = 0; c < C; c++)
-            cin >> grid[id(r, c)];
 
-    // Forzar que inicio y fin estén libres
-    grid[id(sr, sc)] = 0;
-    grid[id(er, ec)] = 0;
+    void solve(const GridMap& g, int sr, int sc, int er, int ec, SearchOutput& out) {
+        if (!g.inb(sr, sc) || !g.inb(er, ec)) return;
+        reset(g);
+        trace = &out;
+        // Forzar que inicio y fin estén libres (sin tocar el mapa compartido)
+        S = id(sr, sc); T = id(er, ec);
 
-    // Bound opcional
-    int B = INF;
-    if (const char* b = getenv("BMSSP_BOUND")) {
-        long long v = INF;
-        try { v = stoll(string(b)); } catch(...) { v = INF; }
-        if (v >= 1 && v < INF) B = (int)v;
-    }
-
-    // Multi-source opcional
-    vector<pair<int,int>> sources;
-    sources.push_back({sr, sc});
-    if (const char* ex = getenv("BMSSP_EXTRA_SOURCES")) {
-        auto extras = parseExtraSources(string(ex));
-        for (auto [r, c] : extras) {
-            if (r >= 0 && r < R && c >= 0 && c < C && grid[id(r, c)] == 0) {
+        vector<int> sources;
+        sources.push_back(S);
+        for (auto [r, c] : parseExtraSources(extraSources)) {
+            if (G->freeCell(r, c)) {
                 if (!(r == sr && c == sc)) {
-                    sources.push_back({r, c});
+                    sources.push_back(id(r, c));
                 }
             }
         }
-    }
-
-    // Ejecutar BMSSP
-    BMSSPSolver solver(R, C, grid);
-    solver.solve(sources, er, ec);
-    
-    const auto& visitedOrder = solver.getVisitedOrder();
-    auto path = solver.getPath(er, ec, sr, sc);
 
-    // === SALIDA ===
-    cout << "Visited:\n";
-    for (const auto& [r, c] : visitedOrder) {
-        cout << r << " " << c << "\n";
-    }
-
-    cout << "Parents:\n";
-    // No es necesario para one-shot, pero lo incluimos por compatibilidad
-    cout << "\n";
+        // Inicializar fuentes
+        for (int v : sources) {
+            touched.push_back(v);
+            dist[v] = 0;
+            hops[v] = 0;
+        }
+        
+        // Ejecutar algoritmo BMSSP: nivel L, cota B, fuentes S
+        vector<int> U;
+        bmssp(L, Key{B, INT_MAX}, sources, U);
+        if (!processed[T]) return;
 
-    cout << "Path:\n";
-    for (const auto& [r, c] : path) {
-        cout << r << " " << c << "\n";
+        // Parents: no es necesario para one-shot; se deja vacío por compatibilidad
+        for (auto [r, c] : reconstructPath(er, ec, sr, sc)) out.path.push_back(id(r, c));
     }
+};
 
-    return 0;
+int main(int argc, char** argv) {
+    BMSSPSolver solver;
+    return engineMain(argc, argv, solver);
 }
@@ -0,0 +1,219 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+  Colas de prioridad monótonas para claves enteras, compartidas por los motores
+  de grilla (aquí) y la comparativa (comparativa/algoritmos, que compila con
+  -I../../backend/engines). Un "nodo" es una celda en los motores y un nodo
+  del CSR en la comparativa.
+
+  - DialQueue : anillo de cubetas (Dial) con listas intrusivas por nodo.
+                Insertar o bajar la clave de un nodo es O(1) y no deja
+                duplicados; extraer es O(1) amortizado. Todas las claves deben
+                caer en [min, min + maxStep] (Dijkstra en grilla: 1, A*
+                Manhattan: 2). Dentro de una cubeta sale primero la última
+                insertada.
+  - RadixHeap : montículo radix (33 cubetas por bit más alto distinto del
+                último mínimo) para pesos enteros grandes; deja duplicados
+                (el llamador descarta las entradas obsoletas).
+  - BinaryHeapQueue : min-heap binario con la misma interfaz, para pesos
+                reales.
+  - BucketHeap : cubetas por un índice entero (parte entera de k1 en D* Lite)
+                con un montículo por cubeta para desempatar; admite insertar
+                por debajo del mínimo (rebobina), como pide D* Lite al subir km
+                o liberar celdas.
+
+  Interfaz común de las tres primeras: push(v, key), pop(key) -> v, empty().
+  pick_queue(g) elige entre ellas según wmax_int del grafo (comparativa).
+
+  Los arreglos por nodo se conservan entre consultas; reset() solo limpia lo
+  que quedó encolado.
+*/
+
+// Mayor peso entero con el que se usa Dial; por encima, radix heap.
+static constexpr int DIAL_MAX_W = 1024;
+
+enum class QueueKind { Binary, Dial, Radix };
+
+// Dial/radix solo si los pesos son enteros y la peor distancia cabe en uint32.
+// G: CSR o cualquier grafo de comparativa/algoritmos/graphs.hpp (usa N y wmax_int).
+template <class G>
+inline QueueKind pick_queue(const G& g) {
+    if (g.wmax_int < 0) return QueueKind::Binary;
+    unsigned long long worst = (unsigned long long)g.N * (unsigned long long)std::max(g.wmax_int, 1);
+    if (worst >= 0xFFFFFFFFull / 4) return QueueKind::Binary;
+    return g.wmax_int <= DIAL_MAX_W ? QueueKind::Dial : QueueKind::Radix;
+}
+
+template <class K> constexpr K key_inf() {
+    return std::numeric_limits<K>::has_infinity ? std::numeric_limits<K>::infinity()
+                                                : std::numeric_limits<K>::max();
+}
+
+class DialQueue {
+    std::vector<int> head;           // primer nodo de cada cubeta del anillo
+    std::vector<int> next, prev;     // listas doblemente enlazadas por nodo
+    std::vector<uint32_t> key;       // clave actual de cada nodo encolado
+    std::vector<char> inq;
+    uint32_t cur = 0, mask = 0;      // cur = última clave extraída (o la primera insertada)
+    size_t count = 0;
+    bool fresh = true;
+
+    void unlink(int v) {
+        int b = key[v] & mask;
+        if (prev[v] != -1) next[prev[v]] = next[v]; else head[b] = next[v];
+        if (next[v] != -1) prev[next[v]] = prev[v];
+    }
+
+public:
+    // N nodos; maxStep = mayor diferencia entre una clave insertada y el mínimo
+    void reset(int N, uint32_t maxStep) {
+        uint32_t ring = 1;
+        while (ring <= maxStep) ring <<= 1;
+        if ((int)next.size() != N) {
+            next.assign(N, -1); prev.assign(N, -1); key.assign(N, 0); inq.assign(N, 0);
+        } else {
+            // Vaciar lo que quedó de la consulta anterior (corte temprano)
+            for (int h : head) for (int v = h; v != -1; v = next[v]) inq[v] = 0;
+        }
+        head.assign(ring, -1);
+        mask = ring - 1;
+        cur = 0; count = 0; fresh = true;
+    }
+
+    bool empty() const { return count == 0; }
+    bool contains(int v) const { return inq[v]; }
+
+    // Inserta v o le baja la clave (si ya estaba con una clave menor o igual, no hace nada)
+    void push(int v, uint32_t k) {
+        if (inq[v]) {
+            if (k >= key[v]) return;
+            unlink(v);
+        } else {
+            inq[v] = 1; ++count;
+            if (fresh) { cur = k; fresh = false; }
+        }
+        key[v] = k;
+        int b = k & mask;
+        prev[v] = -1; next[v] = head[b];
+        if (head[b] != -1) prev[head[b]] = v;
+        head[b] = v;
+    }
+
+    int pop(uint32_t& k) {
+        while (head[cur & mask] == -1) ++cur;
+        int v = head[cur & mask];
+        unlink(v);
+        inq[v] = 0; --count;
+        k = key[v];
+        return v;
+    }
+};
+
+class RadixHeap {
+    std::vector<std::pair<uint32_t, int>> b[33];
+    uint32_t last = 0;
+    size_t count = 0;
+
+    static int bucket(uint32_t k, uint32_t last) {
+        return k == last ? 0 : 32 - __builtin_clz(k ^ last);
+    }
+
+public:
+    void reset() { for (auto& x : b) x.clear(); last = 0; count = 0; }
+    bool empty() const { return count == 0; }
+
+    void push(int v, uint32_t k) {
+        b[bucket(k, last)].push_back({k, v});
+        ++count;
+    }
+
+    int pop(uint32_t& k) {
+        if (b[0].empty()) {
+            int i = 1;
+            while (b[i].empty()) ++i;
+            last = std::min_element(b[i].begin(), b[i].end())->first;
+            for (auto& e : b[i]) b[bucket(e.first, last)].push_back(e);
+            b[i].clear();
+        }
+        auto e = b[0].back(); b[0].pop_back();
+        --count;
+        k = e.first;
+        return e.second;
+    }
+};
+
+// Min-heap binario sobre un vector propio (clear() conserva la memoria)
+template <class K>
+class BinaryHeapQueue {
+    using P = std::pair<K, int>;
+    std::vector<P> h;
+public:
+    void clear() { h.clear(); }
+    bool empty() const { return h.empty(); }
+    void push(int v, K k) {
+        h.push_back({k, v});
+        std::push_heap(h.begin(), h.end(), std::greater<P>());
+    }
+    int pop(K& k) {
+        std::pop_heap(h.begin(), h.end(), std::greater<P>());
+        auto [kk, v] = h.back(); h.pop_back();
+        k = kk;
+        return v;
+    }
+};
+
+// Misma semántica que std::priority_queue<T, vector<T>, Compare> (top = máximo
+// según Compare), repartida en cubetas por un índice >= 0 monótono con el orden.
+// Las cubetas van desde 'base' (el índice más chico vivo): al vaciarse la cola
+// se rebasa en el siguiente push y las cubetas vacías de adelante se descartan,
+// así el vector mide el rango de índices en cola y no el mayor visto (en D* Lite
+// km solo crece y con él las claves).
+template<class T, class Compare = std::less<T>>
+class BucketHeap {
+    std::vector<std::vector<T>> b;   // b[i] = cubeta del índice base + i
+    size_t base = 0, cur = 0, count = 0;
+    Compare cmp;
+
+    // Avanza cur hasta una cubeta no vacía y descarta las de adelante si ya
+    // son la mitad del vector
+    void advance() {
+        while (b[cur - base].empty()) ++cur;
+        size_t dead = cur - base;
+        if (dead >= 64 && dead * 2 >= b.size()) {
+            b.erase(b.begin(), b.begin() + dead);
+            base = cur;
+        }
+    }
+
+public:
+    bool empty() const { return count == 0; }
+    void clear() { for (auto& x : b) x.clear(); base = cur = count = 0; }
+
+    void push(size_t idx, const T& x) {
+        if (count == 0) base = cur = idx;    // todas vacías: rebase gratis
+        else if (idx < base) {               // rebobina por debajo de base
+            b.insert(b.begin(), base - idx, std::vector<T>());
+            base = idx;
+        }
+        size_t i = idx - base;
+        if (i >= b.size()) b.resize(i + 1);
+        b[i].push_back(x);
+        std::push_heap(b[i].begin(), b[i].end(), cmp);
+        if (idx < cur) cur = idx;
+        ++count;
+    }
+
+    const T& top() {
+        advance();
+        return b[cur - base].front();
+    }
+
+    void pop() {
+        advance();
+        auto& q = b[cur - base];
+        std::pop_heap(q.begin(), q.end(), cmp);
+        q.pop_back();
+        --count;
+    }
+};
@@ -1,4 +1,7 @@
 #include <bits/stdc++.h>
+#include "bitgrid.hpp"
+#include "wire.hpp"
+#include "bucket_queue.hpp"
 using namespace std;
 
 /*
@@ -11,6 +14,10 @@ using namespace std;
     UPDATE r c cost
       -> cost = 1 (libre) o 1000000000 (bloqueado) por simplicidad
       -> responde: "OK\nEND\n"
+    UPDATE_BATCH n
+    <n líneas "r c cost">
+      -> aplica todos los cambios y actualiza cada celda afectada una sola
+         vez; responde un único "OK\nEND\n"
     MOVE r c
       -> actualiza km y start; responde: "OK\nEND\n"
     PLAN
@@ -19,11 +26,40 @@ using namespace std;
          Parents:\n...
          Path:\n...
          END\n
+    PLAN DELTA
+      -> igual que PLAN pero solo con lo que cambió desde el PLAN anterior:
+         Visited:\n...            (procesados en esta corrida, como siempre)
+         Parents:\n...            (solo los parent que cambiaron)
+         Path: k\n...             (cabeza nueva de la ruta; sigue con la ruta
+                                  anterior desde su índice k)
+         END\n
+    PLAN [DELTA] [verbosity]
+      -> verbosity = path|cost|visited|full (ver wire.hpp; por defecto full o
+         el de --verbosity=...): sin "visited" no se registran los nodos
+         procesados y sin "full" no se envían Parents; "cost" y "visited"
+         agregan la línea "Cost: n" antes de Path
+
+  Cada orden puede enviarse también en binario (ver wire.hpp: 'I', 'U', 'M',
+  'P', 'X'); la respuesta usa el mismo formato que la orden.
+
+  Ids de petición (opcionales, para que el backend empareje respuestas con
+  varias órdenes en vuelo):
+    texto:   "@id ORDEN ..." -> la respuesta empieza con la línea "@id"
+    binario: frame '#' id + mensaje -> respuesta '#' id + respuesta
 
   - Heurística Manhattan (consistente).
+  - Cola U por cubetas de k1 (entero: coste 1, km entero) con montículo por
+    cubeta para desempatar por k2 (BucketHeap, bucket_queue.hpp).
   - g/rhs/cola U, km, start/goal persisten entre comandos.
+  - Los cambios no reparan nada: solo marcan (updateVertex) las celdas
+    afectadas; la reparación la hace el siguiente PLAN, una vez para todos.
   - "Visited" registra los nodos realmente procesados en esta corrida de PLAN.
   - "Parents" se alimenta en updateVertex (mejor predecesor) y también durante la reconstrucción final.
+  - Cada cambio de parent marca la celda como sucia; PLAN DELTA emite solo
+    esas celdas y la parte de la ruta que no coincide con la anterior, así
+    un MOVE por tick cuesta O(cambios) en vez de O(rows*cols). Las sucias se
+    limpian solo en los PLAN que envían Parents (full): tras un PLAN sin
+    ellos, el siguiente PLAN DELTA full trae también esos cambios.
 */
 
 struct Key {
@@ -48,11 +84,14 @@ struct DStarLite {
     int Sstart=-1, Sgoal=-1;
     long long km=0;
 
-    vector<int> grid;      // 0 libre, 1 obstáculo
+    BitGrid grid;          // 1 bit por celda (1 obstáculo)
     vector<double> g, rhs; // valores D* Lite
     vector<int> parent;    // para UI
+    vector<int> dirty;     // celdas con parent cambiado desde el último PLAN
+    vector<char> isDirty;
+    vector<int> lastPath;  // ruta (ids) del último PLAN
     vector<Key> bestKey;   // para lazy deletion de U
-    priority_queue<PQItem> U;
+    BucketHeap<PQItem> U;  // mismo orden que priority_queue<PQItem>
 
     DStarLite() {}
 
@@ -73,7 +112,7 @@ struct DStarLite {
     void pushU(int s){
         Key k=calcKey(s);
         bestKey[s]=k;
-        U.push(PQItem{s,k});
+        U.push((size_t)k.k1, PQItem{s,k});
     }
     void removeFromU(int s){
         bestKey[s]=Key{INF,INF}; // lazy
@@ -83,38 +122,80 @@ struct DStarLite {
         static const int dr[4]={-1,1,0,0};
         static const int dc[4]={0,0,-1,1};
         vector<int> out; out.reserve(4);
-        for(int k=0;k<4;k++){
-            int nr=r+dr[k], nc=c+dc[k];
-            if(!inb(nr,nc)) continue;
-            if(grid[id(nr,nc)]==1) continue;
-            out.push_back(id(nr,nc));
+        for(unsigned m=grid.freeMask4(r,c); m; m&=m-1){
+            int k=__builtin_ctz(m);
+            out.push_back(id(r+dr[k],c+dc[k]));
         }
         return out;
     }
     double cost(int /*a*/, int /*b*/) const { return 1.0; }
 
-    void init(int R,int C,int sr,int sc,int er,int ec,const vector<int>& G){
-        rows=R; cols=C; grid=G;
+    void init(int R,int C,int sr,int sc,int er,int ec,BitGrid&& G){
+        rows=R; cols=C; grid=std::move(G);
         int s=id(sr,sc), t=id(er,ec);
-        grid[s]=0; grid[t]=0;
+        grid.set(sr,sc,false); grid.set(er,ec,false);
         Sstart=s; Sgoal=t; km=0;
         int N=rows*cols;
         g.assign(N, INF); rhs.assign(N, INF); parent.assign(N,-1);
+        isDirty.assign(N, 0); dirty.clear(); lastPath.clear();
         bestKey.assign(N, Key{INF,INF});
-        U=priority_queue<PQItem>();
+        U.clear();
         rhs[Sgoal]=0.0; pushU(Sgoal);
     }
 
+    struct CellUpdate { int r, c; double cost; };
+
     void updateCell(int r,int c,double newCost){
-        // newCost == BLOCK → obstáculo; == 1 → libre
-        int u=id(r,c);
-        int prev = grid[u];
-        grid[u] = (newCost>=BLOCK/2)? 1:0;
-        // Actualizar vecinos y el propio si corresponde:
-        // Si celda cambia a obstáculo, ya no es transitable ni pred de otros.
-        // Llamamos updateVertex a cada sucesor/vecino afectado.
-        updateVertex(u);
-        for(int s: neighbors4(u)) updateVertex(s);
+        updateCells({CellUpdate{r,c,newCost}});
+    }
+
+    // Lote de cambios: primero todos los bits de la grilla, después
+    // updateVertex una sola vez por celda afectada (cambiadas y sus vecinas).
+    // updateVertex solo lee g de los vecinos, que aquí no cambia: el orden da igual.
+    void updateCells(const vector<CellUpdate>& ups){
+        vector<int> touched;
+        touched.reserve(ups.size()*5);
+        for(const auto& up: ups){
+            if(!inb(up.r,up.c)) continue;
+            // cost == BLOCK → obstáculo; == 1 → libre
+            grid.set(up.r,up.c,up.cost>=BLOCK/2);
+            touched.push_back(id(up.r,up.c));
+        }
+        // Si una celda cambia a obstáculo, ya no es transitable ni pred de
+        // otros: se actualizan ella y sus vecinas libres (con la grilla final)
+        size_t changed=touched.size();
+        for(size_t i=0;i<changed;i++)
+            for(int s: neighbors4(touched[i])) touched.push_back(s);
+        sort(touched.begin(), touched.end());
+        touched.erase(unique(touched.begin(), touched.end()), touched.end());
+        for(int u: touched) updateVertex(u);
+    }
+
+    void setParent(int s,int p){
+        if(parent[s]==p) return;
+        parent[s]=p;
+        if(!isDirty[s]){ isDirty[s]=1; dirty.push_back(s); }
+    }
+
+    // Cierra un PLAN: guarda la ruta y, si la respuesta llevó Parents
+    // (sentParents), limpia las celdas sucias; si no, quedan para el próximo
+    // PLAN DELTA con Parents. Devuelve el índice de la ruta anterior donde
+    // empieza el tramo final común y deja en head la parte nueva
+    // (ruta = head + anterior[from..])
+    size_t commitPlan(const vector<pair<int,int>>& path, vector<int>& head, bool sentParents){
+        if(sentParents){
+            for(int s: dirty) isDirty[s]=0;
+            dirty.clear();
+        }
+        head.clear();
+        for(auto &p: path) head.push_back(id(p.first,p.second));
+        size_t L=0;
+        while(L<head.size() && L<lastPath.size() &&
+              head[head.size()-1-L]==lastPath[lastPath.size()-1-L]) L++;
+        size_t from=lastPath.size()-L;
+        lastPath=head;
+        head.resize(head.size()-L);
+        return from;
     }
 
     void moveStart(int r,int c){
@@ -132,28 +213,26 @@ struct DStarLite {
                 if(cand<new_rhs){ new_rhs=cand; bestPred=sp; }
             }
             rhs[s]=new_rhs;
-            if(bestPred!=-1) parent[s]=bestPred;
+            if(bestPred!=-1) setParent(s,bestPred);
         }
         if (g[s]!=rhs[s]) pushU(s);
         else if (inU(s)) removeFromU(s);
     }
 
-    void computeShortestPath(vector<pair<int,int>>& visitedOrder){
+    // visitedOrder == nullptr: no registrar los nodos procesados
+    void computeShortestPath(vector<pair<int,int>>* visitedOrder){
         auto keyLess=[&](const Key&a,const Key&b){
             if(a.k1!=b.k1) return a.k1<b.k1;
             return a.k2<b.k2;
         };
         while(true){
-            if(U.empty()){
-                if(g[Sstart]==rhs[Sstart]) break;
-            }else{
-                PQItem t=U.top();
-                if(!keyLess(t.key, calcKey(Sstart)) && g[Sstart]==rhs[Sstart]) break;
-            }
+            if(U.empty()) break; // nada más que reparar (top() de una cola vacía no vale)
+            PQItem t=U.top();
+            if(!keyLess(t.key, calcKey(Sstart)) && g[Sstart]==rhs[Sstart]) break;
             PQItem it=U.top(); U.pop();
             if(!(it.key.k1==bestKey[it.id].k1 && it.key.k2==bestKey[it.id].k2)) continue; // lazy
             int u=it.id;
-            visitedOrder.emplace_back(u/cols,u%cols);
+            if(visitedOrder) visitedOrder->emplace_back(u/cols,u%cols);
 
             Key k_old=it.key, k_new=calcKey(u);
             if (keyLess(k_new,k_old)){
@@ -185,7 +264,7 @@ struct DStarLite {
                 if(cand<best){ best=cand; bestN=nb; }
             }
             if(bestN==-1 || g[bestN]>=INF/2) break;
-            parent[bestN]=cur; // útil para UI
+            setParent(bestN,cur); // útil para UI
             cur=bestN;
             path.emplace_back(cur/cols, cur%cols);
         }
@@ -196,10 +275,105 @@ struct DStarLite {
     }
 };
 
-int main(){
+// Respuesta binaria de PLAN: ids de celda (r*cols+c)
+static void sendPlanBinary(const DStarLite& dsl, const vector<pair<int,int>>& visited,
+                           const vector<pair<int,int>>& path, bool parents){
+    WireWriter w('R');
+    w.i32((int32_t)visited.size());
+    for(auto &p: visited) w.i32(p.first*dsl.cols+p.second);
+    int n=0;
+    if(parents) for(int p: dsl.parent) if(p!=-1) n++;
+    w.i32(n);
+    for(size_t s=0;s<dsl.parent.size() && n>0;++s)
+        if(dsl.parent[s]!=-1){ w.i32((int32_t)s); w.i32(dsl.parent[s]); }
+    w.i32((int32_t)path.size());
+    for(auto &p: path) w.i32(p.first*dsl.cols+p.second);
+    w.send(cout);
+}
+
+// Respuesta binaria de PLAN delta ('D'): nVisited + ids, nParents cambiados
+// + (id, pid), from + nHead + ids
+static void sendPlanDeltaBinary(const DStarLite& dsl, const vector<pair<int,int>>& visited,
+                                const vector<int>& changed, size_t from, const vector<int>& head){
+    WireWriter w('D');
+    w.i32((int32_t)visited.size());
+    for(auto &p: visited) w.i32(p.first*dsl.cols+p.second);
+    w.i32((int32_t)changed.size());
+    for(int s: changed){ w.i32(s); w.i32(dsl.parent[s]); }
+    w.i32((int32_t)from);
+    w.ids(head);
+    w.send(cout);
+}
+
+// Atiende un mensaje binario; false si hay que terminar
+static bool handleFrame(DStarLite& dsl, int verbosity){
+    string payload;
+    if(!readFrame(cin, payload)) return false;
+    WireTagScope tag(untagFrame(payload));
+    WireReader rd(payload);
+    switch(rd.type()){
+    case 'I': {
+        int R=rd.i32(), C=rd.i32(), sr=rd.i32(), sc=rd.i32(), er=rd.i32(), ec=rd.i32();
+        BitGrid G;
+        if(!rd.good || !unpackGrid(rd,R,C,G)){ sendError(cout,"init"); return true; }
+        dsl.init(R,C,sr,sc,er,ec,std::move(G));
+        sendAck(cout);
+        return true;
+    }
+    case 'U': {
+        int n=rd.i32();
+        vector<DStarLite::CellUpdate> ups;
+        for(int i=0;i<n && rd.good;i++){
+            int r=rd.i32(), c=rd.i32(), blocked=rd.i32();
+            if(rd.good) ups.push_back({r, c, blocked? BLOCK : 1.0});
+        }
+        dsl.updateCells(ups);
+        sendAck(cout);
+        return true;
+    }
+    case 'M': {
+        int r=rd.i32(), c=rd.i32();
+        if(rd.good && dsl.inb(r,c)) dsl.moveStart(r,c);
+        sendAck(cout);
+        return true;
+    }
+    case 'P': {
+        int32_t mode = rd.i32();
+        bool delta = rd.good && mode==1;
+        int verb = wireVerbosity(rd, verbosity);
+        vector<pair<int,int>> visited;
+        dsl.computeShortestPath(verb>=VERB_VISITED ? &visited : nullptr);
+        auto path = dsl.reconstructPath();
+        vector<int> changed, head;
+        if(verb>=VERB_FULL) changed = dsl.dirty;
+        size_t from = dsl.commitPlan(path, head, verb>=VERB_FULL);
+        if(delta) sendPlanDeltaBinary(dsl, visited, changed, from, head);
+        else sendPlanBinary(dsl, visited, path, verb>=VERB_FULL);
+        return true;
+    }
+    case 'X':
+        sendAck(cout);
+        return false;
+    default:
+        sendError(cout,"unknown");
+        return true;
+    }
+}
+
+int main(int argc, char** argv){
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    // --verbosity=LEVEL: nivel por defecto de PLAN (ver wire.hpp)
+    int verbosity = VERB_FULL;
+    for(int i=1;i<argc;i++){
+        string a=argv[i];
+        if(a.rfind("--verbosity=",0)==0 && !parseVerbosity(a.substr(12), verbosity)){
+            cerr<<"Nivel de detalle desconocido: "<<a.substr(12)<<"\n";
+            return 1;
+        }
+    }
+
     DStarLite dsl;
     string line;
 
@@ -209,10 +383,23 @@ int main(){
     };
 
     while (true){
+        int ch = wirePeek(cin);
+        if(ch==EOF) break;
+        if(ch==WIRE_MAGIC){
+            if(!handleFrame(dsl, verbosity)) break;
+            continue;
+        }
         if(!std::getline(cin, line)) break;
         line=trim(line);
         if(line.empty()) continue;
 
+        // "@id ORDEN": se responde con "@id" delante
+        if(line[0]=='@'){
+            size_t sp=line.find(' ');
+            cout<<line.substr(0, sp)<<"\n";
+            line = sp==string::npos ? "" : line.substr(sp+1);
+        }
+
         string cmd; {
             stringstream ss(line); ss>>cmd;
         }
@@ -221,22 +408,39 @@ int main(){
             stringstream ss(line);
             string _; int R,C,sr,sc,er,ec;
             ss>>_>>R>>C>>sr>>sc>>er>>ec;
-            vector<int> G(R*C,0);
+            BitGrid G; G.reset(R,C);
             for(int r=0;r<R;r++){
                 string row; getline(cin,row);
                 row=trim(row);
                 if(row.empty()){ r--; continue; }
                 stringstream rs(row);
-                for(int c=0;c<C;c++){ int v; rs>>v; G[r*C+c]=v; }
+                for(int c=0;c<C;c++){ int v; rs>>v; if(v==1) G.set(r,c,true); }
             }
-            dsl.init(R,C,sr,sc,er,ec,G);
+            dsl.init(R,C,sr,sc,er,ec,std::move(G));
             cout<<"OK\nEND\n"<<flush;
         }
         else if(cmd=="UPDATE"){
             stringstream ss(line);
             string _; int r,c; double cost;
             ss>>_>>r>>c>>cost;
-            dsl.updateCell(r,c,cost);
+            if(dsl.inb(r,c)) dsl.updateCell(r,c,cost);
+            cout<<"OK\nEND\n"<<flush;
+        }
+        else if(cmd=="UPDATE_BATCH"){
+            stringstream ss(line);
+            string _; int n=0;
+            ss>>_>>n;
+            vector<DStarLite::CellUpdate> ups;
+            for(int i=0;i<n;i++){
+                string row;
+                if(!getline(cin,row)) break;
+                row=trim(row);
+                if(row.empty()){ i--; continue; }
+                stringstream rs(row);
+                DStarLite::CellUpdate up;
+                if(rs>>up.r>>up.c>>up.cost) ups.push_back(up);
+            }
+            dsl.updateCells(ups);
             cout<<"OK\nEND\n"<<flush;
         }
         else if(cmd=="MOVE"){
@@ -246,22 +450,42 @@ int main(){
             cout<<"OK\nEND\n"<<flush;
         }
         else if(cmd=="PLAN"){
+            bool delta=false;
+            int verb=verbosity;
+            {
+                stringstream ss(line); ss>>cmd;
+                for(string opt; ss>>opt; )
+                    if(opt=="DELTA") delta=true;
+                    else parseVerbosity(opt, verb);
+            }
             vector<pair<int,int>> visited;
-            dsl.computeShortestPath(visited);
+            dsl.computeShortestPath(verb>=VERB_VISITED ? &visited : nullptr);
             auto path = dsl.reconstructPath();
+            vector<int> changed, head;
+            if(verb>=VERB_FULL) changed = dsl.dirty;
+            size_t from = dsl.commitPlan(path, head, verb>=VERB_FULL);
 
+            auto printParent = [&](int s){
+                int r=s/dsl.cols, c=s%dsl.cols;
+                int pr=dsl.parent[s]/dsl.cols, pc=dsl.parent[s]%dsl.cols;
+                cout<<r<<" "<<c<<" "<<pr<<" "<<pc<<"\n";
+            };
             cout<<"Visited:\n";
             for(auto &p: visited) cout<<p.first<<" "<<p.second<<"\n";
             cout<<"Parents:\n";
-            for(size_t s=0;s<dsl.parent.size();++s){
-                if(dsl.parent[s]!=-1){
-                    int r=s/dsl.cols, c=s%dsl.cols;
-                    int pr=dsl.parent[s]/dsl.cols, pc=dsl.parent[s]%dsl.cols;
-                    cout<<r<<" "<<c<<" "<<pr<<" "<<pc<<"\n";
-                }
+            if(verb==VERB_COST || verb==VERB_VISITED)
+                cout<<"Cost: "<<(path.empty() ? -1 : (int)path.size()-1)<<"\n";
+            if(delta){
+                for(int s: changed) printParent(s);
+                cout<<"Path: "<<from<<"\n";
+                for(int u: head) cout<<u/dsl.cols<<" "<<u%dsl.cols<<"\n";
+            } else {
+                if(verb>=VERB_FULL)
+                    for(size_t s=0;s<dsl.parent.size();++s)
+                        if(dsl.parent[s]!=-1) printParent((int)s);
+                cout<<"Path:\n";
+                for(auto &p: path) cout<<p.first<<" "<<p.second<<"\n";
             }
-            cout<<"Path:\n";
-            for(auto &p: path) cout<<p.first<<" "<<p.second<<"\n";
             cout<<"END\n"<<flush;
         }
         else if(cmd=="EXIT"){
@@ -0,0 +1,373 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "bitgrid.hpp"
+#include "wire.hpp"
+
+/*
+  Utilidades compartidas por los motores one-shot (dijkstra, astar, bmssp).
+
+  Modo one-shot (por defecto, sin argumentos):
+    rows cols sr sc er ec
+    grid (0 libre, 1 obstáculo)
+  -> Visited/Parents/Path y termina.
+
+  Modo servidor (--server): proceso persistente que carga el mapa una sola vez
+  y responde muchas consultas. Mismo estilo que el protocolo de dstar_lite.cpp:
+
+    INIT rows cols
+    <rows líneas con cols enteros 0/1>
+      -> responde: "OK\nEND\n"
+    UPDATE r c cost
+      -> cost >= 1e9/2 bloquea la celda, cualquier otro valor la libera
+      -> responde: "OK\nEND\n"
+    UPDATE_RECT r0 c0 r1 c1 cost
+      -> igual que UPDATE sobre todo el rectángulo [r0,r1] x [c0,c1] (inclusive,
+         recortado al mapa), aplicado por palabras de 64 bits
+      -> responde: "OK\nEND\n"
+    STATS
+      -> responde: "Rows R\nCols C\nFree n\nEND\n" (n = celdas libres)
+    QUERY sr sc er ec [verbosity] [STREAM n]
+      -> responde: Visited:\n...Parents:\n...Path:\n...END\n
+         (verbosity = path|cost|visited|full, ver wire.hpp; por defecto full
+          o el de --verbosity=...)
+         Con STREAM n (o --stream=n) cada n celdas expandidas se envía antes
+         un bloque parcial "Visited+:\n...END\n" ('V' en binario) durante la
+         búsqueda; el Visited de la respuesta final trae solo las que faltan.
+    EXIT
+      -> responde: "BYE\nEND\n"
+
+  Además, cualquier mensaje puede enviarse en el protocolo binario de wire.hpp
+  ('G' en one-shot; 'I'/'U'/'Q'/'X' en modo servidor) y se responde en binario.
+
+  Cada motor implementa un "solver" con:
+    void solve(const GridMap&, int sr, int sc, int er, int ec, SearchOutput&);
+  y reutiliza sus buffers internos entre consultas. Las celdas expandidas se
+  anotan con out.visit(v) y los parents con collectParents: ambos no hacen
+  nada si el nivel de detalle de la consulta no los pide.
+
+  Los motores con precomputación sobre el mapa (p.ej. HPA*) pueden definir además:
+    void onLoad(const GridMap&);                 // tras INIT / carga one-shot
+    void onCell(const GridMap&, int r, int c);   // tras cada UPDATE que cambia la celda
+*/
+
+static const double ENGINE_BLOCK = 1e9;
+
+// Mapa compartido por los motores: 1 bit por celda (ver bitgrid.hpp)
+using GridMap = BitGrid;
+
+struct SearchOutput {
+    std::vector<int> visited;                // ids en orden de expansión
+    std::vector<std::pair<int,int>> parents; // (id, id del padre), orden fila-mayor
+    std::vector<int> path;                   // ids inicio -> fin
+    int verbosity = VERB_FULL;               // qué registrar (ver wire.hpp)
+    int streamEvery = 0;                     // > 0: entregar visited por lotes
+    std::function<void(const std::vector<int>&)> stream;
+
+    bool keepVisited() const { return verbosity >= VERB_VISITED; }
+    bool keepParents() const { return verbosity >= VERB_FULL; }
+    void visit(int v) {
+        if (!keepVisited()) return;
+        visited.push_back(v);
+        if (streamEvery > 0 && (int)visited.size() >= streamEvery) { stream(visited); visited.clear(); }
+    }
+    int cost() const { return path.empty() ? -1 : (int)path.size() - 1; }
+
+    void clear() { visited.clear(); parents.clear(); path.clear(); }
+};
+
+// Lee R*C valores de la grilla directamente del streambuf (mucho más rápido que
+// operator>> en mapas grandes). Cualquier token distinto de "0" es obstáculo.
+inline bool readCells(std::istream& in, int R, int C, GridMap& G) {
+    G.reset(R, C);
+    std::streambuf* sb = in.rdbuf();
+    for (int r = 0; r < R; r++) {
+        uint64_t* row = G.row(r);
+        for (int c = 0; c < C; c++) {
+            int ch = sb->sbumpc();
+            while (ch != EOF && std::isspace(ch)) ch = sb->sbumpc();
+            if (ch == EOF) return false;
+            int v = 0;
+            while (ch != EOF && !std::isspace(ch)) {
+                if (ch != '0') v = 1;
+                ch = sb->sbumpc();
+            }
+            if (v) row[c >> 6] |= 1ULL << (c & 63);
+        }
+    }
+    return true;
+}
+
+// Parents en orden fila-mayor (mismo orden que el barrido completo original),
+// pero recorriendo solo las celdas tocadas por la búsqueda.
+inline void collectParents(std::vector<int> touched, const std::vector<int>& par, SearchOutput& out) {
+    if (!out.keepParents()) return;
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (int v : touched)
+        if (par[v] != -1) out.parents.push_back({v, par[v]});
+}
+
+// Hooks opcionales del solver (solo se llaman si el solver los define)
+template <class Solver>
+auto notifyLoad(Solver& s, const GridMap& G, int) -> decltype(s.onLoad(G), void()) { s.onLoad(G); }
+template <class Solver>
+void notifyLoad(Solver&, const GridMap&, long) {}
+
+template <class Solver>
+auto notifyCell(Solver& s, const GridMap& G, int r, int c, int) -> decltype(s.onCell(G, r, c), void()) { s.onCell(G, r, c); }
+template <class Solver>
+void notifyCell(Solver&, const GridMap&, int, int, long) {}
+
+// Aplica UPDATE sobre la grilla y avisa al solver si la celda cambió
+template <class Solver>
+void updateCell(Solver& solver, GridMap& G, int r, int c, bool blocked) {
+    if (!G.inb(r, c) || G.blocked(r, c) == blocked) return;
+    G.set(r, c, blocked);
+    notifyCell(solver, G, r, c, 0);
+}
+
+// UPDATE_RECT: setRect sobre la grilla y aviso al solver de cada celda que cambió
+template <class Solver>
+void updateRect(Solver& solver, GridMap& G, int r0, int c0, int r1, int c1, bool blocked) {
+    std::vector<int> changed;
+    G.setRect(r0, c0, r1, c1, blocked, [&](int r, int c) { changed.push_back(G.id(r, c)); });
+    for (int v : changed) notifyCell(solver, G, v / G.C, v % G.C, 0);
+}
+
+// Reconstruye el camino siguiendo par[] desde t; vacío si la cadena se corta.
+inline void buildPath(int s, int t, const std::vector<int>& par, SearchOutput& out) {
+    int v = t;
+    while (v != s) {
+        out.path.push_back(v);
+        v = par[v];
+        if (v == -1) { out.path.clear(); return; }
+    }
+    out.path.push_back(s);
+    std::reverse(out.path.begin(), out.path.end());
+}
+
+inline void printOutput(std::ostream& os, const SearchOutput& out, int C) {
+    os << "Visited:\n";
+    for (int v : out.visited) os << v / C << " " << v % C << "\n";
+    os << "Parents:\n";
+    for (auto [v, p] : out.parents) os << v / C << " " << v % C << " " << p / C << " " << p % C << "\n";
+    if (out.verbosity == VERB_COST || out.verbosity == VERB_VISITED) os << "Cost: " << out.cost() << "\n";
+    os << "Path:\n";
+    for (int v : out.path) os << v / C << " " << v % C << "\n";
+}
+
+// Lote parcial de celdas expandidas (streaming)
+inline void printVisitedBatch(std::ostream& os, const std::vector<int>& v, int C) {
+    os << "Visited+:\n";
+    for (int id : v) os << id / C << " " << id % C << "\n";
+    os << "END\n" << std::flush;
+}
+
+inline void sendVisitedBatch(std::ostream& os, const std::vector<int>& v) {
+    WireWriter w('V');
+    w.ids(v);
+    w.send(os);
+}
+
+// Opciones por defecto de las consultas (--verbosity=..., --stream=...)
+struct QueryDefaults {
+    int verbosity = VERB_FULL;
+    int streamEvery = 0;
+};
+
+// Prepara 'out' para una consulta: nivel de detalle y streaming (every <= 0: sin streaming)
+inline void beginQuery(SearchOutput& out, int verbosity, int every, bool binary, int C) {
+    out.clear();
+    out.verbosity = verbosity;
+    out.streamEvery = every > 0 && out.keepVisited() ? every : 0;
+    if (!out.streamEvery) out.stream = nullptr;
+    else if (binary) out.stream = [](const std::vector<int>& v) { sendVisitedBatch(std::cout, v); };
+    else out.stream = [C](const std::vector<int>& v) { printVisitedBatch(std::cout, v, C); };
+}
+
+inline void sendResult(std::ostream& os, const SearchOutput& out) {
+    WireWriter w('R');
+    w.ids(out.visited);
+    w.i32((int32_t)out.parents.size());
+    for (auto [v, p] : out.parents) { w.i32(v); w.i32(p); }
+    w.ids(out.path);
+    w.send(os);
+}
+
+// Carga un mapa desde 'G'/'I': rows cols sr sc er ec + grilla empaquetada
+inline bool loadGridFrame(WireReader& rd, GridMap& G, int q[4]) {
+    int R = rd.i32(), C = rd.i32();
+    for (int i = 0; i < 4; i++) q[i] = rd.i32();
+    if (!rd.good || !unpackGrid(rd, R, C, G)) { G.reset(0, 0); return false; }
+    return true;
+}
+
+// Consulta binaria ('G'/'Q'): [verbosity [streamEvery]] opcionales tras los datos
+template <class Solver>
+void solveFrame(Solver& solver, const GridMap& G, WireReader& rd, const int q[4],
+                SearchOutput& out, const QueryDefaults& dflt) {
+    int verbosity = wireVerbosity(rd, dflt.verbosity);
+    int every = rd.i32();
+    beginQuery(out, verbosity, rd.good ? every : dflt.streamEvery, true, std::max(1, G.C));
+    solver.solve(G, q[0], q[1], q[2], q[3], out);
+    sendResult(std::cout, out);
+}
+
+// Atiende un mensaje binario; devuelve false si hay que terminar (EXIT/EOF)
+template <class Solver>
+bool handleFrame(Solver& solver, GridMap& G, SearchOutput& out, const QueryDefaults& dflt) {
+    std::string payload;
+    if (!readFrame(std::cin, payload)) return false;
+    WireReader rd(payload);
+    int q[4];
+
+    switch (rd.type()) {
+    case 'I':
+        if (!loadGridFrame(rd, G, q)) { sendError(std::cout, "init"); return true; }
+        notifyLoad(solver, G, 0);
+        sendAck(std::cout);
+        return true;
+    case 'U': {
+        int n = rd.i32();
+        for (int i = 0; i < n && rd.good; i++) {
+            int r = rd.i32(), c = rd.i32(), blocked = rd.i32();
+            if (rd.good) updateCell(solver, G, r, c, blocked != 0);
+        }
+        sendAck(std::cout);
+        return true;
+    }
+    case 'G':
+        if (!loadGridFrame(rd, G, q)) { sendError(std::cout, "grid"); return true; }
+        notifyLoad(solver, G, 0);
+        solveFrame(solver, G, rd, q, out, dflt);
+        return true;
+    case 'Q':
+        for (int i = 0; i < 4; i++) q[i] = rd.i32();
+        if (rd.good) solveFrame(solver, G, rd, q, out, dflt);
+        else { out.clear(); sendResult(std::cout, out); }
+        return true;
+    case 'X':
+        sendAck(std::cout);
+        return false;
+    default:
+        sendError(std::cout, "unknown");
+        return true;
+    }
+}
+
+template <class Solver>
+int serveLoop(Solver& solver, const QueryDefaults& dflt) {
+    GridMap G;
+    SearchOutput out;
+    std::string line;
+
+    auto trim = [](std::string s) {
+        while (!s.empty() && (s.back() == '\r' || s.back() == '\n')) s.pop_back();
+        return s;
+    };
+
+    while (true) {
+        int ch = wirePeek(std::cin);
+        if (ch == EOF) break;
+        if (ch == WIRE_MAGIC) {
+            if (!handleFrame(solver, G, out, dflt)) break;
+            continue;
+        }
+        if (!std::getline(std::cin, line)) break;
+        line = trim(line);
+        if (line.empty()) continue;
+
+        std::stringstream ss(line);
+        std::string cmd; ss >> cmd;
+
+        if (cmd == "INIT") {
+            int R = 0, C = 0;
+            ss >> R >> C;
+            if (R <= 0 || C <= 0 || !readCells(std::cin, R, C, G)) {
+                G.reset(0, 0);
+                std::cout << "ERR init\nEND\n" << std::flush;
+                continue;
+            }
+            notifyLoad(solver, G, 0);
+            std::cout << "OK\nEND\n" << std::flush;
+        }
+        else if (cmd == "UPDATE") {
+            int r = -1, c = -1; double cost = 1;
+            ss >> r >> c >> cost;
+            updateCell(solver, G, r, c, cost >= ENGINE_BLOCK / 2);
+            std::cout << "OK\nEND\n" << std::flush;
+        }
+        else if (cmd == "UPDATE_RECT") {
+            int r0 = 0, c0 = 0, r1 = -1, c1 = -1; double cost = 1;
+            ss >> r0 >> c0 >> r1 >> c1 >> cost;
+            updateRect(solver, G, r0, c0, r1, c1, cost >= ENGINE_BLOCK / 2);
+            std::cout << "OK\nEND\n" << std::flush;
+        }
+        else if (cmd == "STATS") {
+            std::cout << "Rows " << G.R << "\nCols " << G.C << "\nFree " << G.countFree() << "\nEND\n" << std::flush;
+        }
+        else if (cmd == "QUERY") {
+            int sr = -1, sc = -1, er = -1, ec = -1;
+            int verbosity = dflt.verbosity, every = dflt.streamEvery;
+            ss >> sr >> sc >> er >> ec;
+            for (std::string opt; ss >> opt; ) {
+                if (opt == "STREAM") ss >> every;
+                else parseVerbosity(opt, verbosity);
+            }
+            beginQuery(out, verbosity, every, false, std::max(1, G.C));
+            solver.solve(G, sr, sc, er, ec, out);
+            printOutput(std::cout, out, std::max(1, G.C));
+            std::cout << "END\n" << std::flush;
+        }
+        else if (cmd == "EXIT") {
+            std::cout << "BYE\nEND\n" << std::flush;
+            break;
+        }
+        else {
+            std::cout << "ERR unknown\nEND\n" << std::flush;
+        }
+    }
+    return 0;
+}
+
+template <class Solver>
+int engineMain(int argc, char** argv, Solver& solver) {
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+
+    // --verbosity=LEVEL: nivel por defecto de las consultas (ver wire.hpp)
+    // --stream=N: lotes parciales de N celdas expandidas (0 = sin streaming)
+    bool server = false;
+    QueryDefaults dflt;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--server") server = true;
+        else if (a.rfind("--verbosity=", 0) == 0 && !parseVerbosity(a.substr(12), dflt.verbosity)) {
+            std::cerr << "Nivel de detalle desconocido: " << a.substr(12) << "\n";
+            return 1;
+        }
+        else if (a.rfind("--stream=", 0) == 0) dflt.streamEvery = std::atoi(a.c_str() + 9);
+    }
+    if (server) return serveLoop(solver, dflt);
+
+    // Consulta binaria ('G'): misma semántica, respuesta 'R'
+    if (wirePeek(std::cin) == WIRE_MAGIC) {
+        GridMap G;
+        SearchOutput out;
+        handleFrame(solver, G, out, dflt);
+        return 0;
+    }
+
+    int R, C, sr, sc, er, ec;
+    if (!(std::cin >> R >> C >> sr >> sc >> er >> ec)) { std::cout << "Visited:\nParents:\nPath:\n"; return 0; }
+
+    GridMap G;
+    readCells(std::cin, R, C, G);
+    notifyLoad(solver, G, 0);
+
+    SearchOutput out;
+    beginQuery(out, dflt.verbosity, dflt.streamEvery, false, std::max(1, C));
+    solver.solve(G, sr, sc, er, ec, out);
+    printOutput(std::cout, out, std::max(1, C));
+    return 0;
+}
@@ -0,0 +1,582 @@
+#include <bits/stdc++.h>
+#include "engine_io.hpp"
+#include "bucket_queue.hpp"
+using namespace std;
+
+/*
+  HPA* (Hierarchical Path-Finding A*) 4-dir, coste 1.
+
+  El mapa se divide en clusters de K x K celdas (HPA_CLUSTER, 48 por defecto).
+  En cada borde entre dos clusters vecinos se buscan las posiciones donde ambos
+  lados están libres ("entradas") y se agrupan en ventanas de K/2 celdas: cada
+  grupo aporta una transición por par de componentes conexas (del cluster de
+  cada lado) que toca, en la posición más cercana a su centro. Así no se
+  pierde ninguna conexión y en mapas abiertos quedan 2 por borde y unos 8
+  nodos por cluster. Las celdas de transición son los nodos del grafo
+  abstracto:
+    - aristas inter-cluster: cruzar el borde (coste 1)
+    - aristas intra-cluster: distancia BFS dentro del cluster entre cada par de
+      nodos, precalculada por cluster junto con el camino (caché de la
+      abstracción: el refinado no vuelve a buscar)
+
+  Los nodos abstractos tienen ids compactos (un rango contiguo por cluster,
+  ver layout), así el A* abstracto trabaja sobre arreglos chicos y no sobre
+  los de R*C celdas.
+
+  Consulta: BFS dentro del cluster del inicio y del de la meta para conectarlos
+  al grafo abstracto, A* sobre el grafo abstracto (Manhattan), refinado con los
+  caminos guardados y los árboles BFS de s y t, y suavizado local
+  (smoothPath). Si inicio y meta están en el mismo cluster o en clusters
+  vecinos se hace además un BFS directo en el rectángulo que los cubre y se
+  devuelve el más corto de los dos (si el directo ya mide la distancia
+  Manhattan ni se busca en el grafo abstracto). El camino es aproximado: el
+  grafo abstracto solo pasa por las transiciones elegidas y el suavizado no
+  siempre recupera el óptimo.
+
+  Con --server el grafo abstracto se construye en INIT y cada UPDATE r c cost
+  (misma semántica que dstar_lite.cpp) solo marca su cluster como sucio; antes
+  de la siguiente consulta se recalculan los bordes de los clusters sucios y
+  las distancias intra-cluster de esos clusters y sus vecinos.
+
+  Entrada/Salida: igual que astar.cpp. Visited/Parents son nodos abstractos
+  (el padre no tiene por qué ser adyacente) más las celdas del BFS directo si
+  se hizo; Path es el camino completo.
+*/
+
+struct Node{ int id,g,f; };
+struct Cmp{ bool operator()(const Node&a,const Node&b)const{ return (a.f!=b.f)? a.f>b.f : a.g>b.g; } };
+static const int DR[4]={-1,1,0,0}, DC[4]={0,0,-1,1};
+static inline int H(int r,int c,int er,int ec){ return abs(r-er)+abs(c-ec); }
+
+// Ventana del suavizado: celdas hacia adelante que se intentan acortar
+static const int SMOOTH_WIN=16;
+// Ids libres por cluster además de sus nodos, para que un UPDATE que agrega
+// transiciones no obligue a rehacer el layout
+static const int SLACK=2;
+
+// Rectángulo de celdas (un cluster, o dos vecinos para el BFS directo)
+struct Box { int r0=0, c0=0, h=0, w=0; };
+
+struct Cluster : Box {
+  vector<int> nodes;          // celdas de transición (ids globales)
+  vector<int> dist;           // nodes.size()^2, -1 = no alcanzable dentro del cluster
+  vector<int> routeOff;       // nodes.size()^2+1: camino a->b en route[routeOff[a*n+b]..)
+  vector<uint8_t> route;      // pasos (índice de DR/DC) de los caminos intra-cluster
+  vector<vector<int>> inter;  // por nodo: celdas al otro lado del borde
+};
+
+struct AEdge { int to, w; };
+
+struct HPASolver {
+  int K=48;
+  int SPAN=24;                // ancho de un grupo de entradas (K/2)
+  const GridMap* G=nullptr;
+  int CR=0, CC=0;
+  vector<Cluster> clusters;
+  vector<vector<pair<int,int>>> vBorder, hBorder; // transiciones (lado menor, lado mayor)
+  vector<int> nodeIdx;        // índice del nodo dentro de su cluster, -1 si no es nodo
+  vector<int> comp;           // componente conexa de cada celda libre dentro de su cluster
+  vector<char> dirty;
+  vector<int> dirtyList;
+
+  // Grafo abstracto: el cluster ci ocupa los ids clBase[ci] .. + clCap[ci]-1
+  // (índice del nodo en el cluster); los dos últimos son s y t. Cada id tiene
+  // lugar para clCap+1 aristas en un arreglo plano (intra: n-1, inter: 2 si la
+  // celda es esquina de dos bordes): una expansión lee una sola zona
+  vector<int> clBase, clCap;
+  vector<int> absCell;        // celda de cada id (-1 si el slot está libre)
+  vector<int> absClu;         // cluster de cada id (-1 para s y t)
+  vector<AEdge> aAdj;         // aristas de u en aAdj[aOff[u] .. + aDeg[u])
+  vector<int> aOff, aDeg;
+  int S_ID=0, T_ID=0;
+
+  // Búsqueda abstracta (buffers reutilizados; solo se limpian los ids tocados)
+  vector<int> gCost, aPar;
+  vector<char> closed;
+  vector<int> aTouched;
+  BucketHeap<Node, Cmp> open; // por f; dentro de la cubeta, mayor g primero
+
+  // Salida de Parents en celdas (BFS directo y nodos abstractos)
+  vector<int> par;
+  vector<int> touched;
+
+  // BFS local a un Box (hasta 2K x 2K celdas)
+  vector<int> bfsDist, bfsPar, bfsQueue;
+  vector<uint8_t> bfsDir;     // paso con el que se llegó a cada celda
+  vector<uint8_t> boxMask;    // vecinos libres dentro del Box (ver loadBox)
+  Box maskBox;                // Box de boxMask (h = 0: ninguno)
+  vector<int> sPar, tPar;     // árboles BFS de s y t en sus clusters (refinado)
+  vector<int> entPos;         // posición en el borde de cada transición del grupo (entrances)
+
+  HPASolver(){
+    if(const char* k=getenv("HPA_CLUSTER")){
+      int v=atoi(k);
+      if(v>=4) K=v;
+    }
+    SPAN=max(1, K/2);
+  }
+
+  int clusterOf(int r,int c) const { return (r/K)*CC + c/K; }
+  int absOf(int cell) const { return clBase[clusterOf(cell/G->C, cell%G->C)] + nodeIdx[cell]; }
+
+  // ---------- Construcción del grafo abstracto ----------
+
+  void onLoad(const GridMap& g){
+    G=&g;
+    CR=(g.R+K-1)/K; CC=(g.C+K-1)/K;
+    clusters.assign(CR*CC, Cluster());
+    for(int i=0;i<CR;i++) for(int j=0;j<CC;j++){
+      Cluster& cl=clusters[i*CC+j];
+      cl.r0=i*K; cl.c0=j*K;
+      cl.h=min(K, g.R-cl.r0); cl.w=min(K, g.C-cl.c0);
+    }
+    vBorder.assign(CR*CC, {}); hBorder.assign(CR*CC, {});
+    nodeIdx.assign((size_t)g.R*g.C, -1);
+    comp.assign((size_t)g.R*g.C, -1);
+    dirty.assign(CR*CC, 0); dirtyList.clear();
+    par.assign((size_t)g.R*g.C, -1); touched.clear();
+    bfsDist.assign(4*K*K, -1); bfsPar.assign(4*K*K, -1); bfsDir.assign(4*K*K, 0);
+    boxMask.assign(4*K*K, 0); maskBox=Box();
+
+    for(int ci=0;ci<CR*CC;ci++) labelCluster(ci);
+    for(int i=0;i<CR;i++) for(int j=0;j<CC;j++){
+      if(j+1<CC) buildVBorder(i,j);
+      if(i+1<CR) buildHBorder(i,j);
+    }
+    for(int ci=0;ci<CR*CC;ci++) buildCluster(ci);
+    layout();
+  }
+
+  // Ids y lugar de aristas de cada cluster (nodos + SLACK) y enlace de todos;
+  // en INIT y cuando un UPDATE deja a un cluster con más nodos que su lugar
+  void layout(){
+    int NC=CR*CC, A=0;
+    clBase.resize(NC); clCap.resize(NC);
+    for(int ci=0;ci<NC;ci++){
+      clBase[ci]=A; clCap[ci]=(int)clusters[ci].nodes.size()+SLACK;
+      A+=clCap[ci];
+    }
+    S_ID=A; T_ID=A+1; A+=2;
+    absCell.assign(A, -1); absClu.assign(A, -1);
+    aOff.assign(A, 0); aDeg.assign(A, 0);
+    size_t E=0;
+    for(int ci=0;ci<NC;ci++) for(int k=0;k<clCap[ci];k++){
+      int u=clBase[ci]+k;
+      absClu[u]=ci; aOff[u]=(int)E; E+=clCap[ci]+1;
+    }
+    aAdj.assign(E, AEdge{0,0});
+    gCost.assign(A, INT_MAX); aPar.assign(A, -1); closed.assign(A, 0); aTouched.clear();
+    for(int ci=0;ci<NC;ci++) linkCluster(ci);
+  }
+
+  // Componentes conexas de las celdas libres de un cluster (sin salir de él)
+  void labelCluster(int ci){
+    const Cluster& cl=clusters[ci];
+    loadBox(cl);
+    const int step[4]={-cl.w, cl.w, -1, 1};
+    for(int lr=0;lr<cl.h;lr++) fill_n(&comp[G->id(cl.r0+lr, cl.c0)], cl.w, -1);
+    int label=0;
+    for(int v0=0; v0<cl.h*cl.w; v0++){
+      int c0=global(cl,v0);
+      if(comp[c0]!=-1 || G->blocked(cl.r0+v0/cl.w, cl.c0+v0%cl.w)) continue;
+      comp[c0]=label;
+      bfsQueue.assign(1, v0);
+      for(size_t qi=0; qi<bfsQueue.size(); qi++){
+        int u=bfsQueue[qi];
+        for(unsigned m=boxMask[u]; m; m&=m-1){
+          int v=u+step[__builtin_ctz(m)], gv=global(cl,v);
+          if(comp[gv]!=-1) continue;
+          comp[gv]=label; bfsQueue.push_back(v);
+        }
+      }
+      label++;
+    }
+  }
+
+  void onCell(const GridMap& g,int r,int c){
+    G=&g;
+    if(clusters.empty()) return;
+    int ci=clusterOf(r,c);
+    maskBox=Box();
+    if(!dirty[ci]){ dirty[ci]=1; dirtyList.push_back(ci); }
+  }
+
+  // Posiciones libres a ambos lados de un borde -> transiciones: se agrupan en
+  // ventanas de hasta SPAN celdas desde la primera libre y cada grupo aporta
+  // una transición por par (componente de un lado, componente del otro), la
+  // posición de ese par más cercana al centro del grupo. Con una sola por
+  // grupo, una componente que solo sale por ese grupo quedaría desconectada.
+  template<class At>
+  void entrances(int len, At at, vector<pair<int,int>>& out){
+    out.clear();
+    int i=0;
+    while(i<len){
+      if(at(i).first<0){ i++; continue; }
+      int a=i, b=i;
+      for(; i<len && i-a<SPAN; i++) if(at(i).first>=0) b=i;
+      int mid=(a+b)/2;
+      size_t first=out.size();
+      entPos.clear();
+      for(int p=a;p<=b;p++){
+        auto e=at(p);
+        if(e.first<0) continue;
+        size_t k=first;
+        while(k<out.size() && (comp[out[k].first]!=comp[e.first] || comp[out[k].second]!=comp[e.second])) k++;
+        if(k==out.size()){ out.push_back(e); entPos.push_back(p); }
+        else if(abs(p-mid)<abs(entPos[k-first]-mid)){ out[k]=e; entPos[k-first]=p; }
+      }
+    }
+  }
+
+  // Borde vertical entre (i,j) y (i,j+1)
+  void buildVBorder(int i,int j){
+    const Cluster& cl=clusters[i*CC+j];
+    int cA=cl.c0+cl.w-1, cB=cA+1;
+    entrances(cl.h, [&](int k)->pair<int,int>{
+      int r=cl.r0+k;
+      if(G->blocked(r,cA) || G->blocked(r,cB)) return {-1,-1};
+      return {G->id(r,cA), G->id(r,cB)};
+    }, vBorder[i*CC+j]);
+  }
+
+  // Borde horizontal entre (i,j) y (i+1,j)
+  void buildHBorder(int i,int j){
+    const Cluster& cl=clusters[i*CC+j];
+    int rA=cl.r0+cl.h-1, rB=rA+1;
+    entrances(cl.w, [&](int k)->pair<int,int>{
+      int c=cl.c0+k;
+      if(G->blocked(rA,c) || G->blocked(rB,c)) return {-1,-1};
+      return {G->id(rA,c), G->id(rB,c)};
+    }, hBorder[i*CC+j]);
+  }
+
+  int addNode(Cluster& cl,int cell){
+    if(nodeIdx[cell]==-1){
+      nodeIdx[cell]=(int)cl.nodes.size();
+      cl.nodes.push_back(cell);
+      cl.inter.emplace_back();
+    }
+    return nodeIdx[cell];
+  }
+
+  // Nodos, aristas inter e intra-cluster de un cluster a partir de sus 4 bordes
+  void buildCluster(int ci){
+    Cluster& cl=clusters[ci];
+    for(int v:cl.nodes) nodeIdx[v]=-1;
+    cl.nodes.clear(); cl.inter.clear();
+    int i=ci/CC, j=ci%CC;
+    if(j>0)    for(auto [a,b]:vBorder[ci-1])  cl.inter[addNode(cl,b)].push_back(a);
+    if(j+1<CC) for(auto [a,b]:vBorder[ci])    cl.inter[addNode(cl,a)].push_back(b);
+    if(i>0)    for(auto [a,b]:hBorder[ci-CC]) cl.inter[addNode(cl,b)].push_back(a);
+    if(i+1<CR) for(auto [a,b]:hBorder[ci])    cl.inter[addNode(cl,a)].push_back(b);
+
+    int n=(int)cl.nodes.size();
+
+    // Distancias y caminos entre cada par de nodos. La grilla es no dirigida:
+    // b->a (b < a) es a->b al revés, con los pasos invertidos (k^1), así
+    // alcanza un BFS por nodo salvo el último
+    cl.dist.assign((size_t)n*n, -1);
+    cl.routeOff.assign((size_t)n*n+1, 0);
+    cl.route.clear();
+    for(int a=0;a<n;a++){
+      if(a+1<n) bfsBox(cl, cl.nodes[a], -1);
+      for(int b=0;b<n;b++){
+        size_t e=(size_t)a*n+b, at=cl.route.size();
+        cl.routeOff[e]=(int)at;
+        if(b<a){
+          size_t r=(size_t)b*n+a;
+          int d=cl.dist[e]=cl.dist[r];
+          cl.route.resize(at+max(d,0));
+          for(int k=0;k<d;k++) cl.route[at+k]=cl.route[cl.routeOff[r+1]-1-k]^1;
+          continue;
+        }
+        if(b==a){ cl.dist[e]=0; continue; }
+        int lb=local(cl,cl.nodes[b]), d=bfsDist[lb];
+        cl.dist[e]=d;
+        if(d<=0) continue;
+        cl.route.resize(at+d);
+        for(int v=lb, k=d-1; k>=0; v=bfsPar[v], k--) cl.route[at+k]=bfsDir[v];
+      }
+    }
+    cl.routeOff[(size_t)n*n]=(int)cl.route.size();
+  }
+
+  // Ids y aristas abstractas de un cluster; dependen de los índices de los
+  // nodos de los vecinos, así que van después de buildCluster de todos ellos
+  void linkCluster(int ci){
+    const Cluster& cl=clusters[ci];
+    int n=(int)cl.nodes.size(), base=clBase[ci];
+    for(int a=0;a<clCap[ci];a++){
+      int u=base+a, deg=0;
+      AEdge* e=&aAdj[aOff[u]];
+      absCell[u]= a<n ? cl.nodes[a] : -1;
+      if(a<n){
+        for(int b=0;b<n;b++){
+          int d=cl.dist[(size_t)a*n+b];
+          if(d>0) e[deg++]={base+b, d};
+        }
+        for(int v:cl.inter[a]) e[deg++]={absOf(v), 1};
+      }
+      aDeg[u]=deg;
+    }
+  }
+
+  // Recalcula bordes y clusters afectados por UPDATE desde la última consulta
+  void rebuildDirty(){
+    if(dirtyList.empty()) return;
+    for(int ci:dirtyList) labelCluster(ci);
+    vector<int> affected;
+    auto mark=[&](int ci){ if(dirty[ci]!=2){ dirty[ci]=2; affected.push_back(ci); } };
+    for(int ci:dirtyList){
+      int i=ci/CC, j=ci%CC;
+      if(j>0)    { buildVBorder(i,j-1); mark(ci-1); }
+      if(j+1<CC) { buildVBorder(i,j);   mark(ci+1); }
+      if(i>0)    { buildHBorder(i-1,j); mark(ci-CC); }
+      if(i+1<CR) { buildHBorder(i,j);   mark(ci+CC); }
+      mark(ci);
+    }
+    bool grow=false;
+    for(int ci:affected){
+      buildCluster(ci);
+      if((int)clusters[ci].nodes.size()>clCap[ci]) grow=true;
+    }
+    dirtyList.clear();
+    if(grow){
+      for(int ci:affected) dirty[ci]=0;
+      layout();
+      return;
+    }
+    // Los vecinos de los reconstruidos apuntan a sus nodos: se reenlazan también
+    vector<int> relink;
+    auto mark2=[&](int ci){ if(dirty[ci]!=3){ dirty[ci]=3; relink.push_back(ci); } };
+    for(int ci:affected){
+      int i=ci/CC, j=ci%CC;
+      mark2(ci);
+      if(j>0) mark2(ci-1);
+      if(j+1<CC) mark2(ci+1);
+      if(i>0) mark2(ci-CC);
+      if(i+1<CR) mark2(ci+CC);
+    }
+    for(int ci:relink){ linkCluster(ci); dirty[ci]=0; }
+  }
+
+  // ---------- BFS dentro de un cluster (o Box) ----------
+
+  int local(const Box& cl,int cell) const {
+    return (cell/G->C-cl.r0)*cl.w + (cell%G->C-cl.c0);
+  }
+  int global(const Box& cl,int v) const { return G->id(cl.r0+v/cl.w, cl.c0+v%cl.w); }
+
+  // Vecinos libres de cada celda del Box recortados al Box (freeMask4 sin los
+  // que salen): se calcula una vez por Box y lo comparten los BFS sobre él
+  void loadBox(const Box& cl){
+    if(maskBox.r0==cl.r0 && maskBox.c0==cl.c0 && maskBox.h==cl.h && maskBox.w==cl.w) return;
+    maskBox=cl;
+    for(int lr=0;lr<cl.h;lr++) for(int lc=0;lc<cl.w;lc++){
+      unsigned m=G->freeMask4(cl.r0+lr, cl.c0+lc);
+      if(lr==0) m&=~1u;
+      if(lr==cl.h-1) m&=~2u;
+      if(lc==0) m&=~4u;
+      if(lc==cl.w-1) m&=~8u;
+      boxMask[lr*cl.w+lc]=(uint8_t)m;
+    }
+  }
+
+  // Distancias desde 'src' limitadas a las celdas del Box; se detiene en 'stop' si != -1
+  void bfsBox(const Box& cl,int src,int stop){
+    loadBox(cl);
+    fill(bfsDist.begin(), bfsDist.begin()+cl.h*cl.w, -1);
+    bfsQueue.clear();
+    int ls=local(cl,src), lt= stop!=-1 ? local(cl,stop) : -1;
+    const int step[4]={-cl.w, cl.w, -1, 1};
+    bfsDist[ls]=0; bfsPar[ls]=-1; bfsQueue.push_back(ls);
+    for(size_t qi=0; qi<bfsQueue.size(); qi++){
+      int u=bfsQueue[qi];
+      if(u==lt) return;
+      for(unsigned m=boxMask[u]; m; m&=m-1){
+        int k=__builtin_ctz(m), v=u+step[k];
+        if(bfsDist[v]!=-1) continue;
+        bfsDist[v]=bfsDist[u]+1; bfsPar[v]=u; bfsDir[v]=(uint8_t)k; bfsQueue.push_back(v);
+      }
+    }
+  }
+
+  // ---------- Consulta ----------
+
+  void reset(){
+    for(int v:aTouched){ gCost[v]=INT_MAX; aPar[v]=-1; closed[v]=0; }
+    aTouched.clear();
+    open.clear();
+    for(int v:touched) par[v]=-1;
+    touched.clear();
+  }
+
+  void solve(const GridMap& g,int sr,int sc,int er,int ec,SearchOutput& out){
+    if(G!=&g || clusters.empty()) onLoad(g);
+    rebuildDirty();
+    if(!g.freeCell(sr,sc) || !g.freeCell(er,ec)) return;
+    int s=g.id(sr,sc), t=g.id(er,ec);
+    if(s==t){ out.visit(s); out.path.push_back(s); return; }
+
+    reset();
+    int csi=clusterOf(sr,sc), cti=clusterOf(er,ec);
+    const Cluster& cs=clusters[csi];
+    const Cluster& ct=clusters[cti];
+
+    // Mismo cluster o vecinos: BFS directo en el rectángulo que cubre ambos
+    vector<int> direct;
+    if(abs(cs.r0-ct.r0)<=K && abs(cs.c0-ct.c0)<=K){
+      Box box;
+      box.r0=min(cs.r0,ct.r0); box.c0=min(cs.c0,ct.c0);
+      box.h=max(cs.r0+cs.h, ct.r0+ct.h)-box.r0;
+      box.w=max(cs.c0+cs.w, ct.c0+ct.w)-box.c0;
+      bfsBox(box, s, t);
+      if(bfsDist[local(box,t)]!=-1){
+        for(int v=local(box,t); v!=-1; v=bfsPar[v]) direct.push_back(global(box,v));
+        reverse(direct.begin(), direct.end());
+        for(int v:bfsQueue){
+          int gv=global(box,v);
+          out.visit(gv); touched.push_back(gv);
+          if(bfsPar[v]!=-1) par[gv]=global(box,bfsPar[v]);
+        }
+        // Ya es óptimo: no hace falta el grafo abstracto
+        if((int)direct.size()-1==H(sr,sc,er,ec)){
+          out.path=move(direct);
+          collectParents(touched,par,out);
+          return;
+        }
+      }
+    }
+
+    // Conexión de s y t al grafo abstracto (coste 0 si s o t ya es un nodo)
+    absCell[S_ID]=s; absCell[T_ID]=t;
+    vector<pair<int,int>> sEdges; // (id abstracto, coste)
+    bfsBox(cs, s, -1);
+    for(size_t k=0;k<cs.nodes.size();k++){
+      int d=bfsDist[local(cs,cs.nodes[k])];
+      if(d>=0) sEdges.push_back({clBase[csi]+(int)k, d});
+    }
+    if(csi==cti && bfsDist[local(cs,t)]>0) sEdges.push_back({T_ID, bfsDist[local(cs,t)]});
+    sPar.assign(bfsPar.begin(), bfsPar.begin()+cs.h*cs.w);
+    bfsBox(ct, t, -1);
+    vector<int> tDist(bfsDist.begin(), bfsDist.begin()+ct.h*ct.w);
+    tPar.assign(bfsPar.begin(), bfsPar.begin()+ct.h*ct.w);
+
+    auto relax=[&](int u,int v,int w){
+      if(closed[v]) return;
+      int ng=gCost[u]+w;
+      if(ng<gCost[v]){
+        if(gCost[v]==INT_MAX) aTouched.push_back(v);
+        gCost[v]=ng; aPar[v]=u;
+        int cv=absCell[v];
+        int f=ng + H(cv/g.C,cv%g.C,er,ec);
+        open.push(f, {v,ng,f});
+      }
+    };
+
+    gCost[S_ID]=0; aTouched.push_back(S_ID); open.push(H(sr,sc,er,ec), {S_ID,0,H(sr,sc,er,ec)});
+    while(!open.empty()){
+      auto cur=open.top(); open.pop();
+      int u=cur.id;
+      if(closed[u]) continue;
+      closed[u]=1;
+      out.visit(absCell[u]);
+      if(u==T_ID) break;
+
+      if(u==S_ID){ for(auto [v,w]:sEdges) relax(u,v,w); continue; }
+      const AEdge* e=&aAdj[aOff[u]];
+      for(int k=0;k<aDeg[u];k++) relax(u, e[k].to, e[k].w);
+      if(absClu[u]==cti){
+        int d=tDist[local(ct,absCell[u])];
+        if(d>=0) relax(u, T_ID, d);
+      }
+    }
+
+    if(gCost[T_ID]!=INT_MAX){ refinePath(cs,ct,out); smoothPath(out.path); }
+    if(!direct.empty() && (out.path.empty() || direct.size()<out.path.size())) out.path=move(direct);
+    if(out.keepParents())
+      for(int v:aTouched) if(aPar[v]!=-1 && absCell[v]!=absCell[aPar[v]]){
+        touched.push_back(absCell[v]);
+        par[absCell[v]]=absCell[aPar[v]];
+      }
+    collectParents(touched,par,out);
+  }
+
+  // Camino abstracto -> celdas, sin búsquedas nuevas: los tramos entre nodos
+  // salen de la caché del cluster y los de s / t de sus árboles BFS
+  void refinePath(const Cluster& cs,const Cluster& ct,SearchOutput& out){
+    vector<int> coarse;
+    for(int v=T_ID; v!=-1; v=aPar[v]) coarse.push_back(v);
+    reverse(coarse.begin(), coarse.end());
+    int s=absCell[S_ID];
+    out.path.push_back(s);
+    vector<int> seg;
+    for(size_t i=1;i<coarse.size();i++){
+      int ua=coarse[i-1], ub=coarse[i];
+      int a=absCell[ua], b=absCell[ub];
+      if(a==b) continue;                    // s o t coincide con un nodo
+      if(ua==S_ID){
+        // s -> b: árbol de s al revés
+        seg.clear();
+        for(int v=local(cs,b); v!=-1; v=sPar[v]) seg.push_back(global(cs,v));
+        for(int k=(int)seg.size()-2;k>=0;k--) out.path.push_back(seg[k]);
+      } else if(ub==T_ID){
+        // a -> t: el árbol de t ya apunta hacia t
+        for(int v=tPar[local(ct,a)]; v!=-1; v=tPar[v]) out.path.push_back(global(ct,v));
+      } else if(absClu[ua]!=absClu[ub]){
+        out.path.push_back(b);              // cruce de borde
+      } else {
+        int ci=absClu[ua];
+        const Cluster& cl=clusters[ci];
+        size_t e=(size_t)(ua-clBase[ci])*cl.nodes.size()+(ub-clBase[ci]);
+        int v=a;
+        for(int k=cl.routeOff[e]; k<cl.routeOff[e+1]; k++){
+          v+=DR[cl.route[k]]*G->C+DC[cl.route[k]];
+          out.path.push_back(v);
+        }
+      }
+    }
+  }
+
+  // Camino en L de a a b (primero filas si rowsFirst); false si cruza un obstáculo
+  bool lPath(int a,int b,bool rowsFirst,vector<int>& cells) const {
+    int r=a/G->C, c=a%G->C, br=b/G->C, bc=b%G->C;
+    cells.clear();
+    for(int leg=0;leg<2;leg++){
+      bool rows=(leg==0)==rowsFirst;
+      while(rows ? r!=br : c!=bc){
+        if(rows) r+=(br>r)?1:-1; else c+=(bc>c)?1:-1;
+        if(G->blocked(r,c)) return false;
+        cells.push_back(G->id(r,c));
+      }
+    }
+    return true;
+  }
+
+  // Suavizado: un tramo path[i..j] (j hasta SMOOTH_WIN celdas adelante) más
+  // largo que la distancia Manhattan entre sus extremos se cambia por un camino
+  // en L libre, primero el j más lejano. Quita los rodeos locales que deja
+  // pasar por las transiciones; una pasada, para que cueste O(largo).
+  void smoothPath(vector<int>& path) const {
+    vector<int> res, cells;
+    int n=(int)path.size();
+    res.push_back(path[0]);
+    for(int i=0;i<n-1;){
+      int a=path[i], jump=-1;
+      for(int j=min(n-1, i+SMOOTH_WIN); j>i+1 && jump==-1; j--){
+        int b=path[j];
+        if(H(a/G->C,a%G->C,b/G->C,b%G->C) >= j-i) continue;
+        if(lPath(a,b,true,cells) || lPath(a,b,false,cells)) jump=j;
+      }
+      if(jump==-1){ res.push_back(path[++i]); continue; }
+      res.insert(res.end(), cells.begin(), cells.end());
+      i=jump;
+    }
+    path.swap(res);
+  }
+};
+
+int main(int argc, char** argv){
+  HPASolver solver;
+  return engineMain(argc, argv, solver);
+}
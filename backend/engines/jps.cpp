@@ -0,0 +1,181 @@
+#include <bits/stdc++.h>
+#include "engine_io.hpp"
+using namespace std;
+
+/*
+  Jump Point Search 4-dir, coste 1, heurística Manhattan.
+  Solo expande "puntos de salto": celdas con un vecino forzado, la meta, o (en
+  saltos verticales) celdas desde las que un salto horizontal encuentra uno.
+  Los saltos horizontales recorren la fila de 64 en 64 celdas sobre la grilla
+  de bits (bitgrid.hpp).
+
+  Entrada:
+    rows cols sr sc er ec
+    grid (0 libre, 1 obstáculo)
+  Salida:
+    Visited:    puntos de salto expandidos
+    r c
+    ...
+    Parents:    árbol de puntos de salto (el padre no tiene por qué ser adyacente)
+    r c pr pc
+    ...
+    Path:       camino completo celda a celda
+    r c
+    ...
+
+  Con --server queda como proceso persistente (INIT/UPDATE/QUERY, ver engine_io.hpp).
+*/
+
+struct Node{ int id,g,f; };
+struct Cmp{ bool operator()(const Node&a,const Node&b)const{ return (a.f!=b.f)? a.f>b.f : a.g>b.g; } };
+static inline int H(int r,int c,int er,int ec){ return abs(r-er)+abs(c-ec); }
+static inline int sgn(int x){ return (x>0)-(x<0); }
+
+struct JPSSolver {
+  // Buffers reutilizados entre consultas; solo se limpian las celdas tocadas.
+  vector<int> gCost, par;
+  vector<char> closed;
+  vector<int> touched;
+
+  const GridMap* G=nullptr;
+  int er=0, ec=0;
+
+  void reset(int N){
+    const int INF=INT_MAX;
+    if((int)gCost.size()!=N){ gCost.assign(N,INF); par.assign(N,-1); closed.assign(N,0); }
+    else for(int v:touched){ gCost[v]=INF; par[v]=-1; closed[v]=0; }
+    touched.clear();
+  }
+
+  // Salto hacia la derecha desde (r,c) (se llega desde c-1). Devuelve la
+  // columna del punto de salto o -1 si choca con un obstáculo / el borde.
+  // Vecino forzado en p: arriba (o abajo) libre en p y bloqueado en p-1.
+  int jumpRight(int r,int c) const {
+    if(c>=G->C) return -1;
+    const uint64_t* B=G->row(r);
+    const uint64_t* U= r>0 ? G->row(r-1) : nullptr;
+    const uint64_t* D= r+1<G->R ? G->row(r+1) : nullptr;
+    for(int w=c>>6; w<G->W; w++){
+      uint64_t stop=B[w];
+      if(U) stop|= ~U[w] & ((U[w]<<1) | (w? U[w-1]>>63 : 1));
+      if(D) stop|= ~D[w] & ((D[w]<<1) | (w? D[w-1]>>63 : 1));
+      if(r==er && (ec>>6)==w) stop|= 1ULL<<(ec&63);
+      if(w==(c>>6)) stop&= ~0ULL<<(c&63);
+      if(stop){
+        int p=w*64+__builtin_ctzll(stop);
+        return G->blocked(r,p)? -1 : p; // el relleno de la fila cuenta como obstáculo
+      }
+    }
+    return -1;
+  }
+
+  // Igual que jumpRight pero hacia la izquierda (se llega desde c+1).
+  int jumpLeft(int r,int c) const {
+    if(c<0) return -1;
+    const uint64_t* B=G->row(r);
+    const uint64_t* U= r>0 ? G->row(r-1) : nullptr;
+    const uint64_t* D= r+1<G->R ? G->row(r+1) : nullptr;
+    const int W=G->W;
+    for(int w=c>>6; w>=0; w--){
+      uint64_t stop=B[w];
+      if(U) stop|= ~U[w] & ((U[w]>>1) | (w+1<W? U[w+1]<<63 : 1ULL<<63));
+      if(D) stop|= ~D[w] & ((D[w]>>1) | (w+1<W? D[w+1]<<63 : 1ULL<<63));
+      if(r==er && (ec>>6)==w) stop|= 1ULL<<(ec&63);
+      if(w==(c>>6) && (c&63)!=63) stop&= (1ULL<<((c&63)+1))-1;
+      if(stop){
+        int p=w*64+63-__builtin_clzll(stop);
+        return G->blocked(r,p)? -1 : p;
+      }
+    }
+    return -1;
+  }
+
+  // Salto vertical desde (r,c) en dirección dr; id del punto de salto o -1.
+  int jumpVertical(int r,int c,int dr) const {
+    for(;;r+=dr){
+      if(!G->freeCell(r,c)) return -1;
+      if(r==er && c==ec) return G->id(r,c);
+      if((G->freeCell(r,c-1) && !G->freeCell(r-dr,c-1)) ||
+         (G->freeCell(r,c+1) && !G->freeCell(r-dr,c+1))) return G->id(r,c);
+      // Al moverse en vertical hay que mirar los saltos horizontales
+      if(jumpRight(r,c+1)!=-1 || jumpLeft(r,c-1)!=-1) return G->id(r,c);
+    }
+  }
+
+  int jump(int r,int c,int dr,int dc) const {
+    if(dr) return jumpVertical(r+dr,c,dr);
+    int p= dc>0 ? jumpRight(r,c+1) : jumpLeft(r,c-1);
+    return p==-1? -1 : G->id(r,p);
+  }
+
+  void solve(const GridMap& g,int sr,int sc,int er_,int ec_,SearchOutput& out){
+    if(!g.freeCell(sr,sc) || !g.freeCell(er_,ec_)) return;
+    G=&g; er=er_; ec=ec_;
+    int s=g.id(sr,sc), t=g.id(er,ec);
+    if(s==t){ out.visit(s); out.path.push_back(s); return; }
+
+    const int INF=INT_MAX;
+    reset(g.R*g.C);
+    priority_queue<Node, vector<Node>, Cmp> open;
+
+    gCost[s]=0; touched.push_back(s); open.push({s,0,H(sr,sc,er,ec)});
+
+    while(!open.empty()){
+      auto cur=open.top(); open.pop();
+      int u=cur.id;
+      if(closed[u]) continue;
+      closed[u]=1;
+      out.visit(u);
+      if(u==t) break;
+
+      int r=u/g.C, c=u%g.C;
+      if(par[u]==-1){
+        // inicio: las 4 direcciones
+        relax(u,r,c,-1,0,open); relax(u,r,c,1,0,open);
+        relax(u,r,c,0,-1,open); relax(u,r,c,0,1,open);
+        continue;
+      }
+      // Poda según la dirección de llegada: seguir recto y abrir los dos laterales
+      int pr=par[u]/g.C, pc=par[u]%g.C;
+      int dr=sgn(r-pr), dc=sgn(c-pc);
+      if(dc){ relax(u,r,c,-1,0,open); relax(u,r,c,1,0,open); relax(u,r,c,0,dc,open); }
+      else  { relax(u,r,c,0,-1,open); relax(u,r,c,0,1,open); relax(u,r,c,dr,0,open); }
+    }
+
+    if(gCost[t]!=INF) buildJumpPath(s,t,out);
+    collectParents(touched,par,out);
+  }
+
+  template<class PQ>
+  void relax(int u,int r,int c,int dr,int dc,PQ& open){
+    int v=jump(r,c,dr,dc);
+    if(v==-1 || closed[v]) return;
+    int vr=v/G->C, vc=v%G->C;
+    int ng=gCost[u]+abs(vr-r)+abs(vc-c);
+    if(ng<gCost[v]){
+      if(gCost[v]==INT_MAX) touched.push_back(v);
+      gCost[v]=ng;
+      par[v]=u;
+      open.push({v,ng, ng + H(vr,vc,er,ec)});
+    }
+  }
+
+  // Camino entre puntos de salto, rellenando los tramos rectos
+  void buildJumpPath(int s,int t,SearchOutput& out){
+    SearchOutput jp;
+    buildPath(s,t,par,jp);
+    if(jp.path.empty()) return;
+    out.path.push_back(jp.path[0]);
+    for(size_t i=1;i<jp.path.size();i++){
+      int a=jp.path[i-1], b=jp.path[i];
+      int ar=a/G->C, ac=a%G->C, br=b/G->C, bc=b%G->C;
+      int dr=sgn(br-ar), dc=sgn(bc-ac);
+      while(ar!=br || ac!=bc){ ar+=dr; ac+=dc; out.path.push_back(G->id(ar,ac)); }
+    }
+  }
+};
+
+int main(int argc, char** argv){
+  JPSSolver solver;
+  return engineMain(argc, argv, solver);
+}
@@ -45,6 +45,10 @@ build "dijkstra" "$SRC_DIR/dijkstra.cpp"
 build "astar" "$SRC_DIR/astar.cpp"
 build "d_star_lite" "$SRC_DIR/dstar_lite.cpp"
 build "bmssp" "$SRC_DIR/bmssp.cpp"
+build "jps" "$SRC_DIR/jps.cpp"
+build "hpa" "$SRC_DIR/hpa.cpp"
+build "bidijkstra" "$SRC_DIR/bidijkstra.cpp"
+build "biastar" "$SRC_DIR/biastar.cpp"
 
 echo
 echo "[done] Binarios listos en: $OUT_DIR"
@@ -0,0 +1,179 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "bitgrid.hpp"
+
+/*
+  Protocolo binario opcional entre el backend Node y los motores.
+  El protocolo de texto sigue siendo el de por defecto; cada mensaje decide
+  su formato, así que un mismo proceso puede recibir ambos.
+
+  Un mensaje binario empieza con el byte 0xB1 (nunca inicia un comando de texto):
+
+    0xB1 | u32 len | payload[len]
+
+  payload[0] es el tipo, el resto son int32 little-endian:
+
+    'G' consulta one-shot / 'I' INIT
+        rows cols sr sc er ec + grilla empaquetada [+ verbosity en 'G']
+        (rows filas de ceil(cols/8) bytes; bit (c%8) del byte c/8 = obstáculo)
+    'U' UPDATE   n + n × (r c blocked)
+    'Q' QUERY    sr sc er ec [verbosity]
+    'M' MOVE     r c
+    'P' PLAN     [delta [verbosity]]  (delta = 1 -> respuesta 'D', D* Lite)
+    'X' EXIT
+    '#' TAG      id + mensaje completo (tipo + datos): la respuesta vuelve
+                 envuelta igual, '#' id + respuesta (D* Lite)
+
+  Respuestas (mismo encabezado 0xB1 | len):
+
+    'K' OK
+    'E' error    mensaje en texto
+    'R' result   nVisited + ids, nParents + (id, pid), nPath + ids
+    'D' delta    nVisited + ids, nParents cambiados + (id, pid),
+                 from + nHead + ids  (ruta = head + ruta anterior[from..])
+
+  Los ids de celda son r*cols + c.
+
+  verbosity (opcional, ver Verbosity) elige qué se calcula y se envía; las
+  secciones no pedidas van vacías (nVisited / nParents = 0) y el coste de la
+  ruta es nPath - 1 (coste unitario).
+*/
+
+static const int WIRE_MAGIC = 0xB1;
+
+// Nivel de detalle de una respuesta. Solo se registra y serializa lo pedido:
+//   path     solo la ruta
+//   cost     ruta + "Cost: n" (en texto)
+//   visited  ruta + coste + celdas expandidas
+//   full     Visited/Parents/Path, el formato de siempre (por defecto)
+enum Verbosity : int32_t { VERB_PATH = 0, VERB_COST = 1, VERB_VISITED = 2, VERB_FULL = 3 };
+
+// "path" | "cost" | "visited" | "full" (o 0..3); false si no es un nivel
+inline bool parseVerbosity(const std::string& s, int& v) {
+    static const char* names[] = {"path", "cost", "visited", "full"};
+    for (int i = 0; i < 4; i++)
+        if (s == names[i] || s == std::to_string(i)) { v = i; return true; }
+    return false;
+}
+
+struct WireReader {
+    const std::string& buf;
+    size_t pos = 1; // salta el byte de tipo
+    bool good = true;
+
+    explicit WireReader(const std::string& b) : buf(b) {}
+
+    char type() const { return buf.empty() ? 0 : buf[0]; }
+
+    int32_t i32() {
+        int32_t v = 0;
+        if (pos + 4 > buf.size()) { good = false; return 0; }
+        std::memcpy(&v, buf.data() + pos, 4);
+        pos += 4;
+        return v;
+    }
+
+    const unsigned char* bytes(size_t n) {
+        if (pos + n > buf.size()) { good = false; return nullptr; }
+        const unsigned char* p = (const unsigned char*)buf.data() + pos;
+        pos += n;
+        return p;
+    }
+};
+
+// Nivel de detalle opcional al final de un frame (dflt si no viene)
+inline int wireVerbosity(WireReader& rd, int dflt) {
+    int32_t v = rd.i32();
+    return rd.good && v >= VERB_PATH && v <= VERB_FULL ? v : dflt;
+}
+
+struct WireWriter {
+    std::string buf;
+
+    explicit WireWriter(char type) { buf.push_back(type); }
+
+    void i32(int32_t v) {
+        char b[4];
+        std::memcpy(b, &v, 4);
+        buf.append(b, 4);
+    }
+
+    void ids(const std::vector<int>& v) {
+        i32((int32_t)v.size());
+        size_t off = buf.size();
+        buf.resize(off + 4 * v.size());
+        if (!v.empty()) std::memcpy(&buf[off], v.data(), 4 * v.size());
+    }
+
+    void send(std::ostream& os) const;
+};
+
+// Id de la petición que se está respondiendo ('#'); -1 = sin etiqueta
+inline int32_t& wireReplyTag() { static int32_t tag = -1; return tag; }
+
+// Mientras vive, las respuestas salen etiquetadas con 'tag'
+struct WireTagScope {
+    explicit WireTagScope(int32_t tag) { wireReplyTag() = tag; }
+    ~WireTagScope() { wireReplyTag() = -1; }
+};
+
+inline void WireWriter::send(std::ostream& os) const {
+    const int32_t tag = wireReplyTag();
+    uint32_t len = (uint32_t)buf.size() + (tag >= 0 ? 5 : 0);
+    char hdr[10];
+    hdr[0] = (char)WIRE_MAGIC;
+    std::memcpy(hdr + 1, &len, 4);
+    size_t n = 5;
+    if (tag >= 0) { hdr[5] = '#'; std::memcpy(hdr + 6, &tag, 4); n = 10; }
+    os.write(hdr, n);
+    os.write(buf.data(), buf.size());
+    os.flush();
+}
+
+// Si el payload es '#' id + mensaje, deja solo el mensaje y devuelve el id (-1 si no)
+inline int32_t untagFrame(std::string& payload) {
+    if (payload.size() < 5 || payload[0] != '#') return -1;
+    int32_t tag = 0;
+    std::memcpy(&tag, payload.data() + 1, 4);
+    payload.erase(0, 5);
+    return tag;
+}
+
+// Salta espacios y devuelve el siguiente byte sin consumirlo (EOF si no hay más)
+inline int wirePeek(std::istream& in) {
+    std::streambuf* sb = in.rdbuf();
+    int ch = sb->sgetc();
+    while (ch != EOF && (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')) {
+        sb->sbumpc();
+        ch = sb->sgetc();
+    }
+    return ch;
+}
+
+// Lee un mensaje binario completo (incluido el byte 0xB1) en 'payload'
+inline bool readFrame(std::istream& in, std::string& payload) {
+    std::streambuf* sb = in.rdbuf();
+    if (sb->sbumpc() != WIRE_MAGIC) return false;
+    uint32_t len = 0;
+    if (sb->sgetn((char*)&len, 4) != 4) return false;
+    payload.resize(len);
+    return len == 0 || sb->sgetn(&payload[0], len) == (std::streamsize)len;
+}
+
+// Carga R filas de ceil(C/8) bytes en la grilla de bits
+inline bool unpackGrid(WireReader& rd, int R, int C, BitGrid& grid) {
+    if (R <= 0 || C <= 0) return false;
+    size_t rowBytes = (size_t)(C + 7) / 8;
+    const unsigned char* p = rd.bytes(rowBytes * R);
+    if (!p) return false;
+    grid.loadPacked(R, C, p);
+    return true;
+}
+
+inline void sendAck(std::ostream& os) { WireWriter('K').send(os); }
+
+inline void sendError(std::ostream& os, const std::string& msg) {
+    WireWriter w('E');
+    w.buf += msg;
+    w.send(os);
+}
@@ -0,0 +1,293 @@
+import { spawn } from "child_process";
+import { createHash } from "crypto";
+import { PacketReader, VERBOSITY, encodeFrame, intFrame, isPartial, packGridLines, parseGridFrame, rowBytesOf } from "./wire.js";
+
+/**
+ * Pool de procesos persistentes para los motores one-shot (dijkstra, astar, bmssp).
+ *
+ * Cada proceso se lanza con `--server` y habla el protocolo INIT/UPDATE/QUERY
+ * (ver engines/engine_io.hpp). El pool recuerda qué mapa tiene cargado cada
+ * proceso para no reenviar la grilla si la consulta usa el mismo mapa; si el
+ * mapa cambió en pocas celdas se envían UPDATE en lugar de un INIT completo.
+ *
+ * La carga del mapa siempre viaja en binario (grilla empaquetada); la consulta
+ * se responde en el mismo formato en que llegó la petición HTTP.
+ */
+
+/**
+ * Proceso persistente: una respuesta (texto con END o frame binario) por comando.
+ *
+ * Sin etiquetas las respuestas se emparejan por orden (FIFO). Con
+ * { tagged: true } cada orden lleva un id ("@id ..." en texto, frame '#' id
+ * en binario) que el motor devuelve: request() puede tener varias órdenes en
+ * vuelo y cada respuesta va a quien la pidió, aunque otra haya expirado.
+ */
+export class EngineProcess {
+  constructor(exePath, args, name, { tagged = false } = {}) {
+    this.name = name;
+    this.queue = [];
+    this.tagged = tagged;
+    this.pending = new Map(); // id -> { resolve, reject } (modo etiquetado)
+    this.nextId = 1;
+    this.mapKey = null;
+    this.dims = null;
+    this.packed = null; // grilla empaquetada cargada (para diff → UPDATE)
+    this.busy = false;
+    this.dead = false;
+
+    this.child = spawn(exePath, args, { stdio: "pipe" });
+
+    const reader = new PacketReader((packet) => {
+      if (!this.tagged) {
+        // Lotes parciales (streaming) van a la orden en curso, que sigue esperando
+        if (this.queue[0]?.onPartial && isPartial(packet)) return this.queue[0].onPartial(packet);
+        const waiter = this.queue.shift();
+        if (waiter) waiter.resolve(packet);
+        return;
+      }
+      const { id, body } = untag(packet);
+      const waiter = this.pending.get(id);
+      if (!waiter) return console.warn(`[${name}] respuesta sin petición (id ${id})`);
+      this.pending.delete(id);
+      waiter.resolve(body);
+    });
+    this.child.stdout.on("data", (chunk) => reader.push(chunk));
+
+    this.child.stderr.on("data", (chunk) => {
+      console.error(`[${name} STDERR]`, chunk.toString());
+    });
+
+    const fail = (err) => {
+      this.dead = true;
+      for (const waiter of this.queue.splice(0)) waiter.reject(err);
+      for (const waiter of this.pending.values()) waiter.reject(err);
+      this.pending.clear();
+    };
+    this.child.on("error", fail);
+    this.child.on("exit", (code) => {
+      console.warn(`[${name}] exited`, code);
+      fail(new Error(`${name} exited (${code})`));
+    });
+  }
+
+  /**
+   * Escribe uno o varios comandos y espera sus respuestas. onPartial recibe
+   * los lotes parciales (QUERY ... STREAM n) de la última orden.
+   */
+  send(cmd, packets = 1, onPartial = null) {
+    if (this.dead) return Promise.reject(new Error(`${this.name} is not running`));
+    const waits = [];
+    for (let i = 0; i < packets; i++) {
+      const last = i === packets - 1;
+      waits.push(new Promise((resolve, reject) => this.queue.push({ resolve, reject, onPartial: last ? onPartial : null })));
+    }
+    this.child.stdin.write(cmd);
+    return Promise.all(waits).then((all) => all[all.length - 1]);
+  }
+
+  /**
+   * Modo etiquetado: una orden (texto o frame 0xB1) con id propio. Se
+   * escribe de inmediato, sin esperar a las anteriores.
+   */
+  request(cmd, timeoutMs = 20000) {
+    if (this.dead) return Promise.reject(new Error(`${this.name} is not running`));
+    const id = this.nextId++;
+    const tagged = Buffer.isBuffer(cmd)
+      ? encodeFrame(Buffer.concat([intFrame("#", [id]).subarray(5), cmd.subarray(5)]))
+      : `@${id} ${cmd}`;
+    return new Promise((resolve, reject) => {
+      const timer = setTimeout(() => {
+        this.pending.delete(id); // una respuesta tardía se descarta
+        reject(new Error(`${this.name} timeout (id ${id})`));
+      }, timeoutMs);
+      const done = (fn) => (v) => { clearTimeout(timer); fn(v); };
+      this.pending.set(id, { resolve: done(resolve), reject: done(reject) });
+      this.child.stdin.write(tagged);
+    });
+  }
+
+  kill() {
+    this.dead = true;
+    this.child.kill();
+  }
+}
+
+/** Separa el id de una respuesta etiquetada ("@id\n..." o '#' id + frame) */
+function untag(packet) {
+  if (Buffer.isBuffer(packet)) {
+    if (packet[0] !== 0x23 /* '#' */ || packet.length < 5) return { id: -1, body: packet };
+    return { id: packet.readInt32LE(1), body: packet.subarray(5) };
+  }
+  if (!packet.startsWith("@")) return { id: -1, body: packet };
+  const nl = packet.indexOf("\n");
+  return { id: parseInt(packet.slice(1, nl), 10), body: packet.slice(nl + 1) };
+}
+
+/**
+ * Sesiones con estado (un proceso por clave, p.ej. D* Lite por cliente).
+ * Se reutiliza el proceso de la clave; si hay 'max' sesiones se cierra la
+ * usada hace más tiempo sin órdenes en vuelo, y cada minuto se cierran las
+ * que llevan más de 'idleMs' sin uso.
+ */
+export class SessionPool {
+  constructor(create, { max = 16, idleMs = 5 * 60 * 1000 } = {}) {
+    this.create = create;
+    this.max = max;
+    this.idleMs = idleMs;
+    this.sessions = new Map(); // clave -> { proc, lastUsed }, en orden de uso
+    setInterval(() => this.evictIdle(), Math.min(idleMs, 60 * 1000)).unref();
+  }
+
+  get(key) {
+    let s = this.sessions.get(key);
+    if (s) this.sessions.delete(key); // se reinserta al final (más reciente)
+    if (!s || s.proc.dead) {
+      if (this.sessions.size >= this.max) this.evictOldest();
+      s = { proc: this.create(key) };
+    }
+    s.lastUsed = Date.now();
+    this.sessions.set(key, s);
+    return s.proc;
+  }
+
+  evictOldest() {
+    for (const [key, s] of this.sessions) {
+      if (s.proc.pending.size) continue;
+      s.proc.kill();
+      this.sessions.delete(key);
+      return;
+    }
+  }
+
+  evictIdle() {
+    const now = Date.now();
+    for (const [key, s] of this.sessions) {
+      if (s.proc.dead || (now - s.lastUsed > this.idleMs && !s.proc.pending.size)) {
+        s.proc.kill();
+        this.sessions.delete(key);
+      }
+    }
+  }
+}
+
+/** Separa "rows cols sr sc er ec" + filas de grilla */
+export function parseGridBody(body) {
+  const lines = body.trim().split(/\r?\n/);
+  const header = lines[0].trim().split(/\s+/).map(Number);
+  const gridLines = lines.slice(1).map((ln) => ln.trim()).filter(Boolean);
+  return { header, gridLines };
+}
+
+/** Body HTTP (texto o payload 'G') -> { header, packed, binary } */
+export function parseRequest(body) {
+  if (Buffer.isBuffer(body)) return { ...parseGridFrame(body), binary: true };
+  const { header, gridLines } = parseGridBody(body);
+  return { header, packed: packGridLines(gridLines, header[0], header[1]), binary: false };
+}
+
+/** Respuesta de error del motor (texto "ERR ..." o frame 'E') */
+export function isEngineError(packet) {
+  return Buffer.isBuffer(packet) ? packet[0] === 0x45 /* 'E' */ : packet.startsWith("ERR");
+}
+
+export class EnginePool {
+  constructor(exePath, name, { size = 2, timeoutMs = 20000, args = ["--server"] } = {}) {
+    this.exePath = exePath;
+    this.name = name;
+    this.size = size;
+    this.timeoutMs = timeoutMs;
+    this.args = args;
+    this.workers = [];
+    this.waiting = [];
+  }
+
+  /** Prefiere un proceso libre con el mismo mapa; si no, cualquiera libre o uno nuevo */
+  acquire(mapKey) {
+    this.workers = this.workers.filter((w) => !w.dead);
+    const idle = this.workers.filter((w) => !w.busy);
+    let worker = idle.find((w) => w.mapKey === mapKey) || idle[0];
+    if (!worker && this.workers.length < this.size) {
+      worker = new EngineProcess(this.exePath, this.args, this.name);
+      this.workers.push(worker);
+    }
+    if (worker) {
+      worker.busy = true;
+      return Promise.resolve(worker);
+    }
+    return new Promise((resolve) => this.waiting.push({ mapKey, resolve }));
+  }
+
+  release(worker) {
+    worker.busy = false;
+    const next = this.waiting.shift();
+    if (next) this.acquire(next.mapKey).then(next.resolve);
+  }
+
+  /** Carga el mapa en el proceso ('I' completo o 'U' con las celdas que cambiaron) */
+  async load(worker, rows, cols, packed, mapKey) {
+    if (worker.mapKey === mapKey) return;
+
+    if (worker.dims === `${rows}x${cols}` && worker.packed) {
+      const rb = rowBytesOf(cols);
+      const limit = Math.max(16, (rows * cols) >> 6);
+      const changes = [];
+      for (let i = 0; i < packed.length && changes.length <= limit * 3; i++) {
+        const diff = packed[i] ^ worker.packed[i];
+        if (!diff) continue;
+        const r = Math.floor(i / rb);
+        for (let b = 0; b < 8; b++) {
+          if (!(diff & (1 << b))) continue;
+          const c = (i % rb) * 8 + b;
+          changes.push(r, c, (packed[i] >> b) & 1);
+        }
+      }
+      if (changes.length <= limit * 3) {
+        if (changes.length) await worker.send(intFrame("U", [changes.length / 3, ...changes]));
+        worker.mapKey = mapKey;
+        worker.packed = Buffer.from(packed);
+        return;
+      }
+    }
+
+    const ok = await worker.send(intFrame("I", [rows, cols, 0, 0, 0, 0], packed));
+    if (isEngineError(ok)) throw new Error(`${this.name} INIT failed`);
+    worker.mapKey = mapKey;
+    worker.dims = `${rows}x${cols}`;
+    worker.packed = Buffer.from(packed);
+  }
+
+  /**
+   * Resuelve una consulta. body: texto (mismo formato que one-shot) o payload 'G'.
+   * Devuelve texto Visited/Parents/Path o el payload binario 'R'.
+   * verbosity: path | cost | visited | full (qué calcula y envía el motor)
+   * stream: { every, onPartial, binary } para recibir las celdas expandidas
+   * por lotes durante la búsqueda; binary fuerza el formato de la consulta.
+   */
+  async query(body, verbosity = "full", stream = null) {
+    const req = parseRequest(body);
+    const { header, packed } = req;
+    const binary = stream?.binary ?? req.binary;
+    const every = stream?.every || 0;
+    const [rows, cols, sr, sc, er, ec] = header;
+    const mapKey = `${rows}x${cols}:` + createHash("sha1").update(packed).digest("hex");
+
+    const worker = await this.acquire(mapKey);
+    const timer = setTimeout(() => {
+      console.error(`[${this.name}] timeout, restarting process`);
+      worker.kill();
+    }, this.timeoutMs);
+    try {
+      await this.load(worker, rows, cols, packed, mapKey);
+      const cmd = binary
+        ? intFrame("Q", [sr, sc, er, ec, VERBOSITY[verbosity], every])
+        : `QUERY ${sr} ${sc} ${er} ${ec} ${verbosity}${every ? ` STREAM ${every}` : ""}\n`;
+      return await worker.send(cmd, 1, stream?.onPartial ?? null);
+    } catch (e) {
+      worker.kill();
+      throw e;
+    } finally {
+      clearTimeout(timer);
+      this.release(worker);
+    }
+  }
+}
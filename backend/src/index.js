@@ -3,10 +3,16 @@ import cors from "cors";
 import bodyParser from "body-parser";
 import { exec, spawn } from "child_process";
 import * as process from "process";
+import { EnginePool, EngineProcess, SessionPool, isEngineError, parseGridBody, parseRequest } from "./enginePool.js";
+import {
+  OCTET, VERBOSITY, PacketReader, decodeResultFrame, encodeFrame, intFrame, isPartial, parseGridFrame,
+} from "./wire.js";
 
 const app = express();
 app.use(cors());
-app.use(bodyParser.text({ type: "*/*" }));
+// Binario opt-in (application/octet-stream, ver wire.js); todo lo demás como texto
+app.use(bodyParser.raw({ type: OCTET, limit: "256mb" }));
+app.use(bodyParser.text({ type: "*/*", limit: "256mb" }));
 
 const PORT = process.env.PORT || 4000;
 const isWindows = process.platform === "win32";
@@ -15,93 +21,173 @@ const binBase = isWindows ? "engines/bin" : "./engines/bin";
 
 const getExecutablePath = (baseName) => `${binBase}/${baseName}${exeExtension}`;
 
-const runExec = (exePath, inputData, res, algoName) => {
-  const cmd = isWindows ? `"${exePath}"` : exePath;
-  const child = exec(cmd, (error, stdout) => {
+/** Envía la respuesta del motor en el mismo formato que la petición */
+const sendPacket = (res, packet) => {
+  if (isEngineError(packet)) res.status(500).send(String(packet.subarray?.(1) ?? packet));
+  else if (Buffer.isBuffer(packet)) res.type(OCTET).send(packet);
+  else res.type("text/plain").send(packet);
+};
+
+/**
+ * Nivel de detalle pedido con ?verbosity=path|cost|visited|full (por defecto
+ * full, lo que dibuja el visualizador); null si no es válido. Con path/cost
+ * los motores ni registran las celdas expandidas ni los parents.
+ */
+const verbosityOf = (req) => {
+  const v = req.query.verbosity ?? "full";
+  return Object.hasOwn(VERBOSITY, v) ? v : null;
+};
+
+/** Respuesta para un ?verbosity= desconocido (motores y D* Lite) */
+const badVerbosity = (res) => res.status(400).send("verbosity: path | cost | visited | full");
+
+const runExec = (exePath, inputData, res, algoName, verbosity = "full") => {
+  const cmd = `${isWindows ? `"${exePath}"` : exePath} --verbosity=${verbosity}`;
+  const binary = Buffer.isBuffer(inputData);
+  const child = exec(cmd, { encoding: "buffer", maxBuffer: 1 << 30 }, (error, stdout) => {
     if (error) {
       console.error(`Error executing ${algoName}:`, error);
       return res.status(500).send(`Failed to execute ${algoName} algorithm`);
     }
-    res.send(stdout);
+    // one-shot binario: quitar 0xB1 | len
+    sendPacket(res, binary ? stdout.subarray(5) : stdout.toString());
   });
-  child.stdin.write(inputData + "\n");
+  child.stdin.write(binary ? encodeFrame(inputData) : inputData + "\n");
   child.stdin.end();
 };
 
-// === Dijkstra / A* / BMSSP  ===
-app.post("/api/dijkstra", (req, res) => runExec(getExecutablePath("dijkstra"), req.body.trim(), res, "Dijkstra"));
-app.post("/api/astar", (req, res) => runExec(getExecutablePath("astar"), req.body.trim(), res, "A*"));
-app.post("/api/bmssp", (req, res) => runExec(getExecutablePath("bmssp"), req.body.trim(), res, "BMSSP"));
+// === Dijkstra / A* / BMSSP / JPS / HPA* / bidireccionales ===
+// Por defecto se usan procesos persistentes (--server) con el mapa cargado;
+// ENGINE_MODE=oneshot vuelve a lanzar un proceso por petición.
+const engineMode = process.env.ENGINE_MODE || "server";
+const poolSize = parseInt(process.env.ENGINE_POOL_SIZE || "2", 10);
+const pools = {};
 
-// === D* Lite persistente ===
-let dstarChild = null;
-let dstarBuffer = "";
-let dstarQueue = [];
-
-/** Inicia el proceso persistente si no existe */
-function ensureDStar() {
-  if (dstarChild && !dstarChild.killed) return;
-
-  const exePath = getExecutablePath("d_star_lite");
-  dstarChild = spawn(exePath, [], { stdio: "pipe" });
-
-  dstarChild.stdout.on("data", (chunk) => {
-    dstarBuffer += chunk.toString();
-    // Respuestas terminan con "END\n"
-    let idx;
-    while ((idx = dstarBuffer.indexOf("\nEND\n")) !== -1) {
-      const packet = dstarBuffer.slice(0, idx); // sin END
-      dstarBuffer = dstarBuffer.slice(idx + 5);
-      const resolver = dstarQueue.shift();
-      if (resolver) resolver(packet);
-    }
+/** One-shot con streaming: 'G' al motor, lotes 'V' a onPartial, resuelve con el 'R' final */
+const spawnStream = (exePath, body, verbosity, every, onPartial) =>
+  new Promise((resolve, reject) => {
+    const { header, packed } = parseRequest(body);
+    const child = spawn(exePath, [`--verbosity=${verbosity}`, `--stream=${every}`], { stdio: "pipe" });
+    const reader = new PacketReader((packet) => (isPartial(packet) ? onPartial(packet) : resolve(packet)));
+    child.stdout.on("data", (chunk) => reader.push(chunk));
+    child.on("error", reject);
+    // 'close' llega después del último 'data' de stdout ('exit' puede
+    // adelantarse y rechazar con el 'R' final sin leer); sin efecto si ya resolvió
+    child.on("close", (code) => reject(new Error(`exited (${code})`)));
+    child.stdin.end(intFrame("G", header, packed));
   });
 
-  dstarChild.stderr.on("data", (chunk) => {
-    console.error("[D*Lite STDERR]", chunk.toString());
-  });
+/**
+ * Server-Sent Events (?stream=1[&batch=N], N = celdas por lote, 4096 por
+ * defecto): el motor envía las celdas expandidas mientras busca y se reenvían
+ * en cuanto llegan, así el visualizador pinta de a poco en vez de esperar
+ * una única respuesta de varios MB.
+ *   event: visited   data: [id, ...]
+ *   event: result    data: { visited, parents, path }  (visited = lo que faltaba)
+ *   event: error     data: "mensaje"
+ * Los ids son r*cols + c.
+ */
+const streamEngine = async (baseName, algoName, body, verbosity, req, res) => {
+  const every = Math.max(1, parseInt(req.query.batch || "4096", 10) || 4096);
+  res.writeHead(200, { "Content-Type": "text/event-stream", "Cache-Control": "no-cache", Connection: "keep-alive" });
+  const event = (name, data) => {
+    if (!res.destroyed) res.write(`event: ${name}\ndata: ${JSON.stringify(data)}\n\n`);
+  };
+  const onPartial = (frame) => event("visited", decodeResultFrame(frame).visited);
+  try {
+    const exePath = getExecutablePath(baseName);
+    let frame;
+    if (engineMode === "oneshot") {
+      frame = await spawnStream(exePath, body, verbosity, every, onPartial);
+    } else {
+      pools[baseName] ??= new EnginePool(exePath, algoName, { size: poolSize });
+      frame = await pools[baseName].query(body, verbosity, { every, onPartial, binary: true });
+    }
+    if (isEngineError(frame)) event("error", frame.subarray(1).toString());
+    else event("result", decodeResultFrame(frame));
+  } catch (e) {
+    console.error(`Error streaming ${algoName}:`, e);
+    event("error", `Failed to execute ${algoName} algorithm`);
+  }
+  res.end();
+};
 
-  dstarChild.on("exit", (code) => {
-    console.warn("[D*Lite] exited", code);
-    dstarChild = null;
-  });
-}
-
-/** Envía comandos y espera una respuesta (terminada en END) */
-function sendDStar(cmdText) {
-  ensureDStar();
-  return new Promise((resolve, reject) => {
-    dstarQueue.push(resolve);
-    dstarChild.stdin.write(cmdText);
-    // opcional: timeout
-    setTimeout(() => {
-      if (dstarQueue.includes(resolve)) {
-        reject(new Error("D*Lite timeout"));
-      }
-    }, 20000);
-  });
-}
-
-/** Utilidades para traducir tu body a INIT + grid */
-function parseGridBody(body) {
-  // body = mismo formato que ya usas: header + filas de grid
-  // header: rows cols sr sc er ec
-  const lines = body.trim().split(/\r?\n/);
-  const header = lines[0].trim();
-  const gridLines = lines.slice(1).filter(Boolean);
-  return { header, gridLines };
-}
+const runEngine = (baseName, algoName) => async (req, res) => {
+  const exePath = getExecutablePath(baseName);
+  const body = Buffer.isBuffer(req.body) ? req.body : req.body.trim();
+  const verbosity = verbosityOf(req);
+  if (!verbosity) return badVerbosity(res);
+  if (req.query.stream === "1") return streamEngine(baseName, algoName, body, verbosity, req, res);
+  if (engineMode === "oneshot") return runExec(exePath, body, res, algoName, verbosity);
+  try {
+    pools[baseName] ??= new EnginePool(exePath, algoName, { size: poolSize });
+    sendPacket(res, await pools[baseName].query(body, verbosity));
+  } catch (e) {
+    console.error(`Error executing ${algoName}:`, e);
+    res.status(500).send(`Failed to execute ${algoName} algorithm`);
+  }
+};
+
+app.post("/api/dijkstra", runEngine("dijkstra", "Dijkstra"));
+app.post("/api/astar", runEngine("astar", "A*"));
+app.post("/api/bmssp", runEngine("bmssp", "BMSSP"));
+app.post("/api/jps", runEngine("jps", "JPS"));
+// HPA* precalcula el grafo de clusters en INIT; el pool le envía UPDATE con
+// las celdas cambiadas y solo se reconstruyen los clusters afectados. Su
+// camino es aproximado (no siempre el más corto, ver engines/hpa.cpp).
+app.post("/api/hpa", runEngine("hpa", "HPA*"));
+app.post("/api/bidijkstra", runEngine("bidijkstra", "Bidirectional Dijkstra"));
+app.post("/api/biastar", runEngine("biastar", "Bidirectional A*"));
+
+// === D* Lite persistente ===
+// Una sesión (proceso con su mapa, g/rhs y agente) por cliente: la clave es la
+// cabecera X-Session-Id (una por pestaña, ver frontend/src/lib/pathApi.ts) o,
+// si falta, la IP. Las órdenes llevan id y se encadenan sin esperar la
+// respuesta anterior (UPDATE_BATCH + PLAN van juntas al motor).
+const dstarSessions = new SessionPool(
+  () => new EngineProcess(getExecutablePath("d_star_lite"), [], "D*Lite", { tagged: true }),
+  {
+    max: parseInt(process.env.DSTAR_MAX_SESSIONS || "16", 10),
+    idleMs: parseInt(process.env.DSTAR_IDLE_MS || String(5 * 60 * 1000), 10),
+  }
+);
+
+const dstarSession = (req) => dstarSessions.get(req.get("X-Session-Id") || req.ip);
+
+/** Middleware de las rutas D* Lite: rechaza ?verbosity= inválido antes de
+ * tocar la sesión, con el mismo 400 que los motores */
+const checkVerbosity = (req, res, next) => (verbosityOf(req) ? next() : badVerbosity(res));
+
+/** PLAN completo o, con ?delta=1, solo lo cambiado desde el PLAN anterior
+ * de la sesión (parents sucios + cabeza de la ruta, ver dstar_lite.cpp);
+ * ?verbosity= igual que en los motores one-shot */
+const planCmd = (req, binary, allowDelta = true) => {
+  const delta = allowDelta && req.query.delta === "1";
+  const verbosity = verbosityOf(req); // validado por checkVerbosity
+  if (binary) return intFrame("P", [delta ? 1 : 0, VERBOSITY[verbosity]]);
+  return `PLAN${delta ? " DELTA" : ""} ${verbosity}\n`;
+};
 
 /** INIT + PLAN  */
-app.post("/api/dstar/init", async (req, res) => {
+app.post("/api/dstar/init", checkVerbosity, async (req, res) => {
   try {
+    const dsl = dstarSession(req);
+    if (Buffer.isBuffer(req.body)) {
+      // payload 'G' del cliente -> 'I' para el motor
+      const { header, packed } = parseGridFrame(req.body);
+      const [ok, plan] = await Promise.all([
+        dsl.request(intFrame("I", header, packed)),
+        dsl.request(planCmd(req, true, false)),
+      ]);
+      if (isEngineError(ok)) console.warn("[D*Lite INIT] error frame");
+      return sendPacket(res, plan);
+    }
+
     const { header, gridLines } = parseGridBody(req.body);
-    let cmd = `INIT ${header.split(/\s+/).slice(0).join(" ")}\n`;
+    let cmd = `INIT ${header.join(" ")}\n`;
     for (const ln of gridLines) cmd += ln + "\n";
-    const ok = await sendDStar(cmd);
+    const [ok, plan] = await Promise.all([dsl.request(cmd), dsl.request(planCmd(req, false, false))]);
     if (!ok.startsWith("OK")) console.warn("[D*Lite INIT] resp:", ok);
-
-    const plan = await sendDStar("PLAN\n");
     res.type("text/plain").send(plan);
   } catch (e) {
     console.error(e);
@@ -109,25 +195,36 @@ app.post("/api/dstar/init", async (req, res) => {
   }
 });
 
-/** UPDATE (batch) + PLAN
+/** UPDATE_BATCH + PLAN
  * Body esperado (texto):
  *  r c val
  *  r c val
  *  ...
  * Donde val = 1000000000 para obstáculo, 1 para libre
+ * (binario: payload 'U' con n + n × (r c blocked))
  */
-app.post("/api/dstar/update", async (req, res) => {
+app.post("/api/dstar/update", checkVerbosity, async (req, res) => {
   try {
+    const dsl = dstarSession(req);
+    if (Buffer.isBuffer(req.body)) {
+      const [, plan] = await Promise.all([
+        dsl.request(encodeFrame(req.body)),
+        dsl.request(planCmd(req, true)),
+      ]);
+      return sendPacket(res, plan);
+    }
+
     const lines = req.body.trim().split(/\r?\n/).filter(Boolean);
-    let cmd = "";
+    // Un solo UPDATE_BATCH: el motor aplica todo y responde un OK/END
+    let cmd = `UPDATE_BATCH ${lines.length}\n`;
     for (const ln of lines) {
       const [r, c, val] = ln.trim().split(/\s+/);
-      cmd += `UPDATE ${r} ${c} ${val}\n`;
+      cmd += `${r} ${c} ${val}\n`;
     }
-    if (cmd === "") cmd = "UPDATE 0 0 1\n"; // no-op para no romper protocolo
-    const ok = await sendDStar(cmd);
-    // Podrían haber varios OK/END concatenados; no hace falta inspeccionarlos
-    const plan = await sendDStar("PLAN\n");
+    // En orden: primero el lote, después PLAN (ambas en vuelo a la vez)
+    const sent = lines.length ? [dsl.request(cmd)] : [];
+    sent.push(dsl.request(planCmd(req, false)));
+    const plan = (await Promise.all(sent)).pop();
     res.type("text/plain").send(plan);
   } catch (e) {
     console.error(e);
@@ -136,13 +233,21 @@ app.post("/api/dstar/update", async (req, res) => {
 });
 
 /** MOVE + PLAN
- * Body esperado: "r c" (texto)
+ * Body esperado: "r c" (texto) o payload 'M' (binario)
  */
-app.post("/api/dstar/move", async (req, res) => {
+app.post("/api/dstar/move", checkVerbosity, async (req, res) => {
   try {
+    const dsl = dstarSession(req);
+    if (Buffer.isBuffer(req.body)) {
+      const [, plan] = await Promise.all([
+        dsl.request(encodeFrame(req.body)),
+        dsl.request(planCmd(req, true)),
+      ]);
+      return sendPacket(res, plan);
+    }
+
     const [r, c] = req.body.trim().split(/\s+/);
-    const ok = await sendDStar(`MOVE ${r} ${c}\n`);
-    const plan = await sendDStar("PLAN\n");
+    const [, plan] = await Promise.all([dsl.request(`MOVE ${r} ${c}\n`), dsl.request(planCmd(req, false))]);
     res.type("text/plain").send(plan);
   } catch (e) {
     console.error(e);
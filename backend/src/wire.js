@@ -0,0 +1,138 @@
+/**
+ * Protocolo binario opcional con los motores (ver engines/wire.hpp).
+ *
+ *   0xB1 | u32 len | payload[len]      payload[0] = tipo, resto int32 LE
+ *
+ * Por HTTP el cliente envía/recibe solo el payload (Content-Type:
+ * application/octet-stream); el backend añade/quita el encabezado.
+ */
+
+export const WIRE_MAGIC = 0xb1;
+export const OCTET = "application/octet-stream";
+
+/** Envuelve un payload con 0xB1 | len */
+export function encodeFrame(payload) {
+  const hdr = Buffer.alloc(5);
+  hdr[0] = WIRE_MAGIC;
+  hdr.writeUInt32LE(payload.length, 1);
+  return Buffer.concat([hdr, payload]);
+}
+
+/** Payload = tipo + enteros (+ bytes extra, p.ej. grilla empaquetada) */
+export function intFrame(type, ints, tail = null) {
+  const body = Buffer.alloc(1 + 4 * ints.length);
+  body.write(type, 0, "latin1");
+  ints.forEach((v, i) => body.writeInt32LE(v, 1 + 4 * i));
+  return encodeFrame(tail ? Buffer.concat([body, tail]) : body);
+}
+
+/** Niveles de detalle de las respuestas (Verbosity en engines/wire.hpp) */
+export const VERBOSITY = { path: 0, cost: 1, visited: 2, full: 3 };
+
+export const rowBytesOf = (cols) => (cols + 7) >> 3;
+
+/** Filas de texto "0 1 0 ..." -> grilla empaquetada (bit c%8 del byte c/8) */
+export function packGridLines(gridLines, rows, cols) {
+  const rb = rowBytesOf(cols);
+  const out = Buffer.alloc(rows * rb);
+  for (let r = 0; r < rows; r++) {
+    const ln = gridLines[r] || "";
+    let c = 0;
+    for (let i = 0; i < ln.length && c < cols; i++) {
+      const ch = ln.charCodeAt(i);
+      if (ch === 32 || ch === 9) continue;
+      if (ch !== 48) out[r * rb + (c >> 3)] |= 1 << (c & 7);
+      // saltar el resto del token
+      while (i + 1 < ln.length && ln.charCodeAt(i + 1) !== 32 && ln.charCodeAt(i + 1) !== 9) i++;
+      c++;
+    }
+  }
+  return out;
+}
+
+/** Payload 'G' del cliente -> { header: [rows, cols, sr, sc, er, ec], packed } */
+export function parseGridFrame(buf) {
+  if (buf.length < 25 || String.fromCharCode(buf[0]) !== "G") throw new Error("bad grid frame");
+  const header = [];
+  for (let i = 0; i < 6; i++) header.push(buf.readInt32LE(1 + 4 * i));
+  const [rows, cols] = header;
+  const packed = buf.subarray(25, 25 + rows * rowBytesOf(cols));
+  if (packed.length !== rows * rowBytesOf(cols)) throw new Error("truncated grid frame");
+  return { header, packed };
+}
+
+/** Lote parcial de celdas expandidas (streaming): frame 'V' o texto "Visited+:" */
+export function isPartial(packet) {
+  return Buffer.isBuffer(packet) ? packet[0] === 0x56 /* 'V' */ : packet.startsWith("Visited+:");
+}
+
+/**
+ * Frame del motor -> objeto: 'V' -> { visited }, 'R' -> { visited, parents, path }
+ * (ids r*cols+c; parents como pares [id, pid])
+ */
+export function decodeResultFrame(buf) {
+  let off = 1;
+  const next = () => { const v = buf.readInt32LE(off); off += 4; return v; };
+  const ids = () => Array.from({ length: next() }, next);
+  const visited = ids();
+  if (buf[0] !== 0x52 /* 'R' */) return { visited };
+  const parents = Array.from({ length: next() }, () => [next(), next()]);
+  return { visited, parents, path: ids() };
+}
+
+/**
+ * Acumula el stdout de un motor y entrega respuestas completas:
+ *   binarias: 0xB1 | len | payload  -> Buffer (payload)
+ *   texto:    ... "\nEND\n"         -> string (sin END)
+ * Usa un buffer que crece por duplicación para no recopiar todo en cada chunk.
+ */
+export class PacketReader {
+  constructor(onPacket) {
+    this.onPacket = onPacket;
+    this.buf = Buffer.alloc(1 << 16);
+    this.start = 0;
+    this.end = 0;
+    this.scanFrom = 0; // bytes de texto ya revisados sin encontrar END
+  }
+
+  push(chunk) {
+    if (this.end + chunk.length > this.buf.length) {
+      const live = this.end - this.start;
+      let cap = this.buf.length;
+      while (cap < live + chunk.length) cap *= 2;
+      const next = cap === this.buf.length ? this.buf : Buffer.alloc(cap);
+      this.buf.copy(next, 0, this.start, this.end);
+      this.buf = next;
+      this.start = 0;
+      this.end = live;
+    }
+    chunk.copy(this.buf, this.end);
+    this.end += chunk.length;
+    this.drain();
+  }
+
+  drain() {
+    while (this.end > this.start) {
+      const view = this.buf.subarray(this.start, this.end);
+      if (view[0] === WIRE_MAGIC) {
+        if (view.length < 5) return;
+        const len = view.readUInt32LE(1);
+        if (view.length < 5 + len) return;
+        const packet = Buffer.from(view.subarray(5, 5 + len));
+        this.start += 5 + len;
+        this.onPacket(packet);
+      } else {
+        const idx = view.indexOf("\nEND\n", this.scanFrom);
+        if (idx === -1) {
+          this.scanFrom = Math.max(0, view.length - 4);
+          return;
+        }
+        const packet = view.subarray(0, idx + 1).toString();
+        this.start += idx + 5;
+        this.scanFrom = 0;
+        this.onPacket(packet);
+      }
+    }
+    this.start = this.end = 0;
+  }
+}
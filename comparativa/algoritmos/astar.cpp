@@ -1,79 +1,131 @@
 #include "utils.hpp"
+#include "bucket_queue.hpp"
+#include "workspace.hpp"
+#include "graphs.hpp"
 #include <queue>
 #include <limits>
 #include <cmath>
 
 /*
   A*:
-  - Grafo CSR (utils.hpp)
+  - Grafo CSR (utils.hpp) o cualquiera de graphs.hpp (CompactCSR, ImplicitGrid)
   - f(u) = g(u) + h(u), donde:
       g(u): costo acumulado desde s
       h(u): heurística estimada de u a t
-  - Min-heap por f(u)
-  - "Closed set" implícito con vector<bool>/char para no reexpandir un nodo ya fijado
+  - Cola por f(u) elegida por pick_queue (bucket_queue.hpp): Dial/radix con
+    pesos enteros y heurística entera (Manhattan o 0), min-heap si no
+  - "Closed set" (StampSet del workspace) para no reexpandir un nodo ya fijado
+  - gscore/fscore/parent/closed viven en un SearchWorkspace reutilizable
+    (workspace.hpp): sin reservar ni llenar O(N) por consulta
 
   Notas:
-    - Si g.has_coords=false, heuristic_grid(...) devuelve 0 => A* == Dijkstra
-    - Con grid 4-dir usa Manhattan; con 8-dir, octile (definidos en utils.cpp)
+    - Si g.has_coords=false, la heurística es 0 => A* == Dijkstra
+    - Con grid 4-dir usa Manhattan; con 8-dir, octile. Se elige una vez por
+      consulta (with_heuristic, graphs.hpp) y la búsqueda se instancia para
+      cada una: sin preguntar por has_coords/diag8 en cada expansión
     - Requiere pesos no negativos.
+    - Dial necesita f monótona: con coords exige pesos >= 1 (Manhattan
+      consistente); así f(v) - f(u) <= w + 1 <= 2*wmax.
 */
 
-bool astar_run(const CSR& g, int s, int t, std::vector<int>& parent){
-    const float INF = std::numeric_limits<float>::infinity();
-    parent.assign(g.N, -1);
-
-    // Casos borde
-    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
-    if(s == t){ parent[t] = -1; return true; } // ruta trivial
+namespace {
+template<class K, class G, class H, class Queue>
+bool astar_search(const G& g, int s, int t, SearchWorkspace& ws, Queue& open, H heur){
+    const K INF = key_inf<K>();
 
     // gscore: costo exacto desde s
     // fscore: estimación total f = g + h
-    std::vector<float> gscore(g.N, INF), fscore(g.N, INF);
+    auto& gscore = ws.keys<K>().a;
+    auto& fscore = ws.keys<K>().b;
+    auto& parent = ws.parent;
+    gscore.reset(g.N, INF);
+    fscore.reset(g.N, INF);
 
-    // Heurística (0 si no hay coords)
-    auto h = [&](int u){ return heuristic_grid(g, u, t); };
+    // Heurística (política H, sin ramas por nodo); entera cuando K es entero
+    auto h = [&](int u){ return (K)heur(g, u, t); };
 
-    using P = std::pair<float,int>; // (fscore, nodo)
-    std::priority_queue<P, std::vector<P>, std::greater<P>> open;
+    StampSet& closed = ws.closed; // nodos ya fijados
+    closed.reset(g.N);
 
-    std::vector<char> closed(g.N, 0); // 0: no cerrado, 1: cerrado
-
-    gscore[s] = 0.0f;
-    fscore[s] = h(s);
-    open.push({fscore[s], s});
+    gscore.set(s, 0);
+    fscore.set(s, h(s));
+    open.push(s, fscore.get(s));
 
     while(!open.empty()){
-        auto [fu, u] = open.top(); open.pop();
+        K fu;
+        int u = open.pop(fu);
 
         // Si este nodo ya fue cerrado, ignora (lazy)
-        if(closed[u]) continue;
+        if(closed.has(u)) continue;
 
         // Si la clave f extraída no coincide (por obsolescencia), no pasa nada.
-        if(fu != fscore[u]) continue;
+        if(fu != fscore.get(u)) continue;
 
         // Meta alcanzada: como h >= 0 y consistente, esto es óptimo.
         if(u == t) break;
 
-        closed[u] = 1;
+        closed.insert(u);
+        ++ws.expanded;
 
         // Expandir
-        for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e){
-            int   v   = g.col_ind[e];
-            float wuv = g.w[e];
-            if(wuv < 0.0f) continue; // A* requiere pesos no negativos
-
-            if(closed[v]) continue;
-
-            float tentative = gscore[u] + wuv;
-            if(tentative < gscore[v]){
-                gscore[v] = tentative;
-                parent[v] = u;
-                fscore[v] = tentative + h(v);
-                open.push({fscore[v], v});
+        const K gu = gscore.get(u);
+        g.for_each_out(u, [&](int v, float w){
+            if(w < 0.0f) return; // A* requiere pesos no negativos
+
+            if(closed.has(v)) return;
+            ++ws.relaxed;
+
+            K tentative = gu + (K)w;
+            if(tentative < gscore.get(v)){
+                gscore.set(v, tentative);
+                parent.set(v, u);
+                fscore.set(v, tentative + h(v));
+                open.push(v, fscore.get(v));
             }
-        }
+        });
     }
 
-    // Return true si la distancia a t es finita
-    return std::isfinite(gscore[t]);
+    // true si la distancia a t es finita
+    return gscore.get(t) != INF;
+}
+} // namespace
+
+template<class G>
+bool astar_run(const G& g, int s, int t, SearchWorkspace& ws){
+    ws.begin(g.N);
+
+    // Casos borde
+    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
+    if(s == t) return true; // ruta trivial
+
+    // Con coords la heurística tiene que ser entera (4-dir) y consistente
+    QueueKind kind = pick_queue(g);
+    if(g.has_coords && (g.diag8 || g.wmin_int < 1)) kind = QueueKind::Binary;
+
+    return with_heuristic(g, [&](auto heur){
+        switch(kind){
+        case QueueKind::Dial:
+            ws.dial.reset(g.N, 2u * (uint32_t)g.wmax_int);
+            return astar_search<uint32_t>(g, s, t, ws, ws.dial, heur);
+        case QueueKind::Radix:
+            ws.radix.reset();
+            return astar_search<uint32_t>(g, s, t, ws, ws.radix, heur);
+        default:
+            ws.heap.clear();
+            return astar_search<float>(g, s, t, ws, ws.heap, heur);
+        }
+    });
+}
+
+template bool astar_run(const CSR&, int, int, SearchWorkspace&);
+template bool astar_run(const CompactCSR<float>&, int, int, SearchWorkspace&);
+template bool astar_run(const CompactCSR<uint16_t>&, int, int, SearchWorkspace&);
+template bool astar_run(const CompactCSR<uint8_t>&, int, int, SearchWorkspace&);
+template bool astar_run(const ImplicitGrid&, int, int, SearchWorkspace&);
+
+bool astar_run(const CSR& g, int s, int t, std::vector<int>& parent){
+    SearchWorkspace& ws = thread_workspace();
+    bool ok = astar_run(g, s, t, ws);
+    ws.export_tree(parent);
+    return ok;
 }
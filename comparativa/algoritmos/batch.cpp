@@ -0,0 +1,106 @@
+#include "utils.hpp"
+#include "workspace.hpp"
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+/*
+  Consultas en lote (--mode=batch):
+  - Un pool de 'threads' hilos comparte el CSR (solo lectura) y reparte las
+    consultas con un contador atómico (cada hilo toma la siguiente libre)
+  - Cada hilo tiene su propio SearchWorkspace (dist, parent, colas con reset
+    O(1), workspace.hpp) y su 'parent' de salida, reutilizados entre consultas
+  - Se mide la latencia de cada consulta por separado y el tiempo de pared
+    del lote completo (throughput = consultas / pared)
+
+  Archivo de consultas: un par "s t" por línea (también "s,t"); las líneas
+  vacías o que empiezan con '#' se ignoran.
+*/
+
+std::vector<Query> load_queries(const std::string& path){
+    std::ifstream f(path);
+    if(!f) throw std::runtime_error("No se puede abrir para leer: " + path);
+
+    std::vector<Query> qs;
+    std::string line;
+    long long ln = 0;
+    while(std::getline(f, line)){
+        ++ln;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream in(line);
+        Query q;
+        std::string first;
+        if(!(in >> first) || first[0] == '#') continue;
+        try { q.s = std::stoi(first); } catch(...) { q.s = -1; }
+        if(q.s < 0 || !(in >> q.t) || q.t < 0)
+            throw std::runtime_error("Consulta inválida en " + path + ":" + std::to_string(ln));
+        qs.push_back(q);
+    }
+    return qs;
+}
+
+std::vector<Query> gen_queries(int N, int count, unsigned seed){
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> U(0, std::max(0, N-1));
+    std::vector<Query> qs(std::max(0, count));
+    for(auto& q : qs){ q.s = U(rng); q.t = U(rng); }
+    return qs;
+}
+
+void save_queries(const std::vector<Query>& qs, const std::string& path){
+    std::ofstream f(path);
+    if(!f) throw std::runtime_error("No se puede abrir para escribir: " + path);
+    for(const auto& q : qs) f << q.s << ' ' << q.t << '\n';
+}
+
+double percentile(const std::vector<double>& sorted, double p){
+    if(sorted.empty()) return 0.0;
+    size_t k = (size_t)std::ceil(p * (double)sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(k, 1)) - 1];
+}
+
+BatchResult run_batch(int N, const std::vector<Query>& qs, int threads, const QueryFn& fn){
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min<int>(threads, (int)std::max<size_t>(qs.size(), 1)));
+
+    std::vector<double> lat(qs.size(), 0.0);
+    std::vector<char> found(qs.size(), 0);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]{
+        SearchWorkspace ws;         // scratch propio del hilo
+        std::vector<int> parent(N, -1);
+        for(;;){
+            size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if(i >= qs.size()) break;
+            Timer T; T.start();
+            found[i] = fn(qs[i].s, qs[i].t, ws, parent);
+            lat[i] = T.ms();
+        }
+    };
+
+    Timer W; W.start();
+    std::vector<std::thread> pool;
+    for(int k = 1; k < threads; ++k) pool.emplace_back(worker);
+    worker();
+    for(auto& th : pool) th.join();
+
+    BatchResult r;
+    r.threads = threads;
+    r.queries = (long long)qs.size();
+    r.wall_ms = W.ms();
+    r.qps = r.wall_ms > 0 ? 1000.0 * (double)qs.size() / r.wall_ms : 0.0;
+    for(char f : found) r.ok += f;
+
+    std::sort(lat.begin(), lat.end());
+    r.p50 = percentile(lat, 0.50);
+    r.p95 = percentile(lat, 0.95);
+    r.p99 = percentile(lat, 0.99);
+    r.max_ms = lat.empty() ? 0.0 : lat.back();
+    return r;
+}
@@ -0,0 +1,157 @@
+#include "utils.hpp"
+#include "bucket_queue.hpp"
+#include <limits>
+#include <algorithm>
+
+/*
+  Dijkstra y A* bidireccionales:
+  - Búsqueda hacia adelante desde s sobre el CSR y hacia atrás desde t sobre
+    el grafo inverso (ReverseCSR, build_reverse en utils), alternando lados
+  - mu = mejor df(v) + db(v) visto; se revisa cada vez que un lado mejora un
+    nodo que el otro ya alcanzó
+  - A*: potencial promedio (balanceado) p(v) = (h_t(v) - h_s(v)) / 2 hacia
+    adelante y -p(v) hacia atrás. Los costes reducidos de ambos lados son el
+    mismo grafo l(u,v) + p(v) - p(u) >= 0 si h es consistente, así que la
+    parada de Dijkstra bidireccional sigue valiendo. Con h = 0 es Dijkstra.
+
+  Claves (enteras si los pesos lo son):
+    kf(v) = 2*df(v) + h_t(v) - h_s(v) + H     kb(v) = 2*db(v) + h_s(v) - h_t(v) + H
+  con H = h(s,t), así ambas son >= 0 (desigualdad triangular) y
+  kf(v) + kb(v) = 2*(df(v) + db(v)) + 2H. Se para cuando
+    última kf extraída + última kb extraída >= 2*mu + 2H
+  (las colas son monótonas, la última extraída acota a las que quedan).
+
+  Salida: igual que dijkstra_run; parent[] tiene el árbol hacia adelante y,
+  para el tramo del camino que encontró el lado de atrás, el predecesor en
+  el camino.
+
+  Cola: pick_queue (bucket_queue.hpp), con las mismas restricciones que
+  astar_run para la heurística (entera y consistente para Dial/radix).
+*/
+
+namespace {
+template<class K>
+struct BidirState {
+    std::vector<K>    df, db;
+    std::vector<int>  succ;          // siguiente nodo hacia t (lado de atrás)
+    std::vector<char> doneF, doneB;
+};
+
+template<class K, class Queue, class HT, class HS>
+bool bidir_search(const CSR& g, const ReverseCSR& rg, int s, int t, std::vector<int>& parent,
+                  Queue& qf, Queue& qb, HT hT, HS hS){
+    const K INF = key_inf<K>();
+    const K H = hS(t);
+
+    BidirState<K> st;
+    st.df.assign(g.N, INF); st.db.assign(g.N, INF);
+    st.succ.assign(g.N, -1);
+    st.doneF.assign(g.N, 0); st.doneB.assign(g.N, 0);
+
+    auto keyF = [&](int v){ return 2*st.df[v] + hT(v) - hS(v) + H; };
+    auto keyB = [&](int v){ return 2*st.db[v] + hS(v) - hT(v) + H; };
+
+    K mu = INF;
+    int meet = -1;
+    auto touch = [&](int v){
+        if(st.df[v] != INF && st.db[v] != INF && st.df[v] + st.db[v] < mu){
+            mu = st.df[v] + st.db[v];
+            meet = v;
+        }
+    };
+
+    st.df[s] = 0; qf.push(s, keyF(s));
+    st.db[t] = 0; qb.push(t, keyB(t));
+    K lastF = 0, lastB = 0;
+    bool forward = true;
+
+    while(!qf.empty() && !qb.empty()){
+        if(forward){
+            K k;
+            int u = qf.pop(k);
+            if(st.doneF[u]) continue;       // entrada obsoleta (heap/radix)
+            lastF = k;
+            if(mu != INF && lastF + lastB >= 2*mu + 2*H) break;
+            st.doneF[u] = 1;
+            for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e){
+                int v = g.col_ind[e];
+                if(g.w[e] < 0.0f || st.doneF[v]) continue;
+                K nd = st.df[u] + (K)g.w[e];
+                if(nd < st.df[v]){
+                    st.df[v] = nd;
+                    parent[v] = u;
+                    qf.push(v, keyF(v));
+                    touch(v);
+                }
+            }
+        } else {
+            K k;
+            int u = qb.pop(k);
+            if(st.doneB[u]) continue;
+            lastB = k;
+            if(mu != INF && lastF + lastB >= 2*mu + 2*H) break;
+            st.doneB[u] = 1;
+            for(long long e = rg.row_ptr[u]; e < rg.row_ptr[u+1]; ++e){
+                int v = rg.col_ind[e];
+                if(rg.w[e] < 0.0f || st.doneB[v]) continue;
+                K nd = st.db[u] + (K)rg.w[e];
+                if(nd < st.db[v]){
+                    st.db[v] = nd;
+                    st.succ[v] = u;
+                    qb.push(v, keyB(v));
+                    touch(v);
+                }
+            }
+        }
+        forward = !forward;
+    }
+    if(meet == -1) return false;
+
+    // Tramo meet -> t: el lado de atrás guarda sucesores
+    for(int x = meet; x != t; x = st.succ[x]) parent[st.succ[x]] = x;
+    return true;
+}
+
+// Elige la cola y el tipo de clave; 'heur' decide si hay potenciales
+bool bidir_run(const CSR& g, const ReverseCSR& rg, int s, int t, std::vector<int>& parent, bool heur){
+    parent.assign(g.N, -1);
+
+    // Casos borde
+    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
+    if(s == t){ parent[t] = -1; return true; } // ruta trivial
+
+    QueueKind kind = pick_queue(g);
+    if(heur && g.has_coords && (g.diag8 || g.wmin_int < 1)) kind = QueueKind::Binary;
+
+    auto hT = [&](int v){ return heur ? heuristic_grid(g, v, t) : 0.0f; };
+    auto hS = [&](int v){ return heur ? heuristic_grid(g, v, s) : 0.0f; };
+    auto hTi = [&](int v){ return (uint32_t)hT(v); };
+    auto hSi = [&](int v){ return (uint32_t)hS(v); };
+
+    switch(kind){
+    case QueueKind::Dial: {
+        // thread_local: reutiliza los arreglos por nodo entre consultas
+        thread_local DialQueue qf, qb;
+        uint32_t step = 4u * (uint32_t)g.wmax_int; // 2w + salto del potencial (<= 2w)
+        qf.reset(g.N, step); qb.reset(g.N, step);
+        return bidir_search<uint32_t>(g, rg, s, t, parent, qf, qb, hTi, hSi);
+    }
+    case QueueKind::Radix: {
+        RadixHeap qf, qb;
+        return bidir_search<uint32_t>(g, rg, s, t, parent, qf, qb, hTi, hSi);
+    }
+    default: {
+        BinaryHeapQueue<float> qf, qb;
+        return bidir_search<float>(g, rg, s, t, parent, qf, qb, hT, hS);
+    }
+    }
+}
+} // namespace
+
+bool bidijkstra_run(const CSR& g, const ReverseCSR& rg, int s, int t, std::vector<int>& parent){
+    return bidir_run(g, rg, s, t, parent, false);
+}
+
+bool biastar_run(const CSR& g, const ReverseCSR& rg, int s, int t, std::vector<int>& parent){
+    return bidir_run(g, rg, s, t, parent, true);
+}
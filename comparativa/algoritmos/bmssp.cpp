@@ -1,5 +1,7 @@
 
 #include "utils.hpp"
+#include "workspace.hpp"
+#include "graphs.hpp"
 #include <vector>
 #include <queue>
 #include <unordered_set>
@@ -85,47 +87,58 @@ struct BucketQueue {
     }
 };
 
+// db y parent viven en el SearchWorkspace (workspace.hpp): reset O(1)
+using DistArray = StampedArray<float>;
+
 // =================== median-of-three pivot ===================
-static int medianOfThreePivot(const NodeSet& S, const std::vector<float>& db){
+static int medianOfThreePivot(const NodeSet& S, const DistArray& db){
     auto nodes = S.to_vec();
     if(nodes.empty()) return -1;
     if(nodes.size() <= 3) return nodes[nodes.size()/2];
 
     std::vector<int> tmp = nodes;
     std::nth_element(tmp.begin(), tmp.begin(), tmp.end(),
-        [&](int a,int b){ return db[a] < db[b]; });
+        [&](int a,int b){ return db.get(a) < db.get(b); });
     std::nth_element(tmp.begin(), tmp.begin()+tmp.size()/2, tmp.end(),
-        [&](int a,int b){ return db[a] < db[b]; });
+        [&](int a,int b){ return db.get(a) < db.get(b); });
     std::nth_element(tmp.begin(), tmp.end()-1, tmp.end(),
-        [&](int a,int b){ return db[a] < db[b]; });
+        [&](int a,int b){ return db.get(a) < db.get(b); });
 
     int first = tmp.front();
     int middle= tmp[tmp.size()/2];
     int last  = tmp.back();
 
     int cand[3] = {first, middle, last};
-    std::sort(cand, cand+3, [&](int a,int b){ return db[a] < db[b]; });
+    std::sort(cand, cand+3, [&](int a,int b){ return db.get(a) < db.get(b); });
     return cand[1];
 }
 
 // =================== bounded SSSP core ===================
 // Si todas las aristas pesan 1 y B finita -> Dial buckets (O(m+B))
 // Si no, fallback a Δ-stepping sencillo
+// G: CSR o cualquiera de graphs.hpp (se recorre con g.for_each_out)
+// Deja en ws.touched los nodos de S y los que mejoró (una vez cada uno):
+// la recursión particiona solo esos, no los N del grafo.
+template<class G>
 static void dijkstraDeltaSteppingBounded(
-    const CSR& g,
+    const G& g,
     const NodeSet& S,
     float B,
     float delta,
-    std::vector<float>& db,
-    std::vector<int>& parent
+    SearchWorkspace& ws
 ){
-    // Detecta si todas las aristas pesan 1
-    bool all_weights_one = true;
-    for (int u = 0; u < g.N && all_weights_one; ++u) {
-        for (long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e) {
-            if (std::fabs(g.w[e] - 1.0f) > 1e-9f) { all_weights_one = false; break; }
-        }
-    }
+    DistArray& db = ws.kf.a;
+    StampedArray<int>& parent = ws.parent;
+
+    std::vector<int>& touched = ws.touched;
+    StampSet& seen = ws.inOpen;
+    touched.clear();
+    seen.reset(g.N);
+    auto touch = [&](int v){ if(!seen.has(v)){ seen.insert(v); touched.push_back(v); } };
+    for (int v : S.s) touch(v);
+
+    // Todas las aristas pesan 1 (classify_weights, sin recorrer el grafo)
+    bool all_weights_one = (g.wmin_int == 1 && g.wmax_int == 1);
 
     if (all_weights_one && std::isfinite(B)) {
         // -------- Dial / Radix buckets: O(m + B) --------
@@ -135,10 +148,11 @@ static void dijkstraDeltaSteppingBounded(
         if (maxD < 1) maxD = 1;
 
         std::vector<std::vector<int>> buckets(maxD+1);
-        std::vector<char> closed(g.N, 0);
+        StampSet& closed = ws.closed;
+        closed.reset(g.N);
 
         auto push = [&](int v) {
-            float dv = db[v];
+            float dv = db.get(v);
             if (!(dv + 1e-6f < B)) return;           // dv < B con tolerancia
             int idx = (int)std::floor(dv + 1e-6f);   // index tolerante
             if (idx < 0) idx = 0;
@@ -146,30 +160,34 @@ static void dijkstraDeltaSteppingBounded(
             buckets[idx].push_back(v);
         };
 
-        for (int v : S.s) if (db[v] + 1e-6f < B) push(v);
+        for (int v : S.s) if (db.get(v) + 1e-6f < B) push(v);
 
         for (int i = 0; i <= maxD; ++i) {
             auto &Q = buckets[i];
             while (!Q.empty()) {
                 int u = Q.back(); Q.pop_back();
-                if (closed[u]) continue;
-                if (!(db[u] + 1e-6f < B)) continue;
+                if (closed.has(u)) continue;
+                float du = db.get(u);
+                if (!(du + 1e-6f < B)) continue;
                 // tolerante: el bucket correcto para db[u]
-                int iu = (int)std::floor(db[u] + 1e-6f);
+                int iu = (int)std::floor(du + 1e-6f);
                 if (iu != i) continue; // obsoleto
-                closed[u] = 1;
-
-                for (long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e) {
-                    int v = g.col_ind[e];
-                    float nd = db[u] + 1.0f; // peso 1 exacto
-                    if (!(nd + 1e-6f < B)) continue;
-                    if (improves(nd, db[v])) {
-                        db[v] = nd; parent[v] = u;
+                closed.insert(u);
+                ++ws.expanded;
+
+                const float nd = du + 1.0f; // peso 1 exacto
+                if (!(nd + 1e-6f < B)) continue;
+                g.for_each_out(u, [&](int v, float) {
+                    ++ws.relaxed;
+                    float dv = db.get(v);
+                    if (improves(nd, dv)) {
+                        db.set(v, nd); parent.set(v, u);
+                        touch(v);
                         push(v);
-                    } else if (ties(nd, db[v]) && parent[v] == -1) {
+                    } else if (ties(nd, dv) && parent.get(v) == -1) {
                         parent[v] = u; // cosido en empate
                     }
-                }
+                });
             }
         }
         return;
@@ -177,130 +195,160 @@ static void dijkstraDeltaSteppingBounded(
 
     // -------- fallback: Δ-stepping general --------
     BucketQueue pq(delta);
-    std::vector<char> vis(g.N, 0);
-    for (int v : S.s) if (db[v] + 1e-6f < B) pq.insert(v, db[v]);
+    StampSet& vis = ws.closed;
+    vis.reset(g.N);
+    for (int v : S.s) if (db.get(v) + 1e-6f < B) pq.insert(v, db.get(v));
 
     int u;
     while (pq.extractMin(u)) {
-        if (vis[u]) continue;
-        float du = db[u];
+        if (vis.has(u)) continue;
+        float du = db.get(u);
         if (!(du + 1e-6f < B)) continue;
-        vis[u] = 1;
-
-        for (long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e) {
-            int v = g.col_ind[e];
-            float nd = du + g.w[e];
-            if (!(nd + 1e-6f < B)) continue;
-            if (improves(nd, db[v])) {
-                db[v] = nd; parent[v] = u;
+        vis.insert(u);
+        ++ws.expanded;
+
+        g.for_each_out(u, [&](int v, float w) {
+            float nd = du + w;
+            if (!(nd + 1e-6f < B)) return;
+            ++ws.relaxed;
+            float dv = db.get(v);
+            if (improves(nd, dv)) {
+                db.set(v, nd); parent.set(v, u);
+                touch(v);
                 pq.decreaseKey(v, nd);
-            } else if (ties(nd, db[v]) && parent[v] == -1) {
+            } else if (ties(nd, dv) && parent.get(v) == -1) {
                 parent[v] = u;
             }
-        }
+        });
     }
 }
 
 // =================== partición y recursión principal ===================
+template<class G>
 static void BMSSP_recursive(
-    const CSR& g,
+    const G& g,
     float B,
     NodeSet S,
-    std::vector<float>& db,
-    std::vector<int>& parent,
-    float delta
+    SearchWorkspace& ws,
+    float delta,
+    int level = 0
 ){
     if(S.size() == 0) return;
+    const DistArray& db = ws.kf.a;
 
     // Caso base pragmático
     if(S.size() == 1 || B <= 1.0f + 1e-9f){
-        dijkstraDeltaSteppingBounded(g, S, B, delta, db, parent);
+        dijkstraDeltaSteppingBounded(g, S, B, delta, ws);
         return;
     }
 
     // Pivot y bound = min(B, db[pivot])
     int pivot = medianOfThreePivot(S, db);
     float bound = B;
-    if(pivot != -1) bound = std::min(B, db[pivot]);
+    if(pivot != -1) bound = std::min(B, db.get(pivot));
 
     // Si bound ≈ B, bounded directo
     if(std::fabs(bound - B) <= 1e-9f){
-        dijkstraDeltaSteppingBounded(g, S, B, delta, db, parent);
+        dijkstraDeltaSteppingBounded(g, S, B, delta, ws);
         return;
     }
 
     // Bounded hasta "bound"
-    dijkstraDeltaSteppingBounded(g, S, bound, delta, db, parent);
+    dijkstraDeltaSteppingBounded(g, S, bound, delta, ws);
 
-    // Partición en left (<= bound) y right (bound, B)
+    // Partición en left (<= bound) y right (bound, B) de lo que tocó la
+    // búsqueda acotada: O(tocados), no O(N) por llamada
+    std::vector<long long>& perLevel = ws.levelTouched;
+    if((int)perLevel.size() <= level) perLevel.resize(level + 1, 0);
+    perLevel[level] += (long long)ws.touched.size();
     NodeSet left, right;
-    for(int u=0; u<g.N; ++u){
-        if(!std::isfinite(db[u])) continue;
-        if(db[u] <= bound + 1e-6f) left.add(u);
-        else if(db[u] + 1e-6f < B) right.add(u);
+    for(int u : ws.touched){
+        float du = db.get(u);
+        if(!std::isfinite(du)) continue;
+        if(du <= bound + 1e-6f) left.add(u);
+        else if(du + 1e-6f < B) right.add(u);
     }
 
-    // Recursión si particiones útiles
+    // Recursión si particiones útiles (ws.touched se reutiliza adentro)
     if(left.size() > 0 && left.size() < S.size())
-        BMSSP_recursive(g, bound, left, db, parent, delta);
+        BMSSP_recursive(g, bound, left, ws, delta, level + 1);
 
     if(right.size() > 0 && right.size() < S.size())
-        BMSSP_recursive(g, B, right, db, parent, delta);
+        BMSSP_recursive(g, B, right, ws, delta, level + 1);
 }
 
 // =================== reconstrucción de seguridad (igualdades) ===================
+template<class G>
 static bool reconstruct_bfs_equalities(
-    const CSR& g, int s, int t,
-    const std::vector<float>& db,
-    std::vector<int>& parent
+    const G& g, int s, int t,
+    SearchWorkspace& ws
 ){
-    if(!std::isfinite(db[t])) return false;
-    std::vector<char> vis(g.N, 0);
+    const DistArray& db = ws.kf.a;
+    StampedArray<int>& parent = ws.parent;
+    if(!std::isfinite(db.get(t))) return false;
+    StampSet& vis = ws.closed;
+    vis.reset(g.N);
     std::queue<int> q;
-    parent.assign(g.N, -1);
-    vis[s]=1; q.push(s);
+    parent.reset(g.N, -1);
+    vis.insert(s); q.push(s);
     while(!q.empty()){
         int u=q.front(); q.pop();
         if(u==t) break;
-        for(long long e=g.row_ptr[u]; e<g.row_ptr[u+1]; ++e){
-            int v=g.col_ind[e];
-            if(vis[v]) continue;
-            if(!std::isfinite(db[v])) continue;
-            if(ties(db[v], db[u] + g.w[e])){
-                vis[v]=1; parent[v]=u; q.push(v);
+        g.for_each_out(u, [&](int v, float w){
+            if(vis.has(v)) return;
+            if(!std::isfinite(db.get(v))) return;
+            if(ties(db.get(v), db.get(u) + w)){
+                vis.insert(v); parent[v]=u; q.push(v);
             }
-        }
+        });
     }
-    return parent[t] != -1;
+    return parent.get(t) != -1;
 }
 
 // =================== API pública ===================
-bool bmssp_run(const CSR& g, int s, int t, float B, std::vector<int>& parent){
-    parent.assign(g.N, -1);
+template<class G>
+bool bmssp_run(const G& g, int s, int t, float B, SearchWorkspace& ws){
+    ws.begin(g.N);
     if(s<0||s>=g.N||t<0||t>=g.N) return false;
 
-    std::vector<float> db(g.N, INF_F);
-    db[s] = 0.0f;
+    DistArray& db = ws.kf.a;
+    StampedArray<int>& parent = ws.parent;
+    db.reset(g.N, INF_F);
+    db.set(s, 0.0f);
 
     if(!(B > 0.0f) || std::isinf(B)) B = INF_F;
 
     float delta = 1.0f; // grids unitarios
 
     NodeSet S; S.add(s);
-    BMSSP_recursive(g, B, S, db, parent, delta);
+    BMSSP_recursive(g, B, S, ws, delta);
 
     // Validación permisiva (tolera igualdad por flotantes)
-    if(!std::isfinite(db[t]) || (db[t] > B + 1e-6f)) return false;
+    float dt = db.get(t);
+    if(!std::isfinite(dt) || (dt > B + 1e-6f)) return false;
 
     // Si ya hay cadena, valida llegada a s
-    if(parent[t] != -1){
+    if(parent.get(t) != -1){
         int v=t, guard=0;
-        while(v!=-1 && v!=s){ v=parent[v]; if(++guard>g.N){ parent[t]=-1; break; } }
+        while(v!=-1 && v!=s){ v=parent.get(v); if(++guard>g.N){ parent[t]=-1; break; } }
         if(v==s) return true;
     }
 
     // Reconstrucción por igualdades si faltara coser
-    if(reconstruct_bfs_equalities(g, s, t, db, parent)) return true;
+    if(reconstruct_bfs_equalities(g, s, t, ws)) return true;
 
     return false;
 }
+
+template bool bmssp_run(const CSR&, int, int, float, SearchWorkspace&);
+template bool bmssp_run(const CompactCSR<float>&, int, int, float, SearchWorkspace&);
+template bool bmssp_run(const CompactCSR<uint16_t>&, int, int, float, SearchWorkspace&);
+template bool bmssp_run(const CompactCSR<uint8_t>&, int, int, float, SearchWorkspace&);
+template bool bmssp_run(const ImplicitGrid&, int, int, float, SearchWorkspace&);
+
+bool bmssp_run(const CSR& g, int s, int t, float B, std::vector<int>& parent){
+    SearchWorkspace& ws = thread_workspace();
+    bool ok = bmssp_run(g, s, t, B, ws);
+    ws.export_tree(parent);
+    return ok;
+}
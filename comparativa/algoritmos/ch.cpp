@@ -0,0 +1,432 @@
+#include "utils.hpp"
+#include <queue>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+/*
+  Contraction Hierarchies (grafos dirigidos, pesos no negativos)
+
+  Preproceso (ch_build):
+  - Se contraen los nodos de menor a mayor "importancia":
+        prioridad = 2*atajos_añadidos - aristas_eliminadas + vecinos_contraídos + nivel
+    con actualización perezosa: al contraer v sus vecinos solo actualizan
+    contadores; la prioridad se recalcula al sacar un nodo del heap y se
+    reinserta si ya no es el mínimo.
+  - Al contraer v, por cada par u->v->x sin contraer se busca un "testigo"
+    u ~> x que evite v con coste <= w(u,v)+w(v,x) (Dijkstra acotado a
+    WITNESS_SETTLE nodos; WITNESS_SETTLE_SIM al estimar prioridades, que es
+    lo que domina el preproceso; se corta en cuanto los destinos de v están
+    asentados). Si no aparece se añade el atajo u->x (mid = v).
+    Cortar la búsqueda antes de tiempo solo añade atajos de más, nunca rompe
+    la corrección.
+  - Si el grafo restante se vuelve denso (grado medio, entrada + salida, >
+    CORE_DEGREE; en Erdős–Rényi pasa pronto, en grids solo al final) se deja
+    de contraer: esos nodos forman un "núcleo" con los rangos más altos y sus
+    aristas internas se recorren en ambas búsquedas (core-CH).
+  - El resultado se parte en dos grafos ascendentes (CHGraph, utils.hpp).
+
+  Consulta (ch_run):
+  - Fase 1, Dijkstra bidireccional por la jerarquía: hacia adelante por 'up'
+    desde s y hacia atrás por 'dn' desde t, alternando por menor clave y
+    parando cuando la menor clave de ambos lados alcanza la mejor distancia
+    encontrada (mu). Los nodos del núcleo alcanzados no se expanden.
+  - Stall-on-demand: un nodo que se alcanza más barato bajando desde un nodo
+    de mayor rango no se expande.
+  - Fase 2, Dijkstra bidireccional normal dentro del núcleo sembrado con lo
+    alcanzado en la fase 1, parando cuando la suma de las menores claves
+    alcanza mu. Así un núcleo grande (ER) cuesta como bidijkstra y no como
+    dos Dijkstra completos.
+  - Los atajos del camino se desempaquetan recursivamente con 'mid'.
+  - Los buffers de la consulta se reutilizan entre llamadas (thread_local) y
+    solo se limpian los nodos tocados, así una consulta no cuesta O(N).
+
+  Formato binario propio (save_ch_bin / load_ch_bin):
+    "CH01" | int N | int core | long long shortcuts | rank[N]
+    | up_ptr[N+1] | long long Mup | up_to | up_w | up_mid
+    | dn_ptr[N+1] | long long Mdn | dn_from | dn_w | dn_mid
+*/
+
+namespace {
+
+const float INF = std::numeric_limits<float>::infinity();
+const int WITNESS_SETTLE = 500;    // al contraer de verdad
+const int WITNESS_SETTLE_SIM = 40; // al estimar prioridades (solo cuenta atajos)
+const double CORE_DEGREE = 20.0;   // grado medio (entrada + salida) del grafo restante que detiene la contracción
+
+struct Arc { int to; float w; int mid; };
+
+struct Contractor {
+    int N;
+    // Solo aristas entre nodos sin contraer; al contraer v sus aristas pasan a up[v]/dn[v]
+    std::vector<std::vector<Arc>> out, in;
+    std::vector<std::vector<Arc>> up, dn;
+    std::vector<char> done;
+    std::vector<int> deleted, level;
+    long long shortcuts = 0;
+    long long active = 0; // aristas entre nodos sin contraer
+
+    // Búsqueda de testigos (buffers reutilizados)
+    std::vector<float> wd;
+    std::vector<int> wtouched;
+    std::vector<std::pair<float,int>> heap;
+    std::vector<char> target;
+
+    // slot[x] = posición de x en out[u] para el u "abierto" (openRow), -1 si no está:
+    // addArc encuentra el arco existente en O(1) en vez de recorrer out[u]
+    std::vector<int> slot;
+
+    explicit Contractor(const CSR& g)
+        : N(g.N), out(g.N), in(g.N), up(g.N), dn(g.N),
+          done(g.N, 0), deleted(g.N, 0), level(g.N, 0), wd(g.N, INF), target(g.N, 0), slot(g.N, -1) {
+        for(int u = 0; u < g.N; ++u){
+            for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e){
+                int v = g.col_ind[e];
+                if(v != u && g.w[e] >= 0.0f) addArc(u, v, g.w[e], -1);
+            }
+            closeRow(u);
+        }
+    }
+
+    void openRow(int u){ for(size_t k = 0; k < out[u].size(); ++k) slot[out[u][k].to] = (int)k; }
+    void closeRow(int u){ for(const Arc& a : out[u]) slot[a.to] = -1; }
+
+    // Inserta u->x quedándose con el menor peso si ya existe (u abierto con openRow)
+    void addArc(int u, int x, float w, int mid){
+        if(slot[x] != -1){
+            Arc& a = out[u][slot[x]];
+            if(w < a.w){
+                a.w = w; a.mid = mid;
+                for(Arc& b : in[x]) if(b.to == u){ b.w = w; b.mid = mid; break; }
+            }
+            return;
+        }
+        slot[x] = (int)out[u].size();
+        out[u].push_back({x, w, mid});
+        in[x].push_back({u, w, mid});
+        ++active;
+    }
+
+    static void erase(std::vector<Arc>& adj, int to){
+        for(size_t k = 0; k < adj.size(); ++k)
+            if(adj[k].to == to){ adj[k] = adj.back(); adj.pop_back(); return; }
+    }
+
+    // Dijkstra desde u sin pasar por 'skip', hasta maxW, 'limit' nodos asentados
+    // o haber asentado los 'targets' destinos de skip (marcados en target[])
+    void witness(int u, int skip, float maxW, int limit, int targets){
+        for(int x : wtouched) wd[x] = INF;
+        wtouched.clear();
+        heap.clear();
+        auto cmp = std::greater<std::pair<float,int>>();
+        wd[u] = 0.0f; wtouched.push_back(u);
+        heap.push_back({0.0f, u});
+        int settled = 0;
+        while(!heap.empty()){
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            auto [d, x] = heap.back(); heap.pop_back();
+            if(d != wd[x]) continue;
+            if(d > maxW || ++settled > limit) break;
+            if(x != u && target[x] && --targets == 0) break; // sus wd ya son definitivos
+            for(const Arc& a : out[x]){
+                if(a.to == skip) continue;
+                float nd = d + a.w;
+                if(nd < wd[a.to] && nd <= maxW){
+                    if(wd[a.to] == INF) wtouched.push_back(a.to);
+                    wd[a.to] = nd;
+                    heap.push_back({nd, a.to});
+                    std::push_heap(heap.begin(), heap.end(), cmp);
+                }
+            }
+        }
+    }
+
+    // Cuenta (o añade si apply) los atajos necesarios al contraer v
+    int shortcutsFor(int v, bool apply){
+        int added = 0;
+        for(const Arc& oa : out[v]) target[oa.to] = 1;
+        for(const Arc& ia : in[v]){
+            int u = ia.to;
+            float maxW = -1.0f;
+            int targets = 0;
+            for(const Arc& oa : out[v]) if(oa.to != u){ maxW = std::max(maxW, ia.w + oa.w); ++targets; }
+            if(maxW < 0.0f) continue;
+            witness(u, v, maxW, apply ? WITNESS_SETTLE : WITNESS_SETTLE_SIM, targets);
+            // addArc solo toca out[u] e in[x] (u, x != v): out[v]/in[v] no cambian
+            if(apply) openRow(u);
+            for(const Arc& oa : out[v]){
+                if(oa.to == u) continue;
+                float via = ia.w + oa.w;
+                if(wd[oa.to] <= via) continue;
+                ++added;
+                if(apply){ addArc(u, oa.to, via, v); ++shortcuts; }
+            }
+            if(apply) closeRow(u);
+        }
+        for(const Arc& oa : out[v]) target[oa.to] = 0;
+        return added;
+    }
+
+    int priority(int v){
+        int removed = (int)(in[v].size() + out[v].size());
+        return 2*shortcutsFor(v, false) - removed + deleted[v] + level[v];
+    }
+
+    // Contrae v: atajos, y sus aristas salen del grafo restante hacia up/dn
+    void contract(int v){
+        shortcutsFor(v, true);
+        for(const Arc& a : out[v]){ up[v].push_back(a); erase(in[a.to], v); }
+        for(const Arc& a : in[v]){ dn[v].push_back(a); erase(out[a.to], v); }
+        active -= (long long)(out[v].size() + in[v].size());
+        std::vector<Arc>().swap(out[v]);
+        std::vector<Arc>().swap(in[v]);
+        done[v] = 1;
+    }
+};
+
+// Lista de adyacencia por nodo -> arrays CSR
+void pack(int N, const std::vector<std::vector<Arc>>& adj, std::vector<long long>& ptr,
+          std::vector<int>& to, std::vector<float>& w, std::vector<int>& mid){
+    ptr.assign(N+1, 0);
+    for(int u = 0; u < N; ++u) ptr[u+1] = ptr[u] + (long long)adj[u].size();
+    to.resize(ptr[N]); w.resize(ptr[N]); mid.resize(ptr[N]);
+    for(int u = 0; u < N; ++u){
+        long long off = ptr[u];
+        for(const Arc& a : adj[u]){ to[off] = a.to; w[off] = a.w; mid[off] = a.mid; ++off; }
+    }
+}
+
+// Workspace de consulta
+struct CHQuery {
+    std::vector<float> df, db;
+    std::vector<int> pf, pb, mf, mb; // padre en la jerarquía y 'mid' del arco usado
+    std::vector<int> touched;
+
+    void prepare(int N){
+        if((int)df.size() != N){
+            df.assign(N, INF); db.assign(N, INF);
+            pf.assign(N, -1); pb.assign(N, -1); mf.assign(N, -1); mb.assign(N, -1);
+            touched.clear();
+            return;
+        }
+        for(int x : touched){ df[x] = db[x] = INF; pf[x] = pb[x] = mf[x] = mb[x] = -1; }
+        touched.clear();
+    }
+};
+
+// 'mid' del arco a->b (a y b adyacentes en la jerarquía)
+int arc_mid(const CHGraph& ch, int a, int b){
+    if(ch.rank[b] > ch.rank[a]){
+        for(long long e = ch.up_ptr[a]; e < ch.up_ptr[a+1]; ++e) if(ch.up_to[e] == b) return ch.up_mid[e];
+    } else {
+        for(long long e = ch.dn_ptr[b]; e < ch.dn_ptr[b+1]; ++e) if(ch.dn_from[e] == a) return ch.dn_mid[e];
+    }
+    return -1;
+}
+
+// Desempaqueta a->b (mid) en aristas originales escribiendo parent[]
+void unpack(const CHGraph& ch, int a, int b, int mid, std::vector<int>& parent){
+    struct Seg { int a, b, mid; };
+    std::vector<Seg> st{{a, b, mid}};
+    while(!st.empty()){
+        Seg s = st.back(); st.pop_back();
+        if(s.mid == -1){ parent[s.b] = s.a; continue; }
+        // se procesa a->mid antes que mid->b (el orden no importa para parent[])
+        st.push_back({s.mid, s.b, arc_mid(ch, s.mid, s.b)});
+        st.push_back({s.a, s.mid, arc_mid(ch, s.a, s.mid)});
+    }
+}
+
+template<class T>
+void write_vec(std::ofstream& f, const std::vector<T>& v){
+    if(!v.empty()) f.write((const char*)v.data(), sizeof(T)*v.size());
+}
+template<class T>
+void read_vec(std::ifstream& f, std::vector<T>& v, long long n){
+    v.resize(n);
+    if(n) f.read((char*)v.data(), sizeof(T)*n);
+}
+
+} // namespace
+
+CHGraph ch_build(const CSR& g){
+    Contractor C(g);
+    const int N = g.N;
+
+    using P = std::pair<int,int>; // (prioridad, nodo)
+    std::priority_queue<P, std::vector<P>, std::greater<P>> pq;
+    std::vector<int> cur(N);
+    for(int v = 0; v < N; ++v){ cur[v] = C.priority(v); pq.push({cur[v], v}); }
+
+    CHGraph ch; ch.N = N;
+    ch.rank.assign(N, -1);
+    int order = 0;
+    std::vector<int> nbrs;
+    while(!pq.empty()){
+        auto [p, v] = pq.top(); pq.pop();
+        if(C.done[v] || p != cur[v]) continue;
+        // actualización perezosa: si empeoró y ya no es el mínimo, reinsertar
+        int np = C.priority(v);
+        if(np > p && !pq.empty() && np > pq.top().first){ cur[v] = np; pq.push({np, v}); continue; }
+
+        // Núcleo denso: contraer más solo multiplicaría los atajos
+        int remaining = N - order;
+        if(remaining > 1 && 2.0 * (double)C.active / remaining > CORE_DEGREE) break;
+
+        nbrs.clear();
+        for(const Arc& a : C.in[v])  nbrs.push_back(a.to);
+        for(const Arc& a : C.out[v]) nbrs.push_back(a.to);
+        C.contract(v);
+        ch.rank[v] = order++;
+
+        std::sort(nbrs.begin(), nbrs.end());
+        nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+        for(int x : nbrs){
+            C.deleted[x]++;
+            C.level[x] = std::max(C.level[x], C.level[v] + 1);
+        }
+    }
+
+    // Núcleo: rangos más altos, sin contraer; sus aristas internas van en up y dn
+    for(int v = 0; v < N; ++v) if(!C.done[v]){
+        ch.rank[v] = order++; ++ch.core;
+        for(const Arc& a : C.out[v]){ C.up[v].push_back(a); C.dn[a.to].push_back({v, a.w, a.mid}); }
+    }
+
+    pack(N, C.up, ch.up_ptr, ch.up_to, ch.up_w, ch.up_mid);
+    pack(N, C.dn, ch.dn_ptr, ch.dn_from, ch.dn_w, ch.dn_mid);
+    ch.shortcuts = C.shortcuts;
+    return ch;
+}
+
+void save_ch_bin(const CHGraph& ch, const std::string& path){
+    std::ofstream f(path, std::ios::binary);
+    if(!f) throw std::runtime_error("No se puede abrir para escribir: " + path);
+    f.write("CH01", 4);
+    f.write((const char*)&ch.N, sizeof(ch.N));
+    f.write((const char*)&ch.core, sizeof(ch.core));
+    f.write((const char*)&ch.shortcuts, sizeof(ch.shortcuts));
+    write_vec(f, ch.rank);
+    long long Mup = (long long)ch.up_to.size(), Mdn = (long long)ch.dn_from.size();
+    write_vec(f, ch.up_ptr); f.write((const char*)&Mup, sizeof(Mup));
+    write_vec(f, ch.up_to); write_vec(f, ch.up_w); write_vec(f, ch.up_mid);
+    write_vec(f, ch.dn_ptr); f.write((const char*)&Mdn, sizeof(Mdn));
+    write_vec(f, ch.dn_from); write_vec(f, ch.dn_w); write_vec(f, ch.dn_mid);
+}
+
+CHGraph load_ch_bin(const std::string& path){
+    std::ifstream f(path, std::ios::binary);
+    if(!f) throw std::runtime_error("No se puede abrir para leer: " + path);
+    char magic[4];
+    f.read(magic, 4);
+    if(!f || std::memcmp(magic, "CH01", 4) != 0) throw std::runtime_error("Formato CH inválido: " + path);
+
+    CHGraph ch;
+    f.read((char*)&ch.N, sizeof(ch.N));
+    f.read((char*)&ch.core, sizeof(ch.core));
+    f.read((char*)&ch.shortcuts, sizeof(ch.shortcuts));
+    read_vec(f, ch.rank, ch.N);
+    long long Mup = 0, Mdn = 0;
+    read_vec(f, ch.up_ptr, ch.N + 1LL); f.read((char*)&Mup, sizeof(Mup));
+    read_vec(f, ch.up_to, Mup); read_vec(f, ch.up_w, Mup); read_vec(f, ch.up_mid, Mup);
+    read_vec(f, ch.dn_ptr, ch.N + 1LL); f.read((char*)&Mdn, sizeof(Mdn));
+    read_vec(f, ch.dn_from, Mdn); read_vec(f, ch.dn_w, Mdn); read_vec(f, ch.dn_mid, Mdn);
+    if(!f) throw std::runtime_error("Archivo CH truncado: " + path);
+    return ch;
+}
+
+bool ch_run(const CHGraph& ch, int s, int t, std::vector<int>& parent){
+    if((int)parent.size() != ch.N) parent.assign(ch.N, -1);
+    if(s < 0 || s >= ch.N || t < 0 || t >= ch.N) return false;
+    if(s == t) return true;
+
+    thread_local CHQuery Q;
+    Q.prepare(ch.N);
+
+    using P = std::pair<float,int>;
+    std::priority_queue<P, std::vector<P>, std::greater<P>> qf, qb;
+    Q.df[s] = 0.0f; Q.db[t] = 0.0f;
+    Q.touched.push_back(s); Q.touched.push_back(t);
+    qf.push({0.0f, s}); qb.push({0.0f, t});
+
+    const int core0 = ch.N - ch.core; // rango del primer nodo del núcleo
+    float mu = INF; int meet = -1;
+
+    // Expande u en un sentido; mu se actualiza al relajar (lo exige el criterio de parada del núcleo)
+    auto expand = [&](bool fwd, int u, float d, auto& q){
+        if(fwd){
+            for(long long e = ch.up_ptr[u]; e < ch.up_ptr[u+1]; ++e){
+                int v = ch.up_to[e];
+                float nd = d + ch.up_w[e];
+                if(nd < Q.df[v]){
+                    if(Q.df[v] == INF && Q.db[v] == INF) Q.touched.push_back(v);
+                    Q.df[v] = nd; Q.pf[v] = u; Q.mf[v] = ch.up_mid[e];
+                    q.push({nd, v});
+                    if(nd + Q.db[v] < mu){ mu = nd + Q.db[v]; meet = v; }
+                }
+            }
+        } else {
+            for(long long e = ch.dn_ptr[u]; e < ch.dn_ptr[u+1]; ++e){
+                int v = ch.dn_from[e];
+                float nd = d + ch.dn_w[e];
+                if(nd < Q.db[v]){
+                    if(Q.df[v] == INF && Q.db[v] == INF) Q.touched.push_back(v);
+                    Q.db[v] = nd; Q.pb[v] = u; Q.mb[v] = ch.dn_mid[e];
+                    q.push({nd, v});
+                    if(nd + Q.df[v] < mu){ mu = nd + Q.df[v]; meet = v; }
+                }
+            }
+        }
+    };
+
+    // Fase 1: búsqueda CH por la parte contraída. Los nodos del núcleo que se
+    // alcanzan no se expanden: pasan como semillas a la fase 2 (cf / cb)
+    std::priority_queue<P, std::vector<P>, std::greater<P>> cf, cb;
+    while(!qf.empty() || !qb.empty()){
+        bool fwd = !qf.empty() && (qb.empty() || qf.top().first <= qb.top().first);
+        auto& q = fwd ? qf : qb;
+        auto [d, u] = q.top();
+        if(d >= mu) break; // la menor clave de ambos lados ya no mejora mu
+        q.pop();
+
+        std::vector<float>& dist  = fwd ? Q.df : Q.db;
+        std::vector<float>& other = fwd ? Q.db : Q.df;
+        if(d != dist[u]) continue;
+        if(other[u] != INF && d + other[u] < mu){ mu = d + other[u]; meet = u; }
+        if(ch.rank[u] >= core0){ (fwd ? cf : cb).push({d, u}); continue; }
+
+        // stall-on-demand: ¿se llega a u más barato bajando desde un nodo superior?
+        bool stalled = false;
+        if(fwd){
+            for(long long e = ch.dn_ptr[u]; e < ch.dn_ptr[u+1] && !stalled; ++e)
+                if(Q.df[ch.dn_from[e]] + ch.dn_w[e] < d) stalled = true;
+        } else {
+            for(long long e = ch.up_ptr[u]; e < ch.up_ptr[u+1] && !stalled; ++e)
+                if(Q.db[ch.up_to[e]] + ch.up_w[e] < d) stalled = true;
+        }
+        if(!stalled) expand(fwd, u, d, q);
+    }
+
+    // Fase 2: Dijkstra bidireccional dentro del núcleo desde las semillas. Ahí
+    // no hay jerarquía, así que se para con la suma de las menores claves
+    // (no con la menor de ambas, que recorrería todo el núcleo de cada lado)
+    while(!cf.empty() || !cb.empty()){
+        float tf = cf.empty() ? INF : cf.top().first;
+        float tb = cb.empty() ? INF : cb.top().first;
+        if(tf + tb >= mu) break;
+        bool fwd = tf <= tb;
+        auto& q = fwd ? cf : cb;
+        auto [d, u] = q.top(); q.pop();
+        if(d != (fwd ? Q.df[u] : Q.db[u])) continue;
+        expand(fwd, u, d, q);
+    }
+
+    if(meet == -1) return false;
+
+    // s ~> meet (hacia atrás por pf) y meet ~> t (por pb)
+    for(int v = meet; v != s; v = Q.pf[v]) unpack(ch, Q.pf[v], v, Q.mf[v], parent);
+    for(int v = meet; v != t; v = Q.pb[v]) unpack(ch, v, Q.pb[v], Q.mb[v], parent);
+    return true;
+}
@@ -0,0 +1,304 @@
+#include "utils.hpp"
+#include "workspace.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+/*
+  Δ-stepping paralelo (Meyer & Sanders) sobre el CSR:
+  - Cubetas de ancho Δ: la cubeta i tiene los nodos con dist en [iΔ, (i+1)Δ)
+  - Aristas ligeras (w <= Δ) se relajan en fases repetidas dentro de la cubeta
+    actual hasta que no entra nadie nuevo; las pesadas (w > Δ) una sola vez al
+    cerrar la cubeta, con la distancia ya final
+  - Cada hilo tiene sus propias cubetas (buffers de nodos por índice); entre
+    fases se juntan en la frontera común de la cubeta actual
+  - dist y padre van juntos en un atomic<uint64_t> (bits del float | padre):
+    relajar es un CAS de mínimo, sin locks, y el padre siempre corresponde a
+    la distancia guardada (floats >= 0 se ordenan igual que sus bits)
+  - Corte temprano: al cerrar la cubeta i, si dist(t) < (i+1)Δ ya es final
+  - Estado entre consultas (DeltaParState, en ws.deltaPar): Δ automático,
+    arreglos atómicos, cubetas y pool de hilos se crean una vez por
+    (grafo, hilos, delta). Los hilos esperan la siguiente consulta en una
+    variable de condición y al terminar solo se limpian los nodos tocados,
+    así una consulta no cuesta O(N) ni O(M)
+
+  Entrada:
+    threads : hilos (incluido el que llama); <= 0 usa hardware_concurrency
+    delta   : ancho de cubeta; <= 0 usa max(peso mínimo, peso medio / 8): en
+              ER con pesos en [1,10] fue lo más rápido medido (Δ = 1) y en
+              grids unitarios deja todas las aristas como ligeras; la cota
+              con el medio evita millones de cubetas con pesos reales chicos.
+              Se calcula con los pesos de la primera consulta sobre el grafo
+              (en --mode=dynamic no se recalcula: solo afecta la velocidad)
+  Salida: igual que dijkstra_run(..., ws) (ws.parent solo sobre el camino s->t).
+*/
+
+namespace {
+constexpr uint32_t NO_BITS = 0xFFFFFFFFu; // "todavía no relajado"
+
+inline uint32_t float_bits(float d){ uint32_t b; std::memcpy(&b, &d, 4); return b; }
+inline float bits_float(uint32_t b){ float d; std::memcpy(&d, &b, 4); return d; }
+inline uint64_t pack(float d, int p){ return (uint64_t)float_bits(d) << 32 | (uint32_t)p; }
+inline float dist_of(uint64_t x){ return bits_float((uint32_t)(x >> 32)); }
+inline int   parent_of(uint64_t x){ return (int)(uint32_t)x; }
+const uint64_t UNSEEN = pack(std::numeric_limits<float>::infinity(), -1);
+
+// Barrera reutilizable (C++17 no trae std::barrier); espera activa con yield
+class SpinBarrier {
+    std::atomic<int> waiting{0}, gen{0};
+    int n;
+public:
+    explicit SpinBarrier(int n) : n(n) {}
+    void wait(){
+        int g = gen.load(std::memory_order_acquire);
+        if(waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == n){
+            waiting.store(0, std::memory_order_relaxed);
+            gen.fetch_add(1, std::memory_order_release);
+        } else {
+            while(gen.load(std::memory_order_acquire) == g) std::this_thread::yield();
+        }
+    }
+};
+
+float default_delta(const CSR& g){
+    if(g.M == 0) return 1.0f;
+    double sum = 0;
+    float lo = std::numeric_limits<float>::infinity();
+    for(float w : g.w){ sum += w; if(w > 0.0f) lo = std::min(lo, w); }
+    float d = std::max((float)(sum / (double)g.M) / 8, std::isfinite(lo) ? lo : 0.0f);
+    return std::max(d, 1e-6f);
+}
+} // namespace
+
+struct DeltaParState {
+    const CSR& g;
+    const int* edges;  // g.col_ind.data() al crear: identifica el grafo
+    float requested;   // delta pedido (<= 0: automático)
+    float delta;       // Δ efectivo
+    int T;
+
+    std::vector<std::atomic<uint64_t>> dp;        // (dist, padre)
+    std::vector<std::atomic<uint32_t>> relaxedAt; // bits de dist con la que se relajó
+
+    struct Local {
+        std::vector<std::vector<int>> buckets;     // por índice de cubeta
+        std::vector<int> settled;                  // nodos cerrados en la cubeta actual
+        std::vector<int> touched;                  // nodos que dejaron de estar en INF
+    };
+    std::vector<Local> loc;
+
+    // Estado compartido de la fase (lo escribe el hilo 0 entre barreras)
+    std::vector<int> F;
+    std::atomic<size_t> cursor{0};
+    size_t cur = 0;
+    bool done = false;
+    int t = -1;
+
+    // Pool: los hilos 1..T-1 esperan en 'wake' a que 'job' cambie
+    SpinBarrier bar;
+    std::vector<std::thread> pool;
+    std::mutex m;
+    std::condition_variable wake;
+    unsigned long long job = 0;
+    bool quit = false;
+
+    DeltaParState(const CSR& g, float requested, int T)
+      : g(g), edges(g.col_ind.data()), requested(requested),
+        delta(requested > 0.0f ? requested : default_delta(g)), T(T),
+        dp(g.N), relaxedAt(g.N), loc(T), bar(T) {
+        for(int v = 0; v < g.N; ++v){
+            dp[v].store(UNSEEN, std::memory_order_relaxed);
+            relaxedAt[v].store(NO_BITS, std::memory_order_relaxed);
+        }
+        for(int k = 1; k < T; ++k) pool.emplace_back([this, k]{ idle(k); });
+    }
+
+    ~DeltaParState(){
+        { std::lock_guard<std::mutex> lk(m); quit = true; }
+        wake.notify_all();
+        for(auto& th : pool) th.join();
+    }
+
+    void idle(int tid){
+        unsigned long long seen = 0;
+        for(;;){
+            {
+                std::unique_lock<std::mutex> lk(m);
+                wake.wait(lk, [&]{ return quit || job != seen; });
+                if(quit) return;
+                seen = job;
+            }
+            worker(tid);
+            bar.wait(); // el hilo 0 no limpia hasta que todos salieron
+        }
+    }
+
+    size_t bucket_of(float d) const { return (size_t)(d / delta); }
+
+    void push(Local& L, size_t b, int v){
+        if(b >= L.buckets.size()) L.buckets.resize(b + 1);
+        L.buckets[b].push_back(v);
+    }
+
+    // min atómico sobre (dist, padre)
+    void relax(Local& L, int u, int v, float nd){
+        uint64_t want = pack(nd, u);
+        uint64_t old = dp[v].load(std::memory_order_relaxed);
+        while((old >> 32) > (want >> 32)){
+            if(dp[v].compare_exchange_weak(old, want, std::memory_order_relaxed)){
+                if(old == UNSEEN) L.touched.push_back(v); // solo un CAS sale de INF
+                push(L, bucket_of(nd), v);
+                return;
+            }
+        }
+    }
+
+    // Toma la frontera de la cubeta 'b' de todos los hilos
+    void gather(size_t b){
+        F.clear();
+        for(auto& L : loc){
+            if(b < L.buckets.size()){
+                F.insert(F.end(), L.buckets[b].begin(), L.buckets[b].end());
+                L.buckets[b].clear();
+            }
+        }
+        cursor.store(0, std::memory_order_relaxed);
+    }
+
+    // Siguiente cubeta no vacía después de 'b' (SIZE_MAX si no hay)
+    size_t next_bucket(size_t b) const {
+        size_t best = SIZE_MAX;
+        for(const auto& L : loc)
+            for(size_t j = b + 1; j < std::min(best, L.buckets.size()); ++j)
+                if(!L.buckets[j].empty()){ best = j; break; }
+        return best;
+    }
+
+    void light_phase(Local& L){
+        const size_t CHUNK = 64;
+        for(;;){
+            size_t a = cursor.fetch_add(CHUNK, std::memory_order_relaxed);
+            if(a >= F.size()) break;
+            size_t e = std::min(F.size(), a + CHUNK);
+            for(size_t k = a; k < e; ++k){
+                int u = F[k];
+                float du = dist_of(dp[u].load(std::memory_order_relaxed));
+                if(bucket_of(du) != cur) continue;            // obsoleto
+                uint32_t bits = float_bits(du);
+                uint32_t prev = relaxedAt[u].exchange(bits, std::memory_order_relaxed);
+                if(prev == bits) continue;                    // duplicado
+                if(prev == NO_BITS) L.settled.push_back(u);
+                for(long long i = g.row_ptr[u]; i < g.row_ptr[u+1]; ++i){
+                    float w = g.w[i];
+                    if(w < 0.0f || w > delta) continue;       // solo ligeras
+                    relax(L, u, g.col_ind[i], du + w);
+                }
+            }
+        }
+    }
+
+    void heavy_phase(Local& L){
+        for(int u : L.settled){
+            float du = dist_of(dp[u].load(std::memory_order_relaxed));
+            for(long long i = g.row_ptr[u]; i < g.row_ptr[u+1]; ++i){
+                float w = g.w[i];
+                if(w <= delta) continue;                      // solo pesadas
+                relax(L, u, g.col_ind[i], du + w);
+            }
+        }
+        L.settled.clear();
+    }
+
+    void worker(int tid){
+        Local& L = loc[tid];
+        for(;;){
+            bar.wait();                       // hilo 0 dejó lista la cubeta 'cur'
+            if(done) return;
+
+            // Fases ligeras hasta que la cubeta no recibe nodos nuevos
+            for(;;){
+                light_phase(L);
+                bar.wait();
+                if(tid == 0) gather(cur);
+                bar.wait();
+                if(F.empty()) break;
+            }
+
+            heavy_phase(L);
+            bar.wait();
+            if(tid == 0){
+                float dt = dist_of(dp[t].load(std::memory_order_relaxed));
+                size_t nb = next_bucket(cur);
+                if(dt < (float)(cur + 1) * delta || nb == SIZE_MAX) done = true;
+                else { cur = nb; gather(cur); }
+            }
+        }
+    }
+
+    bool run(int s, int t_, SearchWorkspace& ws){
+        t = t_;
+        dp[s].store(pack(0.0f, -1), std::memory_order_relaxed);
+        loc[0].touched.push_back(s);
+        cur = 0; done = false;
+        F.assign(1, s);
+
+        { std::lock_guard<std::mutex> lk(m); ++job; }
+        wake.notify_all();
+        worker(0);
+        bar.wait();
+
+        bool ok = std::isfinite(dist_of(dp[t].load()));
+        // Camino: los padres vienen con su distancia, la cadena baja hasta s
+        int guard = 0;
+        if(ok)
+            for(int v = t; v != s && guard <= g.N; ++guard){
+                int p = parent_of(dp[v].load());
+                ws.parent.set(v, p);
+                v = p;
+            }
+
+        // Limpieza O(tocados) para la próxima consulta
+        for(Local& L : loc){
+            for(int v : L.touched){
+                dp[v].store(UNSEEN, std::memory_order_relaxed);
+                relaxedAt[v].store(NO_BITS, std::memory_order_relaxed);
+            }
+            L.touched.clear();
+            for(auto& b : L.buckets) b.clear();
+        }
+        return ok && guard <= g.N;
+    }
+};
+
+bool delta_stepping_par_run(const CSR& g, int s, int t, int threads, float delta, SearchWorkspace& ws){
+    ws.begin(g.N);
+
+    // Casos borde
+    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
+    if(s == t) return true; // ruta trivial
+
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    // Estado nuevo solo si cambió el grafo (reconocido por sus aristas, como
+    // reverse_of), los hilos o el delta pedido
+    std::shared_ptr<DeltaParState>& st = ws.deltaPar;
+    if(!st || &st->g != &g || st->edges != g.col_ind.data() || (int)st->dp.size() != g.N
+           || st->T != threads || st->requested != delta){
+        st.reset(); // primero se paran los hilos viejos
+        st = std::make_shared<DeltaParState>(g, delta, threads);
+    }
+    return st->run(s, t, ws);
+}
+
+bool delta_stepping_par_run(const CSR& g, int s, int t, int threads, float delta,
+                            std::vector<int>& parent){
+    SearchWorkspace& ws = thread_workspace();
+    bool ok = delta_stepping_par_run(g, s, t, threads, delta, ws);
+    parent.assign(g.N, -1);
+    if(ok) ws.export_path(s, t, parent);
+    return ok;
+}
@@ -1,13 +1,20 @@
 #include "utils.hpp"
+#include "bucket_queue.hpp"
+#include "workspace.hpp"
+#include "graphs.hpp"
 #include <queue>
 #include <limits>
 #include <cmath>
 
 /*
   Dijkstra (pesos no negativos) con:
-  - Grafo en formato CSR (utils.hpp)
-  - Cola de prioridad (min-heap) sobre (distancia, nodo)
-  - "Lazy deletion": ignoramos entradas obsoletas en el heap
+  - Grafo en formato CSR (utils.hpp) o cualquiera de graphs.hpp (CompactCSR,
+    ImplicitGrid): se recorre con g.for_each_out(u, f)
+  - Cola de prioridad elegida por pick_queue (bucket_queue.hpp):
+      pesos enteros <= DIAL_MAX_W -> Dial (sin duplicados, O(1) por operación)
+      pesos enteros mayores       -> radix heap
+      pesos reales                -> min-heap binario sobre (distancia, nodo)
+  - "Lazy deletion": ignoramos entradas obsoletas (heap y radix)
   - Corte temprano: al extraer 't' del heap, ya tenemos su mejor distancia
 
   Entrada:
@@ -16,64 +23,97 @@
     t : destino
   Salida:
     parent[v] : predecesor inmediato en el camino desde s a v (o -1)
+                (con SearchWorkspace: ws.parent, ver workspace.hpp)
     return    : true si existe ruta s->t, false si no
 
   Complejidad:
-    - Tiempo: O( (N + M) log N ) con binary heap
-    - Memoria: O(N) para dist y parent
+    - Tiempo: O( (N + M) log N ) con binary heap; O(N + M + D) con Dial
+      (D = distancia a t)
+    - Memoria: O(N) para dist y parent, reutilizada entre consultas
+      (SearchWorkspace: reset O(1) por épocas)
 
   Notas de implementación (escala):
-    - dist usa float (mismo tipo que pesos). Si tus pesos pueden acumular
-      números muy grandes, cambia a double.
+    - dist usa float (mismo tipo que pesos) con el heap binario y uint32 con
+      Dial/radix, así las distancias enteras son exactas.
     - "Lazy deletion" evita coste extra de decrease-key. Comprobamos si la
       distancia del tope coincide con dist[u]; si no, descartamos.
     - Corte temprano ahorra trabajo cuando solo importa el s->t.
 */
 
-bool dijkstra_run(const CSR& g, int s, int t, std::vector<int>& parent){
-    const float INF = std::numeric_limits<float>::infinity();
-    parent.assign(g.N, -1);
-
-    // Casos borde
-    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
-    if(s == t){ parent[t] = -1; return true; } // ruta trivial (longitud 1)
-
-    std::vector<float> dist(g.N, INF);
-
-    // Min-heap por distancia: (dist, nodo)
-    using P = std::pair<float,int>;
-    std::priority_queue<P, std::vector<P>, std::greater<P>> pq;
+namespace {
+template<class K, class G, class Queue>
+bool dijkstra_search(const G& g, int s, int t, SearchWorkspace& ws, Queue& pq){
+    const K INF = key_inf<K>();
+    auto& dist = ws.keys<K>().a;
+    auto& parent = ws.parent;
+    dist.reset(g.N, INF);
 
     // Inicialización
-    dist[s] = 0.0f;
-    pq.push({0.0f, s});
+    dist.set(s, 0);
+    pq.push(s, 0);
 
     while(!pq.empty()){
-        auto [du, u] = pq.top(); pq.pop();
+        K du;
+        int u = pq.pop(du);
 
         // Entrada obsoleta (lazy deletion)
-        if(du != dist[u]) continue;
+        if(du != dist.get(u)) continue;
 
         // Corte temprano: al extraer u con su mejor distancia,
         // si u == t, ya conocemos la mejor ruta a t.
         if(u == t) break;
+        ++ws.expanded;
 
         // Relajación de aristas salientes u -> v
-        for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e){
-            int   v  = g.col_ind[e];
-            float wuv = g.w[e];
+        g.for_each_out(u, [&](int v, float w){
             // Dijkstra requiere pesos no-negativos
-            if(wuv < 0.0f) continue; // o lanzar excepción si quieres ser estricto
+            if(w < 0.0f) return; // o lanzar excepción si quieres ser estricto
+            ++ws.relaxed;
 
-            float nd = du + wuv;
-            if(nd < dist[v]){
-                dist[v]   = nd;
-                parent[v] = u;
-                pq.push({nd, v});
+            K nd = du + (K)w;
+            if(nd < dist.get(v)){
+                dist.set(v, nd);
+                parent.set(v, u);
+                pq.push(v, nd);
             }
-        }
+        });
     }
 
-    // return true si la distancia finita a t
-    return std::isfinite(dist[t]);
+    // true si la distancia a t es finita
+    return dist.get(t) != INF;
+}
+} // namespace
+
+template<class G>
+bool dijkstra_run(const G& g, int s, int t, SearchWorkspace& ws){
+    ws.begin(g.N);
+
+    // Casos borde
+    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
+    if(s == t) return true; // ruta trivial (longitud 1)
+
+    switch(pick_queue(g)){
+    case QueueKind::Dial:
+        ws.dial.reset(g.N, (uint32_t)g.wmax_int);
+        return dijkstra_search<uint32_t>(g, s, t, ws, ws.dial);
+    case QueueKind::Radix:
+        ws.radix.reset();
+        return dijkstra_search<uint32_t>(g, s, t, ws, ws.radix);
+    default:
+        ws.heap.clear();
+        return dijkstra_search<float>(g, s, t, ws, ws.heap);
+    }
+}
+
+template bool dijkstra_run(const CSR&, int, int, SearchWorkspace&);
+template bool dijkstra_run(const CompactCSR<float>&, int, int, SearchWorkspace&);
+template bool dijkstra_run(const CompactCSR<uint16_t>&, int, int, SearchWorkspace&);
+template bool dijkstra_run(const CompactCSR<uint8_t>&, int, int, SearchWorkspace&);
+template bool dijkstra_run(const ImplicitGrid&, int, int, SearchWorkspace&);
+
+bool dijkstra_run(const CSR& g, int s, int t, std::vector<int>& parent){
+    SearchWorkspace& ws = thread_workspace();
+    bool ok = dijkstra_run(g, s, t, ws);
+    ws.export_tree(parent);
+    return ok;
 }
@@ -1,9 +1,15 @@
 #include "utils.hpp"
+#include "bucket_queue.hpp"
+#include "workspace.hpp"
+#include "graphs.hpp"
 #include <queue>
 #include <limits>
 #include <tuple>
 #include <unordered_map>
 #include <cmath>
+#include <algorithm>
+#include <variant>
+#include <stdexcept>
 
 /*
   D* Lite (dinámico, dirigidos, pesos no negativos)
@@ -18,11 +24,23 @@
   - Este archivo implementa la versión dinámica internamente, y expone:
       - dstar_lite_run_static(...)  -> sin cambios, 1 sola planificación
       - dstar_lite_run_dynamic(...) -> con lista de cambios (opcional)
+      - DStarLiteSession            -> estado vivo entre ticks: el agente se
+                                       mueve (move_to) y llegan cambios
+                                       (update_edge/update_edges); plan() repara y
+                                       extrae la ruta. Lo usa --mode=dynamic
 
   Notas:
   - Requiere grafo inverso (predecesores) para actualizar rápido.
-  - Heurística: reutiliza heuristic_grid(g, u, start_actual). Si no hay coords,
-    h=0 (admisible), equivalente a LPA.
+  - Templado sobre el grafo (CSR o graphs.hpp) y la heurística: política H
+    (with_heuristic, graphs.hpp) evaluada como H(g, u, start_actual), la
+    misma cota que heuristic_grid. Si no hay coords, h=0 (admisible),
+    equivalente a LPA.
+  - applyEdgeUpdate (API dinámica) cambia pesos: solo existe para CSR.
+  - Open-set: con pesos enteros pequeños (pick_queue == Dial) se usa una
+    BucketHeap por floor(k1) con montículo por cubeta; las claves pueden bajar
+    (km, costes que bajan) y la cola rebobina. Si no, min-heap binario.
+  - g, rhs, in_open, key_of, parent y el grafo inverso viven en un
+    SearchWorkspace (workspace.hpp): nada de O(N) ni O(M) por consulta.
 */
 
 namespace {
@@ -37,79 +55,55 @@ struct Key {
     }
 };
 
-struct ReverseCSR {
-    int N=0;
-    std::vector<long long> row_ptr; // N+1
-    std::vector<int>       col_ind; // lista de predecesores: para cada x, lista de p con p->x
-    std::vector<float>     w;       // pesos p->x
+// Open-set por cubetas de floor(k1): mismo orden que el min-heap
+struct BucketOpen {
+    BucketHeap<Key, std::greater<Key>> q;
+    bool empty() const { return q.empty(); }
+    void push(const Key& k){ q.push((size_t)k.k1, k); }
+    const Key& top(){ return q.top(); }
+    void pop(){ q.pop(); }
 };
+using HeapOpen = std::priority_queue<Key, std::vector<Key>, std::greater<Key>>;
 
-ReverseCSR build_reverse(const CSR& g){
-    ReverseCSR r; r.N = g.N;
-    r.row_ptr.assign(r.N+1, 0);
-
-    // contar indegrees
-    for(int u=0; u<g.N; ++u){
-        for(long long e=g.row_ptr[u]; e<g.row_ptr[u+1]; ++e){
-            int v = g.col_ind[e];
-            r.row_ptr[v+1]++; // un pred más para v
-        }
-    }
-    // prefijos
-    for(int i=0;i<r.N;i++) r.row_ptr[i+1]+=r.row_ptr[i];
-    long long M = r.row_ptr.back();
-    r.col_ind.assign(M, 0);
-    r.w.assign(M, 0.0f);
-
-    // relleno: necesitamos offsets temporales
-    std::vector<long long> off = r.row_ptr;
-    for(int u=0; u<g.N; ++u){
-        for(long long e=g.row_ptr[u]; e<g.row_ptr[u+1]; ++e){
-            int v = g.col_ind[e];
-            float ww = g.w[e];
-            long long pos = off[v]++;
-            r.col_ind[pos] = u; // u es pred de v
-            r.w[pos]       = ww;
-        }
-    }
-    return r;
-}
-
+template<class Open, class Graph, class H>
 struct DStarLite {
-    const CSR& G;
-    ReverseCSR R;
+    const Graph& G;
+    H heur;
+    const ReverseCSR& R;
     int s, goal;    // start actual y 'goal' (destino)
     float km = 0.0f;
 
     const float INF = std::numeric_limits<float>::infinity();
 
-    std::vector<float> g, rhs;
-    std::vector<char>  in_open;          // marca rápida
-    std::vector<std::pair<float,float>> key_of; // clave actual (para invalidación)
+    SearchWorkspace& ws;
+    StampedArray<float>& g;
+    StampedArray<float>& rhs;
+    StampSet& in_open;                           // marca rápida
+    StampedArray<std::pair<float,float>>& key_of; // clave actual (para invalidación)
 
     // open-set con lazy deletion
-    std::priority_queue<Key, std::vector<Key>, std::greater<Key>> open;
+    Open open;
 
-    DStarLite(const CSR& g, int start, int target)
-      : G(g), R(build_reverse(g)), s(start), goal(target),
-        g(g.N, INF), rhs(g.N, INF), in_open(g.N, 0), key_of(g.N, {INF, INF})
+    DStarLite(const Graph& g, int start, int target, SearchWorkspace& ws, H heur)
+      : G(g), heur(heur), R(ws.reverse_of(g)), s(start), goal(target), ws(ws),
+        g(ws.kf.a), rhs(ws.kf.b), in_open(ws.inOpen), key_of(ws.keyOf)
     {
+        this->g.reset(g.N, INF);
+        rhs.reset(g.N, INF);
+        in_open.reset(g.N);
+        key_of.reset(g.N, {INF, INF});
+
         // Inicialización: rhs(goal) = 0; inserta goal en OPEN
         rhs[goal] = 0.0f;
         insert(goal);
     }
 
     // Heurística entre dos nodos (usada con start)
-    inline float h(int a, int b) const {
-        // reusamos heuristic_grid si hay coords; caso contrario 0
-        // Nota: utils::heuristic_grid(g,u,t) requiere referencia no-const
-        // así que hacemos un const_cast seguro (no modifica 'G')
-        return heuristic_grid(const_cast<CSR&>(G), a, b);
-    }
+    inline float h(int a, int b) const { return heur(G, a, b); }
 
     // Calcula clave de un nodo u
     inline std::pair<float,float> calcKey(int u) const {
-        float mu = std::min(g[u], rhs[u]);
+        float mu = std::min(g.get(u), rhs.get(u));
         return { mu + h(u, s) + km,  mu };
     }
 
@@ -117,29 +111,31 @@ struct DStarLite {
         auto K = calcKey(u);
         key_of[u] = K;
         open.push(Key{K.first, K.second, u});
-        in_open[u] = 1;
+        in_open.insert(u);
     }
     void remove_from_open(int u){
         // Lazy: no extraemos explícitamente; solo invalidamos marca.
-        in_open[u] = 0;
+        in_open.erase(u);
     }
 
-    // Coste c(u,v) (si no existe, INF). Aquí el grafo es CSR saliente:
-    // recorrer aristas de u y buscar v.
+    // Coste c(u,v) (si no existe, INF): recorrer aristas salientes de u y
+    // buscar v (la primera, como en el CSR)
     float cost_uv(int u, int v) const {
-        for(long long e=G.row_ptr[u]; e<G.row_ptr[u+1]; ++e)
-            if(G.col_ind[e]==v) return G.w[e];
-        return INF;
+        float c = INF; bool found = false;
+        G.for_each_out(u, [&](int x, float w){
+            if(!found && x == v){ c = w; found = true; }
+        });
+        return c;
     }
 
     // rhs(u) = min_{v in Succ(u)} c(u,v) + g(v)
     float min_rhs_succ(int u){
         float best = INF;
-        for(long long e=G.row_ptr[u]; e<G.row_ptr[u+1]; ++e){
-            int v = G.col_ind[e];
-            float cand = G.w[e] + g[v];
+        G.for_each_out(u, [&](int v, float w){
+            float cand = w + g.get(v);
             if(cand < best) best = cand;
-        }
+            ++ws.relaxed;
+        });
         return best;
     }
 
@@ -148,8 +144,8 @@ struct DStarLite {
             rhs[u] = min_rhs_succ(u);
         }
         // Si u ya está en open, invalídalo (lazy)
-        if(in_open[u]) remove_from_open(u);
-        if(g[u] != rhs[u]){
+        if(in_open.has(u)) remove_from_open(u);
+        if(g.get(u) != rhs.get(u)){
             insert(u);
         }
     }
@@ -167,7 +163,7 @@ struct DStarLite {
             // Limpieza de entradas obsoletas
             Key top = open.top();
             auto Ktop_pair = std::make_pair(top.k1, top.k2);
-            if(!in_open[top.u] || Ktop_pair != key_of[top.u]){
+            if(!in_open.has(top.u) || Ktop_pair != key_of.get(top.u)){
                 open.pop();
                 continue;
             }
@@ -177,13 +173,14 @@ struct DStarLite {
 
             // Condición de parada:
             // while ( topKey < key(s) || rhs(s) != g(s) )
-            if( !lessKey(Ktop, Kstart) && !(rhs[s] != g[s]) ){
+            if( !lessKey(Ktop, Kstart) && !(rhs.get(s) != g.get(s)) ){
                 break;
             }
 
             int u = top.u;
             open.pop();
-            in_open[u] = 0;
+            in_open.erase(u);
+            ++ws.expanded;
 
             auto Kold = Ktop;
 
@@ -194,7 +191,7 @@ struct DStarLite {
                 continue;
             }
 
-            if( g[u] > rhs[u] ){
+            if( g.get(u) > rhs.get(u) ){
                 // Mejora: fijamos g[u] y actualizamos predecesores
                 g[u] = rhs[u];
                 // para todo p en Pred(u): updateVertex(p)
@@ -204,13 +201,13 @@ struct DStarLite {
                 }
             } else {
                 // Empeora: g[u] = INF; actualizar u y todos sus predecesores
-                float gold = g[u];
+                float gold = g.get(u);
                 g[u] = INF;
                 updateVertex(u);
                 for(long long e=R.row_ptr[u]; e<R.row_ptr[u+1]; ++e){
                     int p = R.col_ind[e];
                     // Solo los que dependían de u podrían mejorar/empeorar
-                    if (std::fabs(rhs[p] - (cost_uv(p,u) + gold)) < 1e-6f){
+                    if (std::fabs(rhs.get(p) - (cost_uv(p,u) + gold)) < 1e-6f){
                         updateVertex(p);
                     } else {
                         // Aun si no era el argmin exacto, es seguro actualizar
@@ -222,44 +219,73 @@ struct DStarLite {
         }
     }
 
-    // Aplica un cambio de peso en arista u->v (nuevo valor nw)
-    // y repara el grafo incrementalmente.
-    void applyEdgeUpdate(int u, int v, float nw){
-        // 1) Actualiza coste en CSR (u->v). (Búsqueda lineal en out-aristas de u.)
-        bool found=false;
+    // El agente avanzó a 'ns': las claves viejas quedan cortas en a lo sumo
+    // h(s, ns), que se acumula en km en vez de recalcular el open-set
+    void moveStart(int ns){
+        km += h(s, ns);
+        s = ns;
+    }
+
+    // Cambia el peso de u->v en el CSR (la primera u->v; búsqueda lineal en
+    // las aristas salientes de u). false si no existe o no es válido.
+    bool setEdgeCost(int u, int v, float nw){
+        if(u<0||u>=G.N||v<0||v>=G.N||nw < 0.0f) return false; // no-negativos
         for(long long e=G.row_ptr[u]; e<G.row_ptr[u+1]; ++e){
             if(G.col_ind[e]==v){
                 const_cast<CSR&>(G).w[e] = nw; // mutación controlada
-                found=true; break;
+                return true;
             }
         }
-        if(!found){
-            // Si no existía, ignoramos (o podrías insertarla; omitimos por simplicidad)
-            return;
-        }
+        // Si no existía, ignoramos (o podrías insertarla; omitimos por simplicidad)
+        return false;
+    }
+
+    // Aplica un cambio de peso en arista u->v (nuevo valor nw)
+    // y repara el grafo incrementalmente. false si la arista no existe.
+    bool applyEdgeUpdate(int u, int v, float nw){
+        // 1) Actualiza coste en CSR (u->v)
+        if(!setEdgeCost(u, v, nw)) return false;
         // 2) Recalcular rhs(u) porque depende de Succ(u)
         updateVertex(u);
         // 3) Repara óptimos
         computeShortestPath();
+        return true;
+    }
+
+    // Lote de cambios [first, last) de EdgeUpdate: primero todos los pesos,
+    // luego updateVertex una vez por cada origen distinto y una sola
+    // reparación. Devuelve cuántos cambios se aplicaron.
+    template<class It>
+    int applyEdgeUpdates(It first, It last){
+        std::vector<int> touched;
+        for(It it = first; it != last; ++it)
+            if(setEdgeCost(it->u, it->v, it->w)) touched.push_back(it->u);
+        int applied = (int)touched.size();
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for(int u : touched) updateVertex(u);
+        if(applied) computeShortestPath();
+        return applied;
     }
 
     // Extrae una ruta greedy desde s hasta goal usando g(.) ya calculado.
-    // Llena 'parent[v] = u' (predecesor) para reconstruir de goal hacia s.
-    bool extract_path(std::vector<int>& parent){
-        parent.assign(G.N, -1);
-        if(!std::isfinite(g[s])) return false; // no hay ruta
+    // Llena 'parent[v] = u' (predecesor, en ws.parent) para reconstruir de
+    // goal hacia s.
+    bool extract_path(){
+        StampedArray<int>& parent = ws.parent;
+        parent.reset(G.N, -1);
+        if(!std::isfinite(g.get(s))) return false; // no hay ruta
 
         int u = s;
         int guard=0;
         while(u != goal){
             float best = INF; int best_v = -1;
-            for(long long e=G.row_ptr[u]; e<G.row_ptr[u+1]; ++e){
-                int v = G.col_ind[e];
-                float cand = G.w[e] + g[v];
+            G.for_each_out(u, [&](int v, float w){
+                float cand = w + g.get(v);
                 if(cand < best){
                     best = cand; best_v = v;
                 }
-            }
+            });
             if(best_v == -1 || !std::isfinite(best)) return false;
             parent[best_v] = u;  // para backtracking desde goal
             u = best_v;
@@ -273,11 +299,39 @@ struct DStarLite {
 // -----------------------------
 // API ESTÁTICA (para tu header)
 // -----------------------------
-bool dstar_lite_run_static(const CSR& g, int s, int t, std::vector<int>& parent){
+template<class G>
+bool dstar_lite_run_static(const G& g, int s, int t, SearchWorkspace& ws){
+    ws.begin(g.N);
+    if(s<0||s>=g.N||t<0||t>=g.N) return false;
+
     // Un solo plan estático: inicializa y resuelve
-    DStarLite dsl(g, s, t);
-    dsl.computeShortestPath();
-    return dsl.extract_path(parent);
+    bool buckets = pick_queue(g) == QueueKind::Dial;
+    return with_heuristic(g, [&](auto heur){
+        using H = decltype(heur);
+        auto run = [&](auto& dsl){
+            dsl.computeShortestPath();
+            return dsl.extract_path();
+        };
+        if(buckets){
+            DStarLite<BucketOpen, G, H> dsl(g, s, t, ws, heur);
+            return run(dsl);
+        }
+        DStarLite<HeapOpen, G, H> dsl(g, s, t, ws, heur);
+        return run(dsl);
+    });
+}
+
+template bool dstar_lite_run_static(const CSR&, int, int, SearchWorkspace&);
+template bool dstar_lite_run_static(const CompactCSR<float>&, int, int, SearchWorkspace&);
+template bool dstar_lite_run_static(const CompactCSR<uint16_t>&, int, int, SearchWorkspace&);
+template bool dstar_lite_run_static(const CompactCSR<uint8_t>&, int, int, SearchWorkspace&);
+template bool dstar_lite_run_static(const ImplicitGrid&, int, int, SearchWorkspace&);
+
+bool dstar_lite_run_static(const CSR& g, int s, int t, std::vector<int>& parent){
+    SearchWorkspace& ws = thread_workspace();
+    bool ok = dstar_lite_run_static(g, s, t, ws);
+    ws.export_tree(parent);
+    return ok;
 }
 
 // --------------------------------------------------------------
@@ -288,16 +342,96 @@ bool dstar_lite_run_static(const CSR& g, int s, int t, std::vector<int>& parent)
 bool dstar_lite_run_dynamic(const CSR& g, int s, int t,
                             const std::vector<std::tuple<int,int,float>>& updates,
                             std::vector<int>& parent){
-    DStarLite dsl(g, s, t);
-    // Plan inicial
-    dsl.computeShortestPath();
-    // Aplica cambios (p.ej., bloqueos: new_w muy grande; o ajustes locales)
+    SearchWorkspace ws; // propio: applyEdgeUpdate cambia pesos del grafo
+    ws.begin(g.N);
+    auto run = [&](auto& dsl){
+        // Plan inicial
+        dsl.computeShortestPath();
+        // Aplica cambios (p.ej., bloqueos: new_w muy grande; o ajustes
+        // locales) en un solo lote: una reparación para todos
+        std::vector<EdgeUpdate> ups;
+        ups.reserve(updates.size());
+        for(const auto& up: updates)
+            ups.push_back(EdgeUpdate{std::get<0>(up), std::get<1>(up), std::get<2>(up)});
+        dsl.applyEdgeUpdates(ups.begin(), ups.end());
+        bool ok = dsl.extract_path();
+        ws.export_tree(parent);
+        return ok;
+    };
+    // Los nuevos pesos pueden salirse del rango entero: solo cubetas si
+    // también son enteros pequeños
+    bool small = pick_queue(g) == QueueKind::Dial;
     for(const auto& up: updates){
-        int u,v; float nw;
-        std::tie(u,v,nw) = up;
-        if(u<0||u>=g.N||v<0||v>=g.N) continue;
-        if(nw < 0.0f) continue; // D* Lite requiere no-negativos
-        dsl.applyEdgeUpdate(u, v, nw);
+        float nw = std::get<2>(up);
+        if(nw != std::floor(nw) || nw > (float)DIAL_MAX_W) small = false;
     }
-    return dsl.extract_path(parent);
+    return with_heuristic(g, [&](auto heur){
+        using H = decltype(heur);
+        if(small){
+            DStarLite<BucketOpen, CSR, H> dsl(g, s, t, ws, heur);
+            return run(dsl);
+        }
+        DStarLite<HeapOpen, CSR, H> dsl(g, s, t, ws, heur);
+        return run(dsl);
+    });
 }
+
+// --------------------------------------------------------------
+// SESIÓN INCREMENTAL: g/rhs/open-set sobreviven entre ticks
+// --------------------------------------------------------------
+// Los pesos nuevos son arbitrarios: siempre open-set con min-heap binario.
+namespace {
+template<class H> using SessionDSL = DStarLite<HeapOpen, CSR, H>;
+} // namespace
+
+struct DStarLiteSession::Impl {
+    SearchWorkspace ws;
+    std::variant<std::monostate,
+                 SessionDSL<ZeroHeuristic>,
+                 SessionDSL<GridHeuristic<false>>,
+                 SessionDSL<GridHeuristic<true>>> dsl;
+
+    template<class F> auto visit(F&& f){
+        return std::visit([&](auto& d){
+            if constexpr(std::is_same_v<std::decay_t<decltype(d)>, std::monostate>)
+                return decltype(f(std::get<1>(dsl)))();
+            else
+                return f(d);
+        }, dsl);
+    }
+};
+
+DStarLiteSession::DStarLiteSession(CSR& g, int s, int t) : impl(new Impl) {
+    if(s<0||s>=g.N||t<0||t>=g.N) throw std::runtime_error("DStarLiteSession: s/t fuera del grafo");
+    impl->ws.begin(g.N);
+    with_heuristic(g, [&](auto heur){
+        impl->dsl.emplace<SessionDSL<decltype(heur)>>(g, s, t, impl->ws, heur);
+        return 0;
+    });
+}
+
+DStarLiteSession::~DStarLiteSession() = default;
+
+bool DStarLiteSession::plan(){
+    return impl->visit([](auto& d){
+        d.computeShortestPath();
+        return d.extract_path();
+    });
+}
+
+void DStarLiteSession::move_to(int s){
+    impl->visit([&](auto& d){
+        if(s >= 0 && s < d.G.N) d.moveStart(s);
+        return 0;
+    });
+}
+
+bool DStarLiteSession::update_edge(int u, int v, float w){
+    return impl->visit([&](auto& d){ return d.applyEdgeUpdate(u, v, w); });
+}
+
+int DStarLiteSession::update_edges(const std::vector<EdgeUpdate>& ups){
+    return impl->visit([&](auto& d){ return d.applyEdgeUpdates(ups.begin(), ups.end()); });
+}
+
+SearchWorkspace& DStarLiteSession::workspace(){ return impl->ws; }
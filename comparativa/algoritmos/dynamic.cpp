@@ -0,0 +1,234 @@
+#include "utils.hpp"
+#include "workspace.hpp"
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+/*
+  Escenarios dinámicos (--mode=dynamic): un agente va de s a t mientras
+  cambian pesos de aristas, y se compara replanificar de cero (Dijkstra, A*,
+  ...) contra reparar con D* Lite incremental (DStarLiteSession).
+
+  - gen_dynamic_stream arma el flujo una sola vez con un Dijkstra de
+    referencia: en cada tick el agente avanza 'step' nodos por la ruta
+    vigente, llegan 'changes' cambios según el modelo y se replanifica.
+    Todos los algoritmos reproducen exactamente el mismo flujo (posiciones
+    y cambios), aunque sus rutas difieran en empates.
+  - Por tick se mide la latencia de aplicar los cambios + replanificar, y
+    los nodos expandidos / aristas examinadas (contadores del workspace).
+  - Los pesos del grafo se modifican en el lugar (también si está mapeado:
+    el mapeo es copy-on-write) y se restauran al terminar; wmin_int /
+    wmax_int se amplían con cada peso nuevo para que pick_queue siga siendo
+    válido y se recalculan al restaurar.
+*/
+
+namespace {
+// Primera arista u->v (-1 si no existe)
+long long first_edge(const CSR& g, int u, int v){
+    for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e)
+        if(g.col_ind[e] == v) return e;
+    return -1;
+}
+
+// Amplía [wmin_int, wmax_int] con el peso w (o lo invalida si no es entero)
+void note_weight(CSR& g, float w){
+    if(g.wmin_int < 0) return;
+    if(!(w >= 0.0f && w <= (float)(1 << 20)) || w != std::floor(w)){
+        g.wmin_int = g.wmax_int = -1;
+        return;
+    }
+    g.wmin_int = std::min(g.wmin_int, (int)w);
+    g.wmax_int = std::max(g.wmax_int, (int)w);
+}
+
+void apply_updates(CSR& g, const std::vector<EdgeUpdate>& ups){
+    for(const EdgeUpdate& up : ups){
+        long long e = first_edge(g, up.u, up.v);
+        if(e < 0) continue;
+        g.w[e] = up.w;
+        note_weight(g, up.w);
+    }
+}
+
+// Guarda los pesos al empezar y los devuelve al salir del ámbito
+struct WeightGuard {
+    CSR& g;
+    std::vector<float> w0;
+    explicit WeightGuard(CSR& g) : g(g), w0(g.w.begin(), g.w.end()) {}
+    ~WeightGuard(){
+        std::copy(w0.begin(), w0.end(), g.w.begin());
+        classify_weights(g);
+    }
+};
+
+// Nodos de la ruta s->t (vacío si no hay)
+std::vector<int> path_nodes(int s, int t, const std::vector<int>& parent){
+    std::vector<int> p;
+    for(int v = t, guard = 0; v != -1 && guard <= (int)parent.size(); v = parent[v], ++guard){
+        p.push_back(v);
+        if(v == s){ std::reverse(p.begin(), p.end()); return p; }
+    }
+    return {};
+}
+
+DynamicResult summarize(std::vector<double>& lat, long long ok, double init_ms,
+                        double expanded, double relaxed, double cost){
+    DynamicResult r;
+    r.ticks = (long long)lat.size();
+    r.ok = ok;
+    r.init_ms = init_ms;
+    double n = lat.empty() ? 1.0 : (double)lat.size();
+    for(double x : lat) r.mean_ms += x;
+    r.mean_ms /= n;
+    std::sort(lat.begin(), lat.end());
+    r.p50 = percentile(lat, 0.50);
+    r.p95 = percentile(lat, 0.95);
+    r.p99 = percentile(lat, 0.99);
+    r.max_ms = lat.empty() ? 0.0 : lat.back();
+    r.expanded = expanded / n;
+    r.relaxed = relaxed / n;
+    r.cost = ok > 0 ? cost / (double)ok : 0.0;
+    return r;
+}
+} // namespace
+
+DynamicStream gen_dynamic_stream(CSR& g, int s, int t, const std::string& model,
+                                 int ticks, int changes, int step, float factor,
+                                 unsigned seed){
+    if(s < 0 || s >= g.N || t < 0 || t >= g.N) throw std::runtime_error("s/t fuera del grafo");
+    if(model != "random" && model != "clustered" && model != "path")
+        throw std::runtime_error("Modelo de cambios desconocido: " + model);
+    if(!(factor > 0.0f)) throw std::runtime_error("--factor debe ser > 0");
+    if(g.M == 0) throw std::runtime_error("El grafo no tiene aristas");
+
+    WeightGuard guard(g);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<long long> UE(0, g.M - 1);
+    std::uniform_int_distribution<int> UN(0, g.N - 1);
+
+    // Arista e (normalizada a la primera u->v) alternada entre w0 y w0*factor
+    std::vector<int> src(g.M);
+    for(int u = 0; u < g.N; ++u)
+        for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1]; ++e) src[e] = u;
+    auto toggle = [&](long long e){
+        int u = src[e], v = g.col_ind[e];
+        e = first_edge(g, u, v);
+        float w0 = guard.w0[e];
+        return EdgeUpdate{u, v, g.w[e] == w0 ? w0 * factor : w0};
+    };
+
+    DynamicStream st;
+    st.s = s; st.t = t;
+
+    SearchWorkspace ws;
+    std::vector<int> parent(g.N, -1);
+    auto replan = [&](int from){
+        if(!dijkstra_run(g, from, t, ws)) return std::vector<int>{};
+        ws.export_path(from, t, parent);
+        return path_nodes(from, t, parent);
+    };
+
+    std::vector<int> path = replan(s);
+    for(int k = 0; k < ticks; ++k){
+        // 1) El agente avanza por la ruta vigente (si hay)
+        if(!path.empty()) s = path[std::min<size_t>((size_t)std::max(step, 0), path.size() - 1)];
+        if(s == t) break;
+        path = path.empty() ? path : std::vector<int>(std::find(path.begin(), path.end(), s), path.end());
+
+        // 2) Cambios del tick
+        DynamicTick tick;
+        tick.s = s;
+        std::vector<EdgeUpdate>& ups = tick.updates;
+        if(model == "clustered"){
+            // BFS desde un centro al azar hasta juntar 'changes' aristas
+            std::vector<int> q{UN(rng)};
+            std::vector<char> seen(g.N, 0);
+            seen[q[0]] = 1;
+            for(size_t i = 0; i < q.size() && (int)ups.size() < changes; ++i){
+                int u = q[i];
+                for(long long e = g.row_ptr[u]; e < g.row_ptr[u+1] && (int)ups.size() < changes; ++e){
+                    ups.push_back(toggle(e));
+                    apply_updates(g, {ups.back()});
+                    int v = g.col_ind[e];
+                    if(!seen[v]){ seen[v] = 1; q.push_back(v); }
+                }
+            }
+        } else if(model == "path" && path.size() > 1){
+            std::uniform_int_distribution<size_t> UP(0, path.size() - 2);
+            for(int c = 0; c < changes; ++c){
+                size_t i = UP(rng);
+                ups.push_back(toggle(first_edge(g, path[i], path[i+1])));
+                apply_updates(g, {ups.back()});
+            }
+        }
+        // random (y relleno de los otros modelos)
+        while((int)ups.size() < changes){
+            ups.push_back(toggle(UE(rng)));
+            apply_updates(g, {ups.back()});
+        }
+        st.ticks.push_back(std::move(tick));
+
+        // 3) Ruta de referencia con los pesos nuevos
+        path = replan(s);
+    }
+    return st;
+}
+
+DynamicResult run_dynamic_scratch(CSR& g, const DynamicStream& st, const QueryFn& fn){
+    WeightGuard guard(g);
+    SearchWorkspace ws;
+    std::vector<int> parent(g.N, -1);
+
+    Timer T; T.start();
+    fn(st.s, st.t, ws, parent);
+    double init_ms = T.ms();
+
+    std::vector<double> lat;
+    long long ok = 0;
+    double expanded = 0, relaxed = 0, cost = 0;
+    for(const DynamicTick& tick : st.ticks){
+        ws.expanded = ws.relaxed = 0;
+        T.start();
+        apply_updates(g, tick.updates);
+        bool found = fn(tick.s, st.t, ws, parent);
+        lat.push_back(T.ms());
+
+        expanded += (double)ws.expanded;
+        relaxed  += (double)ws.relaxed;
+        if(found){ ++ok; cost += path_cost(tick.s, st.t, g, parent); }
+    }
+    return summarize(lat, ok, init_ms, expanded, relaxed, cost);
+}
+
+DynamicResult run_dynamic_dstar(CSR& g, const DynamicStream& st){
+    WeightGuard guard(g);
+    std::vector<int> parent(g.N, -1);
+
+    Timer T; T.start();
+    DStarLiteSession dsl(g, st.s, st.t);
+    dsl.plan();
+    double init_ms = T.ms();
+
+    SearchWorkspace& ws = dsl.workspace();
+    std::vector<double> lat;
+    long long ok = 0;
+    double expanded = 0, relaxed = 0, cost = 0;
+    for(const DynamicTick& tick : st.ticks){
+        ws.expanded = ws.relaxed = 0;
+        T.start();
+        dsl.move_to(tick.s);
+        dsl.update_edges(tick.updates);
+        bool found = dsl.plan();
+        lat.push_back(T.ms());
+
+        expanded += (double)ws.expanded;
+        relaxed  += (double)ws.relaxed;
+        if(found){
+            ++ok;
+            ws.export_path(tick.s, st.t, parent);
+            cost += path_cost(tick.s, st.t, g, parent);
+        }
+    }
+    return summarize(lat, ok, init_ms, expanded, relaxed, cost);
+}
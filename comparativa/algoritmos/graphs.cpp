@@ -0,0 +1,84 @@
+#include "graphs.hpp"
+#include <stdexcept>
+#include <limits>
+#include <string>
+
+int compact_weight_bytes(const CSR& g){
+    if(g.wmin_int >= 0 && g.wmax_int <= 255)   return 1;
+    if(g.wmin_int >= 0 && g.wmax_int <= 65535) return 2;
+    return 4;
+}
+
+template<class W>
+CompactCSR<W> make_compact(const CSR& g){
+    if(g.M >= (long long)std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("CompactCSR: M no entra en 32 bits");
+    if(!std::numeric_limits<W>::is_integer){
+        // float: cualquier peso
+    } else if(g.wmin_int < 0 || g.wmax_int > (int)std::numeric_limits<W>::max()){
+        throw std::runtime_error("CompactCSR: los pesos no son enteros en [0, "
+                                 + std::to_string((int)std::numeric_limits<W>::max()) + "]");
+    }
+
+    CompactCSR<W> c;
+    c.N = g.N; c.M = g.M;
+    c.row_ptr.resize((size_t)g.N + 1);
+    for(int u = 0; u <= g.N; ++u) c.row_ptr[u] = (uint32_t)g.row_ptr[u];
+    c.col_ind.assign(g.col_ind.begin(), g.col_ind.end());
+    c.w.resize((size_t)g.M);
+    for(long long e = 0; e < g.M; ++e) c.w[e] = (W)g.w[e];
+
+    c.has_coords = g.has_coords; c.diag8 = g.diag8;
+    c.rows = g.rows; c.cols = g.cols;
+    c.wmin_int = g.wmin_int; c.wmax_int = g.wmax_int;
+    if(g.has_coords){
+        // ¿Coordenadas de grid (x = columna, y = fila)? Entonces no se guardan
+        bool grid = g.rows > 0 && g.cols > 0 && 1LL*g.rows*g.cols == g.N;
+        for(int u = 0; grid && u < g.N; ++u)
+            grid = g.x[u] == (float)(u % g.cols) && g.y[u] == (float)(u / g.cols);
+        c.grid_coords = grid;
+        if(!grid){
+            c.x.assign(g.x.begin(), g.x.end());
+            c.y.assign(g.y.begin(), g.y.end());
+        }
+    }
+    return c;
+}
+
+template CompactCSR<float>    make_compact<float>(const CSR&);
+template CompactCSR<uint16_t> make_compact<uint16_t>(const CSR&);
+template CompactCSR<uint8_t>  make_compact<uint8_t>(const CSR&);
+
+ImplicitGrid make_implicit_grid(const CSR& g){
+    auto fail = [](const char* why){ throw std::runtime_error(std::string("ImplicitGrid: ") + why); };
+    if(g.rows <= 0 || g.cols <= 0 || 1LL*g.rows*g.cols != g.N) fail("el grafo no es un grid (rows/cols)");
+    if(g.M > 0){
+        for(long long e = 1; e < g.M; ++e) if(g.w[e] != g.w[0]) fail("los pesos no son uniformes");
+        if(g.w[0] < 0.0f) fail("peso negativo");
+    }
+
+    ImplicitGrid G;
+    G.N = g.N; G.M = g.M;
+    G.rows = g.rows; G.cols = g.cols; G.diag8 = g.diag8;
+    G.w0 = g.M > 0 ? g.w[0] : 1.0f;
+    G.wmin_int = g.wmin_int; G.wmax_int = g.wmax_int;
+
+    // Celdas sin aristas salientes = bloqueadas (solo si hay alguna)
+    for(int u = 0; u < g.N; ++u){
+        if(g.row_ptr[u] != g.row_ptr[u+1]) continue;
+        if(G.blocked.empty()) G.blocked.assign(((size_t)g.N + 63) / 64, 0);
+        G.blocked[(size_t)u >> 6] |= 1ull << (u & 63);
+    }
+
+    // Las aristas del CSR tienen que ser exactamente las implícitas
+    for(int u = 0; u < g.N; ++u){
+        long long e = g.row_ptr[u];
+        bool ok = true;
+        G.for_each_out(u, [&](int v, float){
+            ok = ok && e < g.row_ptr[u+1] && g.col_ind[e] == v;
+            ++e;
+        });
+        if(!ok || e != g.row_ptr[u+1]) fail("las aristas no coinciden con un grid de gen_grid");
+    }
+    return G;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include "utils.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+  Representaciones compactas del grafo para los algoritmos templados
+  (dijkstra_run / astar_run aceptan cualquiera de estos tipos o CSR):
+
+  - CompactCSR<W>: row_ptr de 32 bits (exige M < 2^32) y pesos en W:
+      float    : mismos pesos que el CSR
+      uint16_t : pesos enteros en [0, 65535], exactos
+      uint8_t  : pesos enteros en [0, 255], exactos
+    En grids las coordenadas salen de (u / cols, u % cols); si no, se copian.
+  - ImplicitGrid: grid rows x cols (4 u 8 vecinos) con peso uniforme y
+    celdas bloqueadas en un bitset. Los vecinos se calculan desde (r, c), sin
+    arreglos de aristas, en el mismo orden que gen_grid.
+
+  Interfaz común (la misma que ofrece CSR):
+    N, M, wmin_int, wmax_int, has_coords, diag8
+    for_each_out(u, f)  -> llama f(v, w) por cada arista u->v
+    heuristic(u, t)     -> la misma cota que heuristic_grid
+    coord_delta(u,t,..) -> |dx|, |dy| entre u y t (si has_coords)
+    bytes()             -> memoria de la estructura
+*/
+
+// Manhattan (4-dir) u octile (8-dir) desde las diferencias de coordenadas
+inline float grid_heuristic(float dx, float dy, bool diag8){
+    if(diag8){
+        const float D = 1.0f, D2 = 1.41421356f;
+        return D*(dx+dy) + (D2 - 2*D)*(dx < dy ? dx : dy);
+    }
+    return dx + dy;
+}
+
+template<class W>
+struct CompactCSR {
+    int N = 0;
+    long long M = 0;
+    std::vector<uint32_t> row_ptr;   // tamaño N+1
+    std::vector<int>      col_ind;   // tamaño M
+    std::vector<W>        w;         // tamaño M
+
+    bool has_coords = false, diag8 = false;
+    int  rows = 0, cols = 0;
+    bool grid_coords = false;        // coords = (u % cols, u / cols), sin arreglos
+    std::vector<float> x, y;         // solo si has_coords && !grid_coords
+    int wmin_int = -1, wmax_int = -1;
+
+    template<class F> void for_each_out(int u, F&& f) const {
+        for(uint32_t e = row_ptr[u]; e < row_ptr[u+1]; ++e) f(col_ind[e], (float)w[e]);
+    }
+
+    void coord_delta(int u, int t, float& dx, float& dy) const {
+        if(grid_coords){
+            int du = u / cols - t / cols, dc = u % cols - t % cols;
+            dx = (float)(dc < 0 ? -dc : dc); dy = (float)(du < 0 ? -du : du);
+        } else {
+            dx = x[u] > x[t] ? x[u] - x[t] : x[t] - x[u];
+            dy = y[u] > y[t] ? y[u] - y[t] : y[t] - y[u];
+        }
+    }
+
+    float heuristic(int u, int t) const {
+        if(!has_coords) return 0.0f;
+        float dx, dy;
+        coord_delta(u, t, dx, dy);
+        return grid_heuristic(dx, dy, diag8);
+    }
+
+    size_t bytes() const {
+        return row_ptr.size()*sizeof(uint32_t) + col_ind.size()*sizeof(int)
+             + w.size()*sizeof(W) + (x.size() + y.size())*sizeof(float);
+    }
+};
+
+struct ImplicitGrid {
+    int N = 0;
+    long long M = 0;                 // aristas implícitas (informativo)
+    int rows = 0, cols = 0;
+    bool diag8 = false;
+    bool has_coords = true;
+    float w0 = 1.0f;                 // peso de todas las aristas
+    int wmin_int = -1, wmax_int = -1;
+    std::vector<uint64_t> blocked;   // bitset de celdas sin aristas (vacío = ninguna)
+
+    bool is_blocked(int u) const {
+        return !blocked.empty() && ((blocked[(size_t)u >> 6] >> (u & 63)) & 1u);
+    }
+
+    template<class F> void for_each_out(int u, F&& f) const {
+        // Mismo orden de vecinos que gen_grid
+        static constexpr int DR[8] = { 1,-1, 0, 0, 1, 1,-1,-1};
+        static constexpr int DC[8] = { 0, 0, 1,-1, 1,-1, 1,-1};
+        if(is_blocked(u)) return;
+        const int r = u / cols, c = u % cols, K = diag8 ? 8 : 4;
+        for(int k = 0; k < K; ++k){
+            int rr = r + DR[k], cc = c + DC[k];
+            if(rr < 0 || rr >= rows || cc < 0 || cc >= cols) continue;
+            int v = rr * cols + cc;
+            if(!is_blocked(v)) f(v, w0);
+        }
+    }
+
+    void coord_delta(int u, int t, float& dx, float& dy) const {
+        int du = u / cols - t / cols, dc = u % cols - t % cols;
+        dx = (float)(dc < 0 ? -dc : dc); dy = (float)(du < 0 ? -du : du);
+    }
+
+    float heuristic(int u, int t) const {
+        float dx, dy;
+        coord_delta(u, t, dx, dy);
+        return grid_heuristic(dx, dy, diag8);
+    }
+
+    size_t bytes() const { return blocked.size()*sizeof(uint64_t); }
+};
+
+// -------- Heurística como política --------
+// with_heuristic(g, f) mira has_coords/diag8 una sola vez y llama f(H) con
+// H = ZeroHeuristic, GridHeuristic<false> (Manhattan) o GridHeuristic<true>
+// (octile). Dentro de la búsqueda H{}(g, u, t) no tiene ramas y se inlinea;
+// da los mismos valores que g.heuristic(u, t).
+struct ZeroHeuristic {
+    template<class G> float operator()(const G&, int, int) const { return 0.0f; }
+};
+
+template<bool Diag8>
+struct GridHeuristic {
+    template<class G> float operator()(const G& g, int u, int t) const {
+        float dx, dy;
+        g.coord_delta(u, t, dx, dy);
+        return grid_heuristic(dx, dy, Diag8);
+    }
+};
+
+template<class G, class F>
+auto with_heuristic(const G& g, F&& f){
+    if(!g.has_coords) return f(ZeroHeuristic{});
+    if(g.diag8)       return f(GridHeuristic<true>{});
+    return f(GridHeuristic<false>{});
+}
+
+// Grafo inverso de cualquier G (para CSR está build_reverse de utils.cpp)
+template<class G>
+ReverseCSR build_reverse(const G& g){
+    ReverseCSR R; R.N = g.N;
+    R.row_ptr.assign((size_t)g.N + 1, 0);
+    for(int u = 0; u < g.N; ++u)
+        g.for_each_out(u, [&](int v, float){ ++R.row_ptr[v + 1]; });
+    for(int v = 0; v < g.N; ++v) R.row_ptr[v + 1] += R.row_ptr[v];
+    R.col_ind.resize(R.row_ptr.back());
+    R.w.resize(R.row_ptr.back());
+    std::vector<long long> pos(R.row_ptr.begin(), R.row_ptr.end() - 1);
+    for(int u = 0; u < g.N; ++u)
+        g.for_each_out(u, [&](int v, float w){
+            long long k = pos[v]++;
+            R.col_ind[k] = u; R.w[k] = w;
+        });
+    return R;
+}
+
+// Bytes por peso más chicos que representan los pesos de g sin pérdida:
+// 1 (uint8), 2 (uint16) o 4 (float)
+int compact_weight_bytes(const CSR& g);
+
+// Lanzan runtime_error si el grafo no entra en la representación
+template<class W> CompactCSR<W> make_compact(const CSR& g);
+ImplicitGrid make_implicit_grid(const CSR& g); // grid de gen_grid con peso uniforme
@@ -0,0 +1,134 @@
+#include "utils.hpp"
+#include <queue>
+#include <limits>
+#include <cstdlib>
+
+/*
+  Jump Point Search (4-dir, pesos unitarios):
+  - Usa los metadatos de grid del CSR (rows, cols); la celda r*cols+c es
+    transitable si tiene aristas salientes (grado > 0)
+  - Solo expande "puntos de salto": celdas con vecino forzado, la meta o, en
+    saltos verticales, celdas desde las que un salto horizontal encuentra uno
+  - Min-heap por f = g + Manhattan; g se mide en celdas recorridas
+
+  Salida:
+    parent[v] : para las celdas del camino s->t, la celda anterior (camino
+                completo, así path_length/path_cost funcionan igual); para el
+                resto de puntos de salto, el punto de salto padre
+    return    : true si existe ruta s->t
+
+  Si el grafo no es un grid 4-dir con pesos 1 (ER, --diag8, --wmax>1) no hay
+  simetrías que podar y se delega en astar_run.
+*/
+
+namespace {
+
+struct JPSGrid {
+    int R, C;
+    std::vector<char> walk;
+    int tr, tc;
+
+    bool free(int r, int c) const {
+        return r >= 0 && r < R && c >= 0 && c < C && walk[(size_t)r*C + c];
+    }
+
+    // Salto horizontal desde (r,c) en dirección dc; id del punto de salto o -1
+    int jumpH(int r, int c, int dc) const {
+        for(;; c += dc){
+            if(!free(r, c)) return -1;
+            if(r == tr && c == tc) return r*C + c;
+            if((free(r-1, c) && !free(r-1, c-dc)) ||
+               (free(r+1, c) && !free(r+1, c-dc))) return r*C + c;
+        }
+    }
+
+    // Salto vertical desde (r,c) en dirección dr
+    int jumpV(int r, int c, int dr) const {
+        for(;; r += dr){
+            if(!free(r, c)) return -1;
+            if(r == tr && c == tc) return r*C + c;
+            if((free(r, c-1) && !free(r-dr, c-1)) ||
+               (free(r, c+1) && !free(r-dr, c+1))) return r*C + c;
+            // Al moverse en vertical hay que mirar los saltos horizontales
+            if(jumpH(r, c+1, 1) != -1 || jumpH(r, c-1, -1) != -1) return r*C + c;
+        }
+    }
+};
+
+bool is_unit_grid4(const CSR& g){
+    if(g.rows <= 0 || g.cols <= 0 || g.diag8) return false;
+    if(1LL*g.rows*g.cols != g.N) return false;
+    for(float w : g.w) if(w != 1.0f) return false;
+    return true;
+}
+
+inline int sgn(int x){ return (x > 0) - (x < 0); }
+
+} // namespace
+
+bool jps_run(const CSR& g, int s, int t, std::vector<int>& parent){
+    if(!is_unit_grid4(g)) return astar_run(g, s, t, parent);
+
+    parent.assign(g.N, -1);
+    if(s < 0 || s >= g.N || t < 0 || t >= g.N) return false;
+    if(s == t) return true;
+
+    JPSGrid G{g.rows, g.cols, std::vector<char>(g.N), t / g.cols, t % g.cols};
+    for(int u = 0; u < g.N; ++u) G.walk[u] = g.row_ptr[u+1] > g.row_ptr[u];
+
+    const int INF = std::numeric_limits<int>::max();
+    std::vector<int> gs(g.N, INF);
+    std::vector<char> closed(g.N, 0);
+
+    using P = std::pair<int,int>; // (f, nodo)
+    std::priority_queue<P, std::vector<P>, std::greater<P>> open;
+    auto h = [&](int r, int c){ return std::abs(r - G.tr) + std::abs(c - G.tc); };
+
+    gs[s] = 0;
+    open.push({h(s / g.cols, s % g.cols), s});
+
+    auto relax = [&](int u, int r, int c, int dr, int dc){
+        int v = dr ? G.jumpV(r + dr, c, dr) : G.jumpH(r, c + dc, dc);
+        if(v == -1 || closed[v]) return;
+        int vr = v / g.cols, vc = v % g.cols;
+        int ng = gs[u] + std::abs(vr - r) + std::abs(vc - c);
+        if(ng < gs[v]){
+            gs[v] = ng;
+            parent[v] = u;
+            open.push({ng + h(vr, vc), v});
+        }
+    };
+
+    while(!open.empty()){
+        auto [fu, u] = open.top(); open.pop();
+        if(closed[u]) continue;
+        closed[u] = 1;
+        if(u == t) break;
+
+        int r = u / g.cols, c = u % g.cols;
+        if(parent[u] == -1){
+            relax(u, r, c, -1, 0); relax(u, r, c, 1, 0);
+            relax(u, r, c, 0, -1); relax(u, r, c, 0, 1);
+            continue;
+        }
+        // Poda: seguir recto y abrir los dos laterales
+        int dr = sgn(r - parent[u] / g.cols), dc = sgn(c - parent[u] % g.cols);
+        if(dc){ relax(u, r, c, -1, 0); relax(u, r, c, 1, 0); relax(u, r, c, 0, dc); }
+        else  { relax(u, r, c, 0, -1); relax(u, r, c, 0, 1); relax(u, r, c, dr, 0); }
+    }
+    if(gs[t] == INF) return false;
+
+    // Rellenar los tramos rectos entre puntos de salto (de t hacia s)
+    for(int v = t; v != s; ){
+        int p = parent[v];
+        int dr = sgn(p / g.cols - v / g.cols), dc = sgn(p % g.cols - v % g.cols);
+        int cur = v;
+        while(cur != p){
+            int nxt = cur + dr*g.cols + dc;
+            parent[cur] = nxt;
+            cur = nxt;
+        }
+        v = p;
+    }
+    return true;
+}
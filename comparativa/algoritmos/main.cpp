@@ -1,8 +1,12 @@
 #include "utils.hpp"
+#include "workspace.hpp"
+#include "graphs.hpp"
 #include <iostream>
 #include <iomanip>
 #include <map>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -21,13 +25,62 @@ static void print_usage(){
     cerr <<
     "USO:\n"
     "  Generar grid:\n"
-    "    --mode=gen_grid --rows=R --cols=C --out=graph.bin [--diag8] [--wmin=1] [--wmax=1] [--seed=42]\n"
+    "    --mode=gen_grid --rows=R --cols=C --out=graph.bin [--diag8] [--wmin=1] [--wmax=1] [--seed=42] [--format=2]\n"
+    "               [--threads=N]\n"
     "  Generar ER (Erdos-Renyi):\n"
-    "    --mode=gen_er --N=N --M=M --out=graph.bin [--undirected] [--wmin=1] [--wmax=10] [--seed=42]\n"
+    "    --mode=gen_er --N=N --M=M --out=graph.bin [--undirected] [--wmin=1] [--wmax=10] [--seed=42] [--format=2]\n"
+    "               [--threads=N]\n"
+    "  (generadores en paralelo, mismo grafo con cualquier --threads; con\n"
+    "   --format=2 escriben el archivo por bloques sin armar el CSR en memoria)\n"
+    "  Generar mapa con obstáculos / terreno (grid de celdas, N = rows*cols):\n"
+    "    --mode=gen_map --type=random|maze|rooms|terrain --rows=R --cols=C --out=graph.bin\n"
+    "               [--obstacles=0.2] (random)  [--loops=0] (maze)  [--room=12] (rooms)\n"
+    "               [--max_cost=10] [--water=0.3] [--scale=max(R,C)/8] (terrain)\n"
+    "               [--diag8] [--seed=42] [--format=2] [--queries=q.txt --count=1000]\n"
+    "    --mode=gen_map --type=movingai --map=x.map --out=graph.bin [--queries=q.txt [--scen=x.scen]]\n"
+    "  (--queries: pares con ruta en la misma componente, o los del .scen con su\n"
+    "   longitud óptima como tercera columna; \"type octile\" implica --diag8)\n"
+    "  Convertir formato (v1 <-> v2):\n"
+    "    --mode=convert --in=graph.bin --out=graph2.bin [--format=2]\n"
+    "  (--format=2: cabecera + secciones alineadas, se puede mapear; 1: formato viejo)\n"
     "  Ejecutar:\n"
-    "    --mode=run --in=graph.bin --s=S --t=T --algos=dijkstra,astar,bmssp,dstar [--B=1e9]\n"
+    "    --mode=run --in=graph.bin --s=S --t=T --algos=dijkstra,astar,bmssp,bmssp_duan,dstar,jps,ch,bidijkstra,biastar,delta_par [--B=1e9]\n"
+    "               [--ch=graph.ch]   (CH: carga el preproceso o lo genera y guarda ahí)\n"
+    "               [--threads=N] [--delta=D]   (delta_par: hilos y ancho de cubeta)\n"
+    "               [--mmap]   (mapea un grafo v2 en vez de leerlo; la primera\n"
+    "                           consulta paga los fallos de página)\n"
+    "               [--graph=csr|compact|implicit]   (dijkstra/astar/bmssp/bmssp_duan/dstar: CSR,\n"
+    "                           CSR de offsets de 32 bits y pesos uint8/uint16, o\n"
+    "                           grid sin aristas; el resto usa siempre el CSR)\n"
+    "  Consultas en lote (pool de hilos, mismas --algos/--B/--ch/--delta):\n"
+    "    --mode=batch --in=graph.bin --queries=q.txt [--algos=...] [--threads=N]\n"
+    "               (q.txt: \"s t\" por línea; delta_par corre con 1 hilo por consulta)\n"
+    "  Escenario dinámico (agente moviéndose mientras cambian pesos):\n"
+    "    --mode=dynamic --in=graph.bin --s=S --t=T [--algos=dstar,dijkstra,astar]\n"
+    "               [--model=random|clustered|path] [--ticks=100] [--changes=10]\n"
+    "               [--step=1] [--factor=10] [--seed=42]\n"
+    "               (dstar repara incremental; dijkstra/astar/bmssp/bmssp_duan/\n"
+    "                delta_par/dstar_scratch replanifican de cero con el mismo flujo)\n"
+    "  Suite de benchmarks (warm-up + repeticiones, mismas --algos/--B/--ch/--graph):\n"
+    "    --mode=bench --in=g1.bin[,g2.bin...] [--queries=q1.txt[,q2.txt...]] [--count=1000] [--seed=42]\n"
+    "               [--warmup=1] [--reps=5] [--json=bench.json]\n"
+    "               (--queries: un archivo para todos los grafos o uno por grafo; sin\n"
+    "                él, --count pares aleatorios; --json: estadísticas, muestras,\n"
+    "                máquina, compilador y flags)\n"
+    "  Verificar costos contra Dijkstra (mismos grafos/consultas que bench):\n"
+    "    --mode=verify --in=g1.bin[,g2.bin...] [--queries=...] [--count=1000] [--algos=...]\n"
+    "               (código de salida 3 si alguna consulta difiere)\n"
+    "  Generar consultas aleatorias:\n"
+    "    --mode=gen_queries --in=graph.bin --count=K --out=q.txt [--seed=42]\n"
     "\n"
-    "Salida (CSV): algo,N,M,s,t,time_ms,path_len\n";
+    "Salida (CSV): algo,N,M,s,t,time_ms,path_len\n"
+    "  batch:      algo,N,M,queries,threads,ok,wall_ms,qps,p50_ms,p95_ms,p99_ms,max_ms\n"
+    "  dynamic:    algo,N,M,model,ticks,changes,ok,init_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,\n"
+    "              expanded,relaxed,cost   (expanded/relaxed: promedio por tick)\n"
+    "  bench:      algo,graph,N,M,queries,reps,ok,mean_ms,median_ms,stddev_ms,min_ms,max_ms,\n"
+    "              us_per_query,expanded,relaxed,cost,peak_rss_kb   (ms por pasada completa;\n"
+    "              us_per_query de la mediana; expanded/relaxed: promedio por consulta)\n"
+    "  verify:     algo,graph,N,M,queries,ok,mismatches,max_abs_err\n";
 }
 
 int main(int argc, char** argv){
@@ -54,12 +107,15 @@ int main(int argc, char** argv){
             float wmax = A.count("--wmax")? stof(A["--wmax"]) : 1.0f;
             unsigned seed = A.count("--seed")? (unsigned)stoul(A["--seed"]) : 42u;
             string out = A["--out"];
+            int format = A.count("--format")? stoi(A["--format"]) : 2;
+            int threads = A.count("--threads")? stoi(A["--threads"]) : 0;
 
-            CSR g = gen_grid(rows, cols, diag8, wmin, wmax, seed);
-            save_csr_bin(g, out);
+            Timer T; T.start();
+            if(format == 2) gen_grid_to_file(out, rows, cols, diag8, wmin, wmax, seed, threads);
+            else save_csr_bin(gen_grid(rows, cols, diag8, wmin, wmax, seed, threads), out, format);
             cerr << "OK grid " << rows << "x" << cols
                  << " diag8=" << (diag8?"yes":"no")
-                 << " -> " << out << "\n";
+                 << " -> " << out << " (" << fixed << setprecision(1) << T.ms() << " ms)\n";
             return 0;
 
         } else if(mode == "gen_er"){
@@ -73,64 +129,397 @@ int main(int argc, char** argv){
             float wmax = A.count("--wmax")? stof(A["--wmax"]) : 10.0f;
             unsigned seed = A.count("--seed")? (unsigned)stoul(A["--seed"]) : 42u;
             string out = A["--out"];
+            int format = A.count("--format")? stoi(A["--format"]) : 2;
+            int threads = A.count("--threads")? stoi(A["--threads"]) : 0;
 
-            CSR g = gen_er(N, M, wmin, wmax, seed, directed);
-            save_csr_bin(g, out);
+            Timer T; T.start();
+            if(format == 2) gen_er_to_file(out, N, M, wmin, wmax, seed, directed, threads);
+            else save_csr_bin(gen_er(N, M, wmin, wmax, seed, directed, threads), out, format);
             cerr << "OK ER N=" << N << " M=" << M
                  << " directed=" << (directed?"yes":"no")
-                 << " -> " << out << "\n";
+                 << " -> " << out << " (" << fixed << setprecision(1) << T.ms() << " ms)\n";
             return 0;
 
-        } else if(mode == "run"){
-            if(!A.count("--in") || !A.count("--s") || !A.count("--t")){
+        } else if(mode == "gen_map"){
+            string type = A.count("--type") ? A["--type"] : "";
+            bool movingai = (type == "movingai");
+            if(!A.count("--out") || (movingai ? !A.count("--map") : (!A.count("--rows") || !A.count("--cols")))){
                 print_usage(); return 1;
             }
-            string in = A["--in"];
-            int s = stoi(A["--s"]);
-            int t = stoi(A["--t"]);
+            unsigned seed = A.count("--seed")? (unsigned)stoul(A["--seed"]) : 42u;
+            bool diag8 = A.count("--diag8")>0;
+            int format = A.count("--format")? stoi(A["--format"]) : 2;
+
+            Timer T; T.start();
+            CellMap m;
+            if(movingai){
+                bool octile = false;
+                m = load_movingai_map(A["--map"], &octile);
+                diag8 = diag8 || octile;
+            } else {
+                int rows = stoi(A["--rows"]);
+                int cols = stoi(A["--cols"]);
+                if(type == "random")
+                    m = gen_map_random(rows, cols, A.count("--obstacles")? stod(A["--obstacles"]) : 0.2, seed);
+                else if(type == "maze")
+                    m = gen_map_maze(rows, cols, A.count("--loops")? stod(A["--loops"]) : 0.0, seed);
+                else if(type == "rooms")
+                    m = gen_map_rooms(rows, cols, A.count("--room")? stoi(A["--room"]) : 12, seed);
+                else if(type == "terrain")
+                    m = gen_map_terrain(rows, cols,
+                                        A.count("--max_cost")? stof(A["--max_cost"]) : 10.0f,
+                                        A.count("--water")? stod(A["--water"]) : 0.3,
+                                        A.count("--scale")? stof(A["--scale"]) : 0.0f, seed);
+                else { cerr << "gen_map: --type=random|maze|rooms|terrain|movingai\n"; return 1; }
+            }
+            CSR g = map_to_csr(m, diag8);
+            save_csr_bin(g, A["--out"], format);
+
+            long long blocked = count_if(m.cost.begin(), m.cost.end(), [](float c){ return c <= 0; });
+            cerr << "OK map " << type << " " << m.rows << "x" << m.cols
+                 << " diag8=" << (diag8?"yes":"no") << " blocked=" << blocked
+                 << " M=" << g.M << " -> " << A["--out"];
+
+            if(A.count("--queries")){
+                MapScenario sc;
+                if(A.count("--scen")) sc = load_movingai_scen(A["--scen"], m);
+                else sc = gen_map_scenario(g, A.count("--count")? stoi(A["--count"]) : 1000, seed);
+                save_scenario(sc, A["--queries"]);
+                cerr << ", " << sc.queries.size() << " consultas -> " << A["--queries"];
+            }
+            cerr << " (" << fixed << setprecision(1) << T.ms() << " ms)\n";
+            return 0;
+
+        } else if(mode == "convert"){
+            if(!A.count("--in") || !A.count("--out")){
+                print_usage(); return 1;
+            }
+            int format = A.count("--format")? stoi(A["--format"]) : 2;
+            CSR g = load_csr_bin(A["--in"]);
+            save_csr_bin(g, A["--out"], format);
+            cerr << "OK v" << csr_bin_version(A["--in"]) << " -> v" << format
+                 << " " << A["--out"] << "\n";
+            return 0;
+
+        } else if(mode == "gen_queries"){
+            if(!A.count("--in") || !A.count("--count") || !A.count("--out")){
+                print_usage(); return 1;
+            }
+            CSR g = A.count("--mmap") ? map_csr_bin(A["--in"]) : load_csr_bin(A["--in"]);
+            int count = stoi(A["--count"]);
+            unsigned seed = A.count("--seed")? (unsigned)stoul(A["--seed"]) : 42u;
+            save_queries(gen_queries(g.N, count, seed), A["--out"]);
+            cerr << "OK " << count << " consultas -> " << A["--out"] << "\n";
+            return 0;
+
+        } else if(mode == "run" || mode == "batch" || mode == "dynamic" || mode == "bench" || mode == "verify"){
+            bool batch = (mode == "batch");
+            bool dynamic = (mode == "dynamic");
+            bool verify = (mode == "verify");
+            bool bench = (mode == "bench") || verify; // verify usa los mismos grafos y consultas
+            if(!A.count("--in") || (!bench && (batch ? !A.count("--queries") : (!A.count("--s") || !A.count("--t"))))){
+                print_usage(); return 1;
+            }
+            auto split = [](const string& list){
+                vector<string> out;
+                stringstream ss(list); string x;
+                while(getline(ss,x,',')) if(!x.empty()) out.push_back(x);
+                return out;
+            };
+            // bench admite varios grafos; los demás modos, uno
+            vector<string> ins = bench ? split(A["--in"]) : vector<string>{A["--in"]};
             float B = A.count("--B") ? stof(A["--B"]) : 1e30f;
+            int threads = A.count("--threads") ? stoi(A["--threads"]) : 0;
+            float delta = A.count("--delta") ? stof(A["--delta"]) : 0.0f;
 
             // Lista de algoritmos (1 o varios separados por coma)
             vector<string> algos;
             if(A.count("--algos")){
-                string list = A["--algos"];
-                stringstream ss(list); string x;
-                while(getline(ss,x,',')) if(!x.empty()) algos.push_back(x);
+                algos = split(A["--algos"]);
             } else {
                 algos = {"dijkstra"}; // por defecto
             }
 
-            CSR g = load_csr_bin(in);
-            cout << "algo,N,M,s,t,time_ms,path_len\n";
-
-            for(const string& algo : algos){
-                vector<int> parent(g.N, -1);
-                Timer T; T.start();
-                bool ok = false;
-
-                if(algo=="dijkstra"){
-                    ok = dijkstra_run(g, s, t, parent);
-                } else if(algo=="astar"){
-                    ok = astar_run(g, s, t, parent);
-                } else if(algo=="bmssp"){
-                    ok = bmssp_run(g, s, t, B, parent);
-                } else if(algo=="dstar"){
-                    ok = dstar_lite_run_static(g, s, t, parent);
-                } else {
-                    cerr << "Algoritmo desconocido: " << algo << "\n";
+            // bench: consultas por grafo (una lista para todos o una por grafo;
+            // sin --queries se generan --count pares con --seed)
+            int warmup = A.count("--warmup") ? stoi(A["--warmup"]) : 1;
+            int reps   = A.count("--reps")   ? stoi(A["--reps"])   : 5;
+            int count  = A.count("--count")  ? stoi(A["--count"])  : 1000;
+            unsigned seed = A.count("--seed") ? (unsigned)stoul(A["--seed"]) : 42u;
+            vector<string> qsets = A.count("--queries") ? split(A["--queries"]) : vector<string>{""};
+            if(bench && qsets.size() != 1 && qsets.size() != ins.size())
+                throw runtime_error("--queries: una lista para todos los grafos o una por grafo");
+            vector<BenchCell> cells;
+            long long mismatches = 0;
+            if(verify)
+                cout << "algo,graph,N,M,queries,ok,mismatches,max_abs_err\n";
+            else if(bench)
+                cout << "algo,graph,N,M,queries,reps,ok,mean_ms,median_ms,stddev_ms,min_ms,max_ms,"
+                        "us_per_query,expanded,relaxed,cost,peak_rss_kb\n";
+
+            for(size_t gi = 0; gi < ins.size(); ++gi){
+                const string& in = ins[gi];
+                Timer L; L.start();
+                CSR g = A.count("--mmap") ? map_csr_bin(in) : load_csr_bin(in);
+                cerr << "Grafo v" << csr_bin_version(in) << " cargado en " << fixed << setprecision(1)
+                     << L.ms() << " ms" << (g.mapping ? " (mmap)" : "") << "\n";
+
+                // CH: el preproceso no entra en time_ms (solo la consulta)
+                CHGraph ch;
+                if(find(algos.begin(), algos.end(), "ch") != algos.end()){
+                    string chPath = A.count("--ch") ? A["--ch"] : "";
+                    if(!chPath.empty() && ifstream(chPath).good()){
+                        ch = load_ch_bin(chPath);
+                        if(ch.N != g.N) throw runtime_error("CH no corresponde al grafo: " + chPath);
+                        cerr << "CH cargado de " << chPath << "\n";
+                    } else {
+                        Timer P; P.start();
+                        ch = ch_build(g);
+                        cerr << "CH preproceso: " << fixed << setprecision(1) << P.ms() << " ms, "
+                             << ch.shortcuts << " atajos, núcleo de " << ch.core << " nodos\n";
+                        if(!chPath.empty()) save_ch_bin(ch, chPath);
+                    }
+                }
+
+                // Representación para los algoritmos templados (dijkstra, astar, bmssp[_duan], dstar):
+                // se arma una vez desde el CSR, fuera de time_ms
+                string graphKind = A.count("--graph") ? A["--graph"] : "csr";
+                if(dynamic && graphKind != "csr")
+                    throw runtime_error("--mode=dynamic cambia pesos: solo --graph=csr");
+                CompactCSR<float> c32; CompactCSR<uint16_t> c16; CompactCSR<uint8_t> c8;
+                ImplicitGrid ig;
+                size_t repBytes = g.bytes();
+                if(graphKind == "compact"){
+                    int wb = compact_weight_bytes(g);
+                    if(wb == 1){ c8 = make_compact<uint8_t>(g); repBytes = c8.bytes(); }
+                    else if(wb == 2){ c16 = make_compact<uint16_t>(g); repBytes = c16.bytes(); }
+                    else { c32 = make_compact<float>(g); repBytes = c32.bytes(); }
+                    graphKind += "/w" + to_string(8*wb);
+                } else if(graphKind == "implicit"){
+                    ig = make_implicit_grid(g);
+                    repBytes = ig.bytes();
+                } else if(graphKind != "csr"){
+                    throw runtime_error("--graph desconocido: " + graphKind);
+                }
+                if(graphKind != "csr")
+                    cerr << "Grafo " << graphKind << ": " << repBytes << " bytes (CSR: " << g.bytes() << ")\n";
+
+                // Bidireccionales: el grafo inverso se arma una vez, fuera de time_ms
+                ReverseCSR rg;
+                for(const string& a : algos)
+                    if(a == "bidijkstra" || a == "biastar"){ rg = build_reverse(g); break; }
+
+                // En batch el paralelismo lo pone el pool: delta_par corre con 1 hilo
+                int dpThreads = batch ? 1 : threads;
+
+                // Consulta s->t de cada algoritmo (vacía si no existe). Los que
+                // aceptan SearchWorkspace lo reutilizan y solo copian el camino.
+                auto with_ws = [](auto run) -> QueryFn {
+                    return [run](int s, int t, SearchWorkspace& ws, vector<int>& p){
+                        bool ok = run(s, t, ws);
+                        if(ok) ws.export_path(s, t, p);
+                        return ok;
+                    };
+                };
+                // run(G, s, t, ws) sobre la representación elegida con --graph
+                auto on_graph = [&](auto run) -> QueryFn {
+                    if(!c8.row_ptr.empty())  return with_ws([&, run](int s, int t, SearchWorkspace& ws){ return run(c8,  s, t, ws); });
+                    if(!c16.row_ptr.empty()) return with_ws([&, run](int s, int t, SearchWorkspace& ws){ return run(c16, s, t, ws); });
+                    if(!c32.row_ptr.empty()) return with_ws([&, run](int s, int t, SearchWorkspace& ws){ return run(c32, s, t, ws); });
+                    if(ig.N > 0)             return with_ws([&, run](int s, int t, SearchWorkspace& ws){ return run(ig,  s, t, ws); });
+                    return with_ws([&, run](int s, int t, SearchWorkspace& ws){ return run(g, s, t, ws); });
+                };
+                auto query_fn = [&](const string& algo) -> QueryFn {
+                    if(algo=="dijkstra")   return on_graph([](const auto& G, int s, int t, SearchWorkspace& ws){ return dijkstra_run(G, s, t, ws); });
+                    if(algo=="astar")      return on_graph([](const auto& G, int s, int t, SearchWorkspace& ws){ return astar_run(G, s, t, ws); });
+                    if(algo=="bmssp")      return on_graph([B](const auto& G, int s, int t, SearchWorkspace& ws){ return bmssp_run(G, s, t, B, ws); });
+                    if(algo=="bmssp_duan") return on_graph([](const auto& G, int s, int t, SearchWorkspace& ws){ return bmssp_duan_run(G, s, t, ws); });
+                    if(algo=="dstar")      return on_graph([](const auto& G, int s, int t, SearchWorkspace& ws){ return dstar_lite_run_static(G, s, t, ws); });
+                    if(algo=="jps")        return [&](int s, int t, SearchWorkspace&, vector<int>& p){ return jps_run(g, s, t, p); };
+                    if(algo=="ch")         return [&](int s, int t, SearchWorkspace&, vector<int>& p){ return ch_run(ch, s, t, p); };
+                    if(algo=="delta_par")  return with_ws([&, dpThreads](int s, int t, SearchWorkspace& ws){ return delta_stepping_par_run(g, s, t, dpThreads, delta, ws); });
+                    if(algo=="bidijkstra") return [&](int s, int t, SearchWorkspace&, vector<int>& p){ return bidijkstra_run(g, rg, s, t, p); };
+                    if(algo=="biastar")    return [&](int s, int t, SearchWorkspace&, vector<int>& p){ return biastar_run(g, rg, s, t, p); };
+                    return nullptr;
+                };
+
+                if(bench){
+                    const string& qfile = qsets.size() == 1 ? qsets[0] : qsets[gi];
+                    vector<Query> qs;
+                    if(qfile.empty()) qs = gen_queries(g.N, count, seed);
+                    else qs = load_queries(qfile);
+                    for(const Query& q : qs)
+                        if(q.s >= g.N || q.t >= g.N)
+                            throw runtime_error("Consulta fuera del grafo: " + to_string(q.s) + " " + to_string(q.t));
+                    string qname = qfile.empty() ? "gen:" + to_string(count) + ":" + to_string(seed) : qfile;
+
+                    // Costo de cada consulta contra Dijkstra
+                    if(verify){
+                        QueryFn ref = query_fn("dijkstra");
+                        for(const string& algo : algos){
+                            QueryFn fn = query_fn(algo);
+                            if(!fn){ cerr << "Algoritmo desconocido: " << algo << "\n"; continue; }
+                            VerifyResult r = verify_queries(g, qs, ref, fn);
+                            mismatches += r.mismatches;
+                            cout << algo << ","
+                                 << in << ","
+                                 << g.N << ","
+                                 << g.M << ","
+                                 << r.queries << ","
+                                 << r.ok << ","
+                                 << r.mismatches << ","
+                                 << fixed << setprecision(6) << r.max_abs_err << "\n";
+                            for(const string& m : r.examples) cerr << algo << ": " << m << "\n";
+                        }
+                        continue;
+                    }
+
+                    for(const string& algo : algos){
+                        QueryFn fn = query_fn(algo);
+                        if(!fn){ cerr << "Algoritmo desconocido: " << algo << "\n"; continue; }
+
+                        BenchCell c{in, qname, algo, g.N, g.M, run_bench(g, qs, warmup, reps, fn)};
+                        const BenchStats& r = c.stats;
+                        double perQuery = r.queries > 0 ? 1000.0 * r.median_ms / (double)r.queries : 0.0;
+                        cout << algo << ","
+                             << in << ","
+                             << g.N << ","
+                             << g.M << ","
+                             << r.queries << ","
+                             << r.reps << ","
+                             << r.ok << ","
+                             << fixed << setprecision(3) << r.mean_ms << ","
+                             << r.median_ms << ","
+                             << r.stddev_ms << ","
+                             << r.min_ms << ","
+                             << r.max_ms << ","
+                             << perQuery << ","
+                             << setprecision(1) << r.expanded << ","
+                             << r.relaxed << ","
+                             << setprecision(3) << r.cost << ","
+                             << r.peak_rss_kb << "\n";
+                        cells.push_back(move(c));
+                    }
                     continue;
                 }
 
-                double ms = T.ms();
-                int plen = ok ? path_length(s, t, parent) : 0;
+                if(dynamic){
+                    int s = stoi(A["--s"]);
+                    int t = stoi(A["--t"]);
+                    string model = A.count("--model") ? A["--model"] : "random";
+                    int ticks   = A.count("--ticks")   ? stoi(A["--ticks"])   : 100;
+                    int changes = A.count("--changes") ? stoi(A["--changes"]) : 10;
+                    int step    = A.count("--step")    ? stoi(A["--step"])    : 1;
+                    float factor = A.count("--factor") ? stof(A["--factor"]) : 10.0f;
+                    unsigned seed = A.count("--seed") ? (unsigned)stoul(A["--seed"]) : 42u;
+                    if(!A.count("--algos")) algos = {"dstar", "dijkstra", "astar"};
+
+                    Timer S; S.start();
+                    DynamicStream st = gen_dynamic_stream(g, s, t, model, ticks, changes, step, factor, seed);
+                    cerr << "Flujo " << model << ": " << st.ticks.size() << " ticks x " << changes
+                         << " cambios (" << fixed << setprecision(1) << S.ms() << " ms)\n";
+
+                    cout << "algo,N,M,model,ticks,changes,ok,init_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,"
+                            "expanded,relaxed,cost\n";
+                    for(const string& algo : algos){
+                        // Los preprocesos (CH, grafo inverso con pesos) quedarían viejos
+                        static const vector<string> scratch = {"dijkstra", "astar", "bmssp", "bmssp_duan", "delta_par"};
+                        DynamicResult r;
+                        if(algo == "dstar"){
+                            r = run_dynamic_dstar(g, st);
+                        } else if(algo == "dstar_scratch"){
+                            r = run_dynamic_scratch(g, st, query_fn("dstar"));
+                        } else if(find(scratch.begin(), scratch.end(), algo) != scratch.end()){
+                            r = run_dynamic_scratch(g, st, query_fn(algo));
+                        } else {
+                            cerr << "Algoritmo no soportado en --mode=dynamic: " << algo << "\n";
+                            continue;
+                        }
+                        cout << algo << ","
+                             << g.N << ","
+                             << g.M << ","
+                             << model << ","
+                             << r.ticks << ","
+                             << changes << ","
+                             << r.ok << ","
+                             << fixed << setprecision(3) << r.init_ms << ","
+                             << r.mean_ms << ","
+                             << r.p50 << ","
+                             << r.p95 << ","
+                             << r.p99 << ","
+                             << r.max_ms << ","
+                             << setprecision(1) << r.expanded << ","
+                             << r.relaxed << ","
+                             << setprecision(3) << r.cost << "\n";
+                    }
+                    return 0;
+                }
+
+                if(batch){
+                    vector<Query> qs = load_queries(A["--queries"]);
+                    for(const Query& q : qs)
+                        if(q.s >= g.N || q.t >= g.N)
+                            throw runtime_error("Consulta fuera del grafo: " + to_string(q.s) + " " + to_string(q.t));
+
+                    cout << "algo,N,M,queries,threads,ok,wall_ms,qps,p50_ms,p95_ms,p99_ms,max_ms\n";
+                    for(const string& algo : algos){
+                        QueryFn fn = query_fn(algo);
+                        if(!fn){ cerr << "Algoritmo desconocido: " << algo << "\n"; continue; }
+
+                        BatchResult r = run_batch(g.N, qs, threads, fn);
+                        cout << algo << ","
+                             << g.N << ","
+                             << g.M << ","
+                             << r.queries << ","
+                             << r.threads << ","
+                             << r.ok << ","
+                             << fixed << setprecision(3) << r.wall_ms << ","
+                             << setprecision(1) << r.qps << ","
+                             << setprecision(3) << r.p50 << ","
+                             << r.p95 << ","
+                             << r.p99 << ","
+                             << r.max_ms << "\n";
+                    }
+                    return 0;
+                }
+
+                int s = stoi(A["--s"]);
+                int t = stoi(A["--t"]);
+                SearchWorkspace ws;
+                cout << "algo,N,M,s,t,time_ms,path_len\n";
+
+                for(const string& algo : algos){
+                    QueryFn fn = query_fn(algo);
+                    if(!fn){ cerr << "Algoritmo desconocido: " << algo << "\n"; continue; }
+
+                    vector<int> parent(g.N, -1);
+                    Timer T; T.start();
+                    bool ok = fn(s, t, ws, parent);
+                    double ms = T.ms();
+                    int plen = ok ? path_length(s, t, parent) : 0;
+
+                    cout << algo << ","
+                         << g.N << ","
+                         << g.M << ","
+                         << s << ","
+                         << t << ","
+                         << fixed << setprecision(3) << ms << ","
+                         << plen << "\n";
+                    // bmssp: nodos particionados por nivel de recursión
+                    if(!ws.levelTouched.empty()){
+                        cerr << algo << ": tocados por nivel";
+                        for(long long n : ws.levelTouched) cerr << " " << n;
+                        cerr << "\n";
+                        ws.levelTouched.clear();
+                    }
+                }
+                return 0;
+            }
 
-                cout << algo << ","
-                     << g.N << ","
-                     << g.M << ","
-                     << s << ","
-                     << t << ","
-                     << fixed << setprecision(3) << ms << ","
-                     << plen << "\n";
+            if(verify) return mismatches ? 3 : 0;
+            if(A.count("--json")){
+                save_bench_json(A["--json"], bench_machine(), cells);
+                cerr << "OK " << cells.size() << " celdas -> " << A["--json"] << "\n";
             }
             return 0;
 
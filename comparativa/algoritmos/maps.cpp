@@ -0,0 +1,351 @@
+#include "utils.hpp"
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+
+/*
+  Mapas de celdas para el harness CSR (--mode=gen_map):
+
+  - random : obstáculos independientes con probabilidad --obstacles
+  - maze   : laberinto perfecto (DFS con pila) de pasillos de 1 celda;
+             --loops abre esa fracción de paredes internas para formar ciclos
+  - rooms  : habitaciones rectangulares que no se solapan, unidas en cadena
+             por pasillos en L (todo queda conectado)
+  - terrain: ruido de gradiente (Perlin) en varias octavas -> costo de entrar
+             a la celda en [1, --max_cost]; por debajo de --water es agua
+             (bloqueada)
+  - movingai: .map / .scen del benchmark de MovingAI (Sturtevant 2012)
+
+  map_to_csr deja rows*cols nodos (las celdas bloqueadas quedan sin aristas,
+  como espera jps) con coordenadas para la heurística. Peso de u->v = costo
+  de v, por √2 en diagonal; en 8-dir no se cortan esquinas, que es la
+  convención de MovingAI (sus longitudes óptimas salen iguales).
+*/
+
+namespace {
+
+inline bool inside(const CellMap& m, int r, int c){ return r >= 0 && r < m.rows && c >= 0 && c < m.cols; }
+inline int  cell(const CellMap& m, int r, int c){ return r * m.cols + c; }
+
+CellMap blank(int rows, int cols, float cost){
+    if(rows <= 0 || cols <= 0) throw std::runtime_error("gen_map: --rows y --cols deben ser > 0");
+    CellMap m;
+    m.rows = rows; m.cols = cols;
+    m.cost.assign((size_t)rows * cols, cost);
+    return m;
+}
+
+// -------- Ruido de gradiente 2D (Perlin) --------
+// Gradiente unitario por vértice de la red, elegido por hash de (x, y, seed)
+struct Perlin {
+    uint32_t seed;
+
+    static uint32_t hash(uint32_t x){
+        x ^= x >> 16; x *= 0x7feb352du;
+        x ^= x >> 15; x *= 0x846ca68bu;
+        return x ^ (x >> 16);
+    }
+    float grad(int ix, int iy, float dx, float dy) const {
+        uint32_t h = hash((uint32_t)ix * 0x27d4eb2du ^ hash((uint32_t)iy + seed));
+        float a = (float)(h & 0xffff) * (6.2831853f / 65536.0f);
+        return std::cos(a) * dx + std::sin(a) * dy;
+    }
+    static float fade(float t){ return t * t * t * (t * (t * 6 - 15) + 10); }
+
+    // Aproximadamente en [-1, 1]
+    float at(float x, float y) const {
+        int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+        float fx = x - x0, fy = y - y0;
+        float u = fade(fx), v = fade(fy);
+        float n00 = grad(x0, y0, fx, fy),       n10 = grad(x0 + 1, y0, fx - 1, fy);
+        float n01 = grad(x0, y0 + 1, fx, fy - 1), n11 = grad(x0 + 1, y0 + 1, fx - 1, fy - 1);
+        float a = n00 + u * (n10 - n00), b = n01 + u * (n11 - n01);
+        return (a + v * (b - a)) * 1.41421356f;
+    }
+
+    // fBm: 'octaves' capas, cada una al doble de frecuencia y mitad de amplitud
+    float fbm(float x, float y, int octaves) const {
+        float sum = 0, amp = 1, norm = 0;
+        for(int o = 0; o < octaves; ++o){
+            sum += amp * at(x, y);
+            norm += amp;
+            amp *= 0.5f; x *= 2; y *= 2;
+        }
+        return sum / norm;
+    }
+};
+
+// Etiqueta de componente conexa de cada celda libre (-1 si bloqueada)
+std::vector<int> components(const CSR& g){
+    std::vector<int> comp(g.N, -1), stack;
+    int next = 0;
+    for(int s = 0; s < g.N; ++s){
+        if(comp[s] != -1 || g.row_ptr[s + 1] == g.row_ptr[s]) continue;
+        comp[s] = next;
+        stack.push_back(s);
+        while(!stack.empty()){
+            int u = stack.back(); stack.pop_back();
+            g.for_each_out(u, [&](int v, float){ if(comp[v] == -1){ comp[v] = next; stack.push_back(v); } });
+        }
+        ++next;
+    }
+    return comp;
+}
+
+std::string trim(const std::string& s){
+    size_t a = s.find_first_not_of(" \t\r\n"), b = s.find_last_not_of(" \t\r\n");
+    return a == std::string::npos ? "" : s.substr(a, b - a + 1);
+}
+
+} // namespace
+
+// -------------------- Generadores --------------------
+CellMap gen_map_random(int rows, int cols, double obstacles, unsigned seed){
+    CellMap m = blank(rows, cols, 1.0f);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> U(0.0, 1.0);
+    for(float& c : m.cost) if(U(rng) < obstacles) c = 0.0f;
+    return m;
+}
+
+CellMap gen_map_maze(int rows, int cols, double loops, unsigned seed){
+    CellMap m = blank(rows, cols, 0.0f);
+    std::mt19937 rng(seed);
+    // Celdas del laberinto en (impar, impar); las paredes entre ellas se abren
+    const int R = (rows - 1) / 2, C = (cols - 1) / 2;
+    if(R <= 0 || C <= 0) return m;
+    std::vector<char> seen((size_t)R * C, 0);
+    std::vector<int> stack = {0};
+    seen[0] = 1;
+    m.cost[cell(m, 1, 1)] = 1.0f;
+    const int DR[4] = {-1, 1, 0, 0}, DC[4] = {0, 0, -1, 1};
+    while(!stack.empty()){
+        int k = stack.back(), r = k / C, c = k % C;
+        int opts[4], n = 0;
+        for(int d = 0; d < 4; ++d){
+            int nr = r + DR[d], nc = c + DC[d];
+            if(nr >= 0 && nr < R && nc >= 0 && nc < C && !seen[nr * C + nc]) opts[n++] = d;
+        }
+        if(n == 0){ stack.pop_back(); continue; }
+        int d = opts[rng() % n], nr = r + DR[d], nc = c + DC[d];
+        seen[nr * C + nc] = 1;
+        m.cost[cell(m, 2*r + 1 + DR[d], 2*c + 1 + DC[d])] = 1.0f; // pared intermedia
+        m.cost[cell(m, 2*nr + 1, 2*nc + 1)] = 1.0f;
+        stack.push_back(nr * C + nc);
+    }
+    // Ciclos: paredes internas entre dos pasillos (en línea recta)
+    if(loops > 0){
+        std::uniform_real_distribution<double> U(0.0, 1.0);
+        for(int r = 1; r < rows - 1; ++r) for(int c = 1; c < cols - 1; ++c){
+            if(m.cost[cell(m, r, c)] > 0 || ((r & 1) == (c & 1))) continue;
+            bool vert = (r & 1) == 0; // une (r-1, c) con (r+1, c)
+            int a = vert ? cell(m, r - 1, c) : cell(m, r, c - 1);
+            int b = vert ? cell(m, r + 1, c) : cell(m, r, c + 1);
+            if(m.cost[a] > 0 && m.cost[b] > 0 && U(rng) < loops) m.cost[cell(m, r, c)] = 1.0f;
+        }
+    }
+    return m;
+}
+
+CellMap gen_map_rooms(int rows, int cols, int roomSize, unsigned seed){
+    CellMap m = blank(rows, cols, 0.0f);
+    std::mt19937 rng(seed);
+    roomSize = std::max(3, std::min(roomSize, std::min(rows, cols) - 2));
+    if(roomSize < 3) return m;
+    std::uniform_int_distribution<int> S(std::max(3, roomSize / 2), roomSize);
+
+    struct Room { int r0, c0, r1, c1; };
+    std::vector<Room> rooms;
+    // Intentos proporcionales al área: se descartan los que se solapan (con margen)
+    long long tries = std::max(16LL, 4LL * rows * cols / (1LL * roomSize * roomSize));
+    for(long long i = 0; i < tries; ++i){
+        int h = S(rng), w = S(rng);
+        if(h > rows - 2 || w > cols - 2) continue;
+        int r0 = 1 + (int)(rng() % (rows - h - 1)), c0 = 1 + (int)(rng() % (cols - w - 1));
+        Room n{r0, c0, r0 + h, c0 + w};
+        bool ok = true;
+        for(const Room& o : rooms)
+            if(n.r0 <= o.r1 + 1 && o.r0 <= n.r1 + 1 && n.c0 <= o.c1 + 1 && o.c0 <= n.c1 + 1){ ok = false; break; }
+        if(!ok) continue;
+        rooms.push_back(n);
+        for(int r = n.r0; r < n.r1; ++r) for(int c = n.c0; c < n.c1; ++c) m.cost[cell(m, r, c)] = 1.0f;
+    }
+    // Pasillo en L del centro de cada habitación al de la anterior
+    auto carve = [&](int r0, int c0, int r1, int c1){
+        bool rowFirst = rng() & 1;
+        int r = r0, c = c0;
+        auto step = [&](int& x, int to){ while(x != to){ m.cost[cell(m, r, c)] = 1.0f; x += (to > x) ? 1 : -1; } };
+        if(rowFirst){ step(r, r1); step(c, c1); } else { step(c, c1); step(r, r1); }
+        m.cost[cell(m, r1, c1)] = 1.0f;
+    };
+    for(size_t i = 1; i < rooms.size(); ++i){
+        const Room &a = rooms[i - 1], &b = rooms[i];
+        carve((a.r0 + a.r1) / 2, (a.c0 + a.c1) / 2, (b.r0 + b.r1) / 2, (b.c0 + b.c1) / 2);
+    }
+    return m;
+}
+
+CellMap gen_map_terrain(int rows, int cols, float maxCost, double water, float scale, unsigned seed){
+    CellMap m = blank(rows, cols, 1.0f);
+    Perlin P{seed};
+    if(!(scale > 0)) scale = std::max(rows, cols) / 8.0f;
+    maxCost = std::max(1.0f, maxCost);
+    for(int r = 0; r < rows; ++r) for(int c = 0; c < cols; ++c){
+        float n = 0.5f + 0.5f * P.fbm(c / scale, r / scale, 5); // ~[0, 1]
+        n = std::min(1.0f, std::max(0.0f, n));
+        // Costo entero: las colas por cubetas siguen aplicando
+        m.cost[cell(m, r, c)] = n < water ? 0.0f : std::round(1.0f + (maxCost - 1.0f) * n);
+    }
+    return m;
+}
+
+// -------------------- MovingAI --------------------
+CellMap load_movingai_map(const std::string& path, bool* octile){
+    std::ifstream f(path);
+    if(!f) throw std::runtime_error("No se puede abrir para leer: " + path);
+    auto bad = [&](const std::string& why){ throw std::runtime_error("Mapa MovingAI inválido (" + why + "): " + path); };
+
+    int rows = -1, cols = -1;
+    std::string line, type;
+    while(std::getline(f, line)){
+        std::istringstream in(line);
+        std::string key;
+        in >> key;
+        if(key == "type") in >> type;
+        else if(key == "height") in >> rows;
+        else if(key == "width") in >> cols;
+        else if(key == "map") break;
+        else if(!key.empty()) bad("cabecera: " + key);
+    }
+    if(rows <= 0 || cols <= 0) bad("height/width");
+    if(octile) *octile = (type == "octile");
+
+    CellMap m = blank(rows, cols, 0.0f);
+    for(int r = 0; r < rows; ++r){
+        if(!std::getline(f, line)) bad("faltan filas");
+        line = trim(line);
+        if((int)line.size() < cols) bad("fila " + std::to_string(r) + " corta");
+        for(int c = 0; c < cols; ++c){
+            char ch = line[c];
+            // '.' y 'G' terreno, 'S' pantano (transitable); '@' 'O' 'T' 'W' no
+            if(ch == '.' || ch == 'G' || ch == 'S') m.cost[cell(m, r, c)] = 1.0f;
+        }
+    }
+    return m;
+}
+
+MapScenario load_movingai_scen(const std::string& path, const CellMap& m){
+    std::ifstream f(path);
+    if(!f) throw std::runtime_error("No se puede abrir para leer: " + path);
+    MapScenario sc;
+    std::string line;
+    long long ln = 0;
+    while(std::getline(f, line)){
+        ++ln;
+        if(trim(line).empty() || line.rfind("version", 0) == 0) continue;
+        // bucket  mapa  ancho  alto  sx  sy  gx  gy  óptimo   (tabs)
+        std::istringstream in(line);
+        std::string bucket, name;
+        int w, h, sx, sy, gx, gy;
+        double opt;
+        if(!(in >> bucket >> name >> w >> h >> sx >> sy >> gx >> gy >> opt))
+            throw std::runtime_error("Escenario inválido en " + path + ":" + std::to_string(ln));
+        if(w != m.cols || h != m.rows)
+            throw std::runtime_error("El escenario no es de este mapa (" + std::to_string(w) + "x" + std::to_string(h)
+                                     + "): " + path + ":" + std::to_string(ln));
+        if(!inside(m, sy, sx) || !inside(m, gy, gx))
+            throw std::runtime_error("Celda fuera del mapa en " + path + ":" + std::to_string(ln));
+        sc.queries.push_back({cell(m, sy, sx), cell(m, gy, gx)});
+        sc.optimal.push_back(opt);
+    }
+    return sc;
+}
+
+// -------------------- CSR y escenarios --------------------
+CSR map_to_csr(const CellMap& m, bool diag8){
+    static const int DR[8] = { 1,-1, 0, 0, 1, 1,-1,-1};
+    static const int DC[8] = { 0, 0, 1,-1, 1,-1, 1,-1};
+    const int dirs = diag8 ? 8 : 4;
+    const long long N = 1LL * m.rows * m.cols;
+    if(N > (long long)INT32_MAX) throw std::runtime_error("map_to_csr: el mapa no entra en ids de 32 bits");
+    auto freeAt = [&](int r, int c){ return inside(m, r, c) && m.cost[cell(m, r, c)] > 0; };
+
+    // Mismo orden de vecinos que gen_grid; en diagonal ambos lados deben estar libres
+    auto each = [&](int r, int c, auto f){
+        if(!freeAt(r, c)) return;
+        for(int d = 0; d < dirs; ++d){
+            int rr = r + DR[d], cc = c + DC[d];
+            if(!freeAt(rr, cc)) continue;
+            if(d >= 4 && (!freeAt(r + DR[d], c) || !freeAt(r, c + DC[d]))) continue;
+            float w = m.cost[cell(m, rr, cc)];
+            f(cell(m, rr, cc), d >= 4 ? w * 1.41421356f : w);
+        }
+    };
+
+    CSR g; g.N = (int)N;
+    g.row_ptr.assign((size_t)N + 1, 0);
+    for(int r = 0; r < m.rows; ++r) for(int c = 0; c < m.cols; ++c){
+        long long deg = 0;
+        each(r, c, [&](int, float){ ++deg; });
+        g.row_ptr[cell(m, r, c) + 1] = deg;
+    }
+    for(long long u = 0; u < N; ++u) g.row_ptr[u + 1] += g.row_ptr[u];
+    g.M = g.row_ptr[N];
+    g.col_ind.resize(g.M);
+    g.w.resize(g.M);
+    for(int r = 0; r < m.rows; ++r) for(int c = 0; c < m.cols; ++c){
+        long long e = g.row_ptr[cell(m, r, c)];
+        each(r, c, [&](int v, float w){ g.col_ind[e] = v; g.w[e] = w; ++e; });
+    }
+
+    g.has_coords = true;
+    g.x.resize(N); g.y.resize(N);
+    for(int r = 0; r < m.rows; ++r) for(int c = 0; c < m.cols; ++c){
+        g.x[cell(m, r, c)] = (float)c;
+        g.y[cell(m, r, c)] = (float)r;
+    }
+    g.rows = m.rows; g.cols = m.cols; g.diag8 = diag8;
+    classify_weights(g);
+    return g;
+}
+
+MapScenario gen_map_scenario(const CSR& g, int count, unsigned seed){
+    MapScenario sc;
+    std::vector<int> comp = components(g);
+    // Celdas libres agrupadas por componente: s al azar, t al azar en la suya
+    std::vector<int> cells;
+    for(int u = 0; u < g.N; ++u) if(comp[u] >= 0) cells.push_back(u);
+    if(cells.empty() || count <= 0) return sc;
+    std::stable_sort(cells.begin(), cells.end(), [&](int a, int b){ return comp[a] < comp[b]; });
+    int nc = comp[cells.back()] + 1;
+    std::vector<int> first(nc + 1, 0);
+    for(int u : cells) first[comp[u] + 1]++;
+    std::partial_sum(first.begin(), first.end(), first.begin());
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> U(0, cells.size() - 1);
+    sc.queries.reserve(count);
+    for(int i = 0; i < count; ++i){
+        int s = cells[U(rng)], k = comp[s];
+        int t = cells[first[k] + (int)(rng() % (unsigned)(first[k + 1] - first[k]))];
+        sc.queries.push_back({s, t});
+    }
+    return sc;
+}
+
+void save_scenario(const MapScenario& sc, const std::string& path){
+    std::ofstream f(path);
+    if(!f) throw std::runtime_error("No se puede abrir para escribir: " + path);
+    if(!sc.optimal.empty()) f << "# s t óptimo (MovingAI)\n";
+    f.precision(8);
+    for(size_t i = 0; i < sc.queries.size(); ++i){
+        f << sc.queries[i].s << ' ' << sc.queries[i].t;
+        if(i < sc.optimal.size()) f << ' ' << sc.optimal[i];
+        f << '\n';
+    }
+}
@@ -12,6 +12,10 @@ SEED=${SEED:-42}
 WMIN=${WMIN:-1}
 WMAX=${WMAX:-1}
 MARGIN_PCT=${MARGIN_PCT:-1.0} # B = OPT*(1+MARGIN_PCT/100)
+REPS=${REPS:-0}       # > 0: además, suite con repeticiones (--mode=bench)
+WARMUP=${WARMUP:-1}
+QUERIES=${QUERIES:-200} # consultas aleatorias de la suite
+JSON=${JSON:-bench.json}
 
 # Admite flags tipo --rows=..., --cols=..., --nodes=..., etc. (opcional)
 for a in "$@"; do
@@ -26,6 +30,10 @@ for a in "$@"; do
   --wmin=*) WMIN="${a#*=}" ;;
   --wmax=*) WMAX="${a#*=}" ;;
   --margin-pct=*) MARGIN_PCT="${a#*=}" ;;
+  --reps=*) REPS="${a#*=}" ;;
+  --warmup=*) WARMUP="${a#*=}" ;;
+  --queries=*) QUERIES="${a#*=}" ;;
+  --json=*) JSON="${a#*=}" ;;
   *)
     echo "Opción desconocida: $a"
     exit 2
@@ -48,12 +56,13 @@ fi
 GRAPH="grid_${ROWS}x${COLS}${DIAG8:+_8}.bin"
 BIN=bench
 CXX=${CXX:-g++}
-CXXFLAGS="-O3 -march=native -DNDEBUG -std=c++17"
+# bucket_queue.hpp es la de los motores del backend (una sola copia)
+CXXFLAGS="-O3 -march=native -DNDEBUG -std=c++17 -pthread -I../../backend/engines"
 
 # -------- Compilar --------
 echo "[1/3] Compilando..."
-$CXX $CXXFLAGS -o "$BIN" \
-  main.cpp utils.cpp dijkstra.cpp astar.cpp bmssp.cpp dstar_lite.cpp
+$CXX $CXXFLAGS -DBENCH_CXXFLAGS="\"$CXXFLAGS\"" -o "$BIN" \
+  main.cpp utils.cpp dijkstra.cpp astar.cpp bmssp.cpp bmssp_duan.cpp dstar_lite.cpp jps.cpp ch.cpp bidir.cpp delta_par.cpp batch.cpp graphs.cpp dynamic.cpp maps.cpp suite.cpp
 
 # -------- Generar grafo si no existe --------
 if [[ ! -f "$GRAPH" ]]; then
@@ -85,3 +94,12 @@ T=$((ROWS * COLS - 1))
 echo "[3/3] Ejecutando (diag8=${DIAG8}, w=[${WMIN},${WMAX}], B=${B}, seed=${SEED})"
 echo "algo,N,M,s,t,time_ms,path_len"
 ./"$BIN" --mode=run --in="$GRAPH" --s="$S" --t="$T" --algos="$ALGS" --B="$B" | tail -n +2
+
+# -------- Suite (opcional) --------
+# Mismo grafo, QUERIES pares aleatorios, WARMUP + REPS pasadas por algoritmo;
+# estadísticas en CSV y reporte con máquina y flags en $JSON
+if [[ "$REPS" -gt 0 ]]; then
+  echo "[4/4] Suite: ${QUERIES} consultas, warmup=${WARMUP}, reps=${REPS} -> ${JSON}"
+  ./"$BIN" --mode=bench --in="$GRAPH" --count="$QUERIES" --seed="$SEED" --algos="$ALGS" --B="$B" \
+    --warmup="$WARMUP" --reps="$REPS" --json="$JSON"
+fi
@@ -0,0 +1,234 @@
+#include "utils.hpp"
+#include "workspace.hpp"
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+/*
+  Suite de benchmarks (--mode=bench): cada celda (grafo, consultas, algoritmo)
+  corre 'warmup' pasadas descartadas y luego 'reps' pasadas medidas del
+  conjunto completo de consultas, en un solo hilo y con un workspace
+  reutilizado (como una consulta "caliente" del batch). El tiempo de cada
+  pasada es una muestra; con varias se puede distinguir una regresión del
+  ruido de la máquina.
+
+  - expanded / relaxed (promedio por consulta), ok y cost (suma de costos,
+    sirve de control de resultados) salen de una pasada previa sin medir;
+    expanded/relaxed = 0 si el algoritmo no los cuenta en SearchWorkspace
+    (jps, ch, bidireccionales, delta_par)
+  - peak_rss_kb: pico de memoria residente durante la celda. En Linux se
+    reinicia VmHWM antes de cada celda (/proc/self/clear_refs); si no se
+    puede, queda el máximo del proceso (getrusage), que solo crece
+  - El JSON lleva además la máquina (CPU, núcleos, kernel, governor) y el
+    build (compilador y flags, ver BENCH_CXXFLAGS en run.sh)
+*/
+
+#ifndef BENCH_CXXFLAGS
+#define BENCH_CXXFLAGS ""
+#endif
+
+namespace {
+
+std::string read_first(const std::string& path){
+    std::ifstream f(path);
+    std::string s;
+    if(f) std::getline(f, s);
+    return s;
+}
+
+// Valor de "clave : valor" en archivos tipo /proc (vacío si no está)
+std::string proc_field(const std::string& path, const std::string& key){
+    std::ifstream f(path);
+    std::string line;
+    while(std::getline(f, line)){
+        if(line.compare(0, key.size(), key) != 0) continue;
+        size_t p = line.find(':');
+        if(p == std::string::npos) continue;
+        size_t a = line.find_first_not_of(" \t", p + 1);
+        return a == std::string::npos ? "" : line.substr(a);
+    }
+    return "";
+}
+
+std::string json_str(const std::string& s){
+    std::string o = "\"";
+    for(unsigned char c : s){
+        if(c == '"' || c == '\\'){ o += '\\'; o += (char)c; }
+        else if(c == '\n') o += "\\n";
+        else if(c == '\t') o += "\\t";
+        else if(c < 0x20){ char b[8]; snprintf(b, sizeof b, "\\u%04x", c); o += b; }
+        else o += (char)c;
+    }
+    return o + "\"";
+}
+
+std::string json_num(double x){
+    if(!std::isfinite(x)) return "null";
+    std::ostringstream o;
+    o.precision(6);
+    o << x;
+    return o.str();
+}
+
+} // namespace
+
+void reset_peak_rss(){
+    std::ofstream f("/proc/self/clear_refs");
+    if(f) f << "5"; // 5: reinicia VmHWM (Linux >= 4.0)
+}
+
+long peak_rss_kb(){
+    std::string hwm = proc_field("/proc/self/status", "VmHWM");
+    if(!hwm.empty()) return std::stol(hwm);
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024; // bytes en macOS
+#else
+    return ru.ru_maxrss;
+#endif
+}
+
+BenchStats run_bench(const CSR& g, const std::vector<Query>& qs, int warmup, int reps, const QueryFn& fn){
+    BenchStats r;
+    r.warmup = std::max(0, warmup);
+    r.reps = std::max(1, reps);
+    r.queries = (long long)qs.size();
+
+    reset_peak_rss();
+    SearchWorkspace ws;
+    std::vector<int> parent(g.N, -1);
+
+    // Pasada de control sin medir: contadores, rutas encontradas y costo
+    for(const Query& q : qs){
+        bool ok = fn(q.s, q.t, ws, parent);
+        r.expanded += (double)ws.expanded;
+        r.relaxed  += (double)ws.relaxed;
+        if(ok){ ++r.ok; r.cost += path_cost(q.s, q.t, g, parent); }
+    }
+    for(int k = 0; k < r.warmup; ++k)
+        for(const Query& q : qs) fn(q.s, q.t, ws, parent);
+
+    for(int k = 0; k < r.reps; ++k){
+        Timer T; T.start();
+        for(const Query& q : qs) fn(q.s, q.t, ws, parent);
+        r.samples.push_back(T.ms());
+    }
+    if(r.queries > 0){ r.expanded /= (double)r.queries; r.relaxed /= (double)r.queries; }
+    r.peak_rss_kb = peak_rss_kb();
+
+    std::vector<double> s = r.samples;
+    std::sort(s.begin(), s.end());
+    double n = (double)s.size();
+    for(double x : s) r.mean_ms += x;
+    r.mean_ms /= n;
+    for(double x : s) r.stddev_ms += (x - r.mean_ms) * (x - r.mean_ms);
+    r.stddev_ms = s.size() > 1 ? std::sqrt(r.stddev_ms / (n - 1)) : 0.0; // muestral
+    r.median_ms = (s.size() % 2) ? s[s.size() / 2] : 0.5 * (s[s.size() / 2 - 1] + s[s.size() / 2]);
+    r.min_ms = s.front();
+    r.max_ms = s.back();
+    return r;
+}
+
+VerifyResult verify_queries(const CSR& g, const std::vector<Query>& qs, const QueryFn& ref, const QueryFn& fn){
+    VerifyResult r;
+    SearchWorkspace wsRef, ws;
+    std::vector<int> pRef(g.N, -1), p(g.N, -1);
+    for(const Query& q : qs){
+        ++r.queries;
+        bool okRef = ref(q.s, q.t, wsRef, pRef);
+        bool ok = fn(q.s, q.t, ws, p);
+        r.ok += ok;
+        double want = okRef ? path_cost(q.s, q.t, g, pRef) : INFINITY;
+        double got  = ok    ? path_cost(q.s, q.t, g, p)    : INFINITY;
+        if(ok == okRef && (!ok || std::abs(got - want) <= 1e-5 * std::max(1.0, want))) continue;
+        ++r.mismatches;
+        if(ok && okRef) r.max_abs_err = std::max(r.max_abs_err, std::abs(got - want));
+        if(r.examples.size() < 5){
+            std::ostringstream o;
+            o.precision(10);
+            o << q.s << "->" << q.t << ": " << got << " vs " << want;
+            r.examples.push_back(o.str());
+        }
+    }
+    return r;
+}
+
+BenchMachine bench_machine(){
+    BenchMachine m;
+    m.cpu = proc_field("/proc/cpuinfo", "model name");
+    if(m.cpu.empty()) m.cpu = proc_field("/proc/cpuinfo", "Model"); // ARM
+    m.threads = (int)std::thread::hardware_concurrency();
+    m.governor = read_first("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+    struct utsname u;
+    if(uname(&u) == 0){
+        m.os = std::string(u.sysname) + " " + u.release;
+        m.arch = u.machine;
+        m.host = u.nodename;
+    }
+#if defined(__clang__)
+    m.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    m.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    m.compiler = "msvc " + std::to_string(_MSC_VER);
+#endif
+    m.flags = BENCH_CXXFLAGS;
+    // Lo que el binario sabe de sí mismo aunque no se pasen las flags
+#ifdef __OPTIMIZE__
+    m.features.push_back("__OPTIMIZE__");
+#endif
+#ifdef NDEBUG
+    m.features.push_back("NDEBUG");
+#endif
+#ifdef __AVX2__
+    m.features.push_back("AVX2");
+#endif
+#ifdef __AVX512F__
+    m.features.push_back("AVX512F");
+#endif
+#ifdef __ARM_NEON
+    m.features.push_back("NEON");
+#endif
+    char ts[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(ts, sizeof ts, "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    m.timestamp = ts;
+    return m;
+}
+
+void save_bench_json(const std::string& path, const BenchMachine& m,
+                     const std::vector<BenchCell>& cells){
+    std::ofstream f(path);
+    if(!f) throw std::runtime_error("No se puede abrir para escribir: " + path);
+    f << "{\n  \"schema\": 1,\n  \"timestamp\": " << json_str(m.timestamp) << ",\n";
+    f << "  \"machine\": {\"cpu\": " << json_str(m.cpu) << ", \"threads\": " << m.threads
+      << ", \"arch\": " << json_str(m.arch) << ", \"os\": " << json_str(m.os)
+      << ", \"host\": " << json_str(m.host) << ", \"governor\": " << json_str(m.governor) << "},\n";
+    f << "  \"build\": {\"compiler\": " << json_str(m.compiler) << ", \"flags\": " << json_str(m.flags)
+      << ", \"features\": [";
+    for(size_t i = 0; i < m.features.size(); ++i) f << (i ? ", " : "") << json_str(m.features[i]);
+    f << "]},\n  \"cells\": [";
+    for(size_t i = 0; i < cells.size(); ++i){
+        const BenchCell& c = cells[i];
+        const BenchStats& r = c.stats;
+        f << (i ? "," : "") << "\n    {\"graph\": " << json_str(c.graph) << ", \"queries\": " << json_str(c.queries)
+          << ", \"algo\": " << json_str(c.algo) << ", \"N\": " << c.N << ", \"M\": " << c.M << ",\n"
+          << "     \"n_queries\": " << r.queries << ", \"ok\": " << r.ok
+          << ", \"warmup\": " << r.warmup << ", \"reps\": " << r.reps << ",\n"
+          << "     \"time_ms\": {\"mean\": " << json_num(r.mean_ms) << ", \"median\": " << json_num(r.median_ms)
+          << ", \"stddev\": " << json_num(r.stddev_ms) << ", \"min\": " << json_num(r.min_ms)
+          << ", \"max\": " << json_num(r.max_ms) << ", \"samples\": [";
+        for(size_t k = 0; k < r.samples.size(); ++k) f << (k ? ", " : "") << json_num(r.samples[k]);
+        f << "]},\n     \"expanded\": " << json_num(r.expanded) << ", \"relaxed\": " << json_num(r.relaxed)
+          << ", \"cost\": " << json_num(r.cost) << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+    }
+    f << "\n  ]\n}\n";
+}
@@ -3,7 +3,8 @@ set -euo pipefail
 
 # =================== Config global ===================
 CXX=${CXX:-g++}
-CXXFLAGS="-O3 -march=native -DNDEBUG -std=c++17"
+# bucket_queue.hpp es la de los motores del backend (una sola copia)
+CXXFLAGS="-O3 -march=native -DNDEBUG -std=c++17 -pthread -I../../backend/engines"
 BIN=bench
 
 # Usamos grids 4-dir, pesos unitarios
@@ -29,8 +30,22 @@ PY
 
 # =================== Compilar ===================
 echo "[1/3] Compilando..."
-$CXX $CXXFLAGS -o "$BIN" \
-  main.cpp utils.cpp dijkstra.cpp astar.cpp bmssp.cpp dstar_lite.cpp
+$CXX $CXXFLAGS -DBENCH_CXXFLAGS="\"$CXXFLAGS\"" -o "$BIN" \
+  main.cpp utils.cpp dijkstra.cpp astar.cpp bmssp.cpp bmssp_duan.cpp dstar_lite.cpp jps.cpp ch.cpp bidir.cpp delta_par.cpp batch.cpp graphs.cpp dynamic.cpp maps.cpp suite.cpp
+
+# =================== Verificar costos ===================
+# Algoritmos exactos contra Dijkstra, consulta por consulta, en grids con
+# pesos en un rango amplio ([1,100]) y reales en [0,1] (8-dir). Sale con
+# error si alguna consulta difiere (--mode=verify devuelve 3). Los que usan
+# la heurística de grid (astar, biastar, dstar) suponen pesos >= 1: solo el
+# primero.
+echo "[verificación] costos contra Dijkstra..."
+./"$BIN" --mode=gen_grid --rows=80 --cols=80 --wmin=1 --wmax=100 --seed=4 --out=verify_w100.bin
+./"$BIN" --mode=gen_grid --rows=80 --cols=80 --wmin=0 --wmax=1 --seed=4 --diag8 --out=verify_w01.bin
+./"$BIN" --mode=verify --in=verify_w100.bin,verify_w01.bin --count=1000 --seed="$SEED" \
+  --algos=bmssp_duan,ch,bidijkstra,delta_par
+./"$BIN" --mode=verify --in=verify_w100.bin --count=1000 --seed="$SEED" \
+  --algos=astar,biastar,dstar
 
 # =================== Función por tamaño ===================
 run_for_size() {
@@ -3,13 +3,397 @@
 #include <random>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace {
 inline int id_from_rc(int r, int c, int cols){ return r*cols + c; }
+
+// -------- Formato v2 --------
+// Cabecera fija al inicio del archivo; cada sección empieza en un múltiplo
+// de V2_ALIGN (off_* = 0 si no está). Los offsets son desde el inicio.
+constexpr char     V2_MAGIC[8] = {'C','S','R','B','I','N','2','\0'};
+constexpr uint32_t V2_VERSION  = 2;
+constexpr uint64_t V2_ALIGN    = 64;
+enum : uint32_t { V2_COORDS = 1u, V2_DIAG8 = 2u };
+
+struct HeaderV2 {
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;            // V2_COORDS | V2_DIAG8
+    int32_t  N, rows, cols;
+    int32_t  wmin_int, wmax_int; // classify_weights ya hecho (no hay que leer w)
+    int32_t  reserved;
+    int64_t  M;
+    uint64_t off_row_ptr, off_col_ind, off_w, off_x, off_y;
+    uint64_t file_size;
+};
+static_assert(sizeof(HeaderV2) == 96, "cabecera v2 de 96 bytes");
+
+inline uint64_t align_up(uint64_t x){ return (x + V2_ALIGN - 1) / V2_ALIGN * V2_ALIGN; }
+
+// Offsets de las secciones para un grafo con N nodos y M aristas
+HeaderV2 layout_v2(const CSR& g){
+    HeaderV2 h{};
+    std::memcpy(h.magic, V2_MAGIC, 8);
+    h.version = V2_VERSION;
+    h.flags = (g.has_coords ? V2_COORDS : 0u) | (g.diag8 ? V2_DIAG8 : 0u);
+    h.N = g.N; h.rows = g.rows; h.cols = g.cols; h.M = g.M;
+    h.wmin_int = g.wmin_int; h.wmax_int = g.wmax_int;
+    uint64_t off = align_up(sizeof(HeaderV2));
+    auto place = [&](uint64_t bytes){ uint64_t o = off; off = align_up(off + bytes); return o; };
+    h.off_row_ptr = place(sizeof(long long) * ((uint64_t)g.N + 1));
+    h.off_col_ind = place(sizeof(int)   * (uint64_t)g.M);
+    h.off_w       = place(sizeof(float) * (uint64_t)g.M);
+    if(g.has_coords){
+        h.off_x = place(sizeof(float) * (uint64_t)g.N);
+        h.off_y = place(sizeof(float) * (uint64_t)g.N);
+    }
+    h.file_size = off;
+    return h;
+}
+
+// Valida una cabecera leída contra el tamaño real del archivo
+void check_v2(const HeaderV2& h, uint64_t size, const std::string& path){
+    auto bad = [&](const char* why){ throw std::runtime_error(std::string("CSR v2 inválido (") + why + "): " + path); };
+    if(h.version != V2_VERSION) bad("versión");
+    if(h.N < 0 || h.M < 0) bad("N/M");
+    if(h.file_size > size) bad("archivo truncado");
+    auto in = [&](uint64_t off, uint64_t bytes){
+        if(off % V2_ALIGN != 0 || off < sizeof(HeaderV2) || off + bytes > h.file_size) bad("sección fuera de rango");
+    };
+    in(h.off_row_ptr, sizeof(long long) * ((uint64_t)h.N + 1));
+    in(h.off_col_ind, sizeof(int)   * (uint64_t)h.M);
+    in(h.off_w,       sizeof(float) * (uint64_t)h.M);
+    if(h.flags & V2_COORDS){
+        in(h.off_x, sizeof(float) * (uint64_t)h.N);
+        in(h.off_y, sizeof(float) * (uint64_t)h.N);
+    }
+}
+
+void apply_meta_v2(const HeaderV2& h, CSR& g){
+    g.N = h.N; g.M = h.M;
+    g.rows = h.rows; g.cols = h.cols;
+    g.diag8 = (h.flags & V2_DIAG8) != 0;
+    g.has_coords = (h.flags & V2_COORDS) != 0;
+    g.wmin_int = h.wmin_int; g.wmax_int = h.wmax_int;
+}
+
+void save_csr_bin_v2(const CSR& g, const std::string& path){
+    std::ofstream f(path, std::ios::binary);
+    if(!f) throw std::runtime_error("No se puede abrir para escribir: " + path);
+
+    HeaderV2 h = layout_v2(g);
+    uint64_t pos = 0;
+    auto put = [&](uint64_t off, const void* p, uint64_t bytes){
+        static const char zeros[V2_ALIGN] = {};
+        while(pos < off){ uint64_t k = std::min<uint64_t>(V2_ALIGN, off - pos); f.write(zeros, k); pos += k; }
+        f.write((const char*)p, bytes); pos += bytes;
+    };
+    put(0, &h, sizeof(h));
+    put(h.off_row_ptr, g.row_ptr.data(), sizeof(long long) * ((uint64_t)g.N + 1));
+    put(h.off_col_ind, g.col_ind.data(), sizeof(int)   * (uint64_t)g.M);
+    put(h.off_w,       g.w.data(),       sizeof(float) * (uint64_t)g.M);
+    if(g.has_coords){
+        put(h.off_x, g.x.data(), sizeof(float) * (uint64_t)g.N);
+        put(h.off_y, g.y.data(), sizeof(float) * (uint64_t)g.N);
+    }
+    put(h.file_size, nullptr, 0); // relleno final
+    if(!f) throw std::runtime_error("Error escribiendo: " + path);
+}
+
+// Lee un v2 copiando a vectores propios (sin mmap)
+CSR load_csr_bin_v2(std::ifstream& f, const std::string& path){
+    f.seekg(0, std::ios::end);
+    uint64_t size = (uint64_t)f.tellg();
+    f.seekg(0);
+    HeaderV2 h;
+    f.read((char*)&h, sizeof(h));
+    if(!f) throw std::runtime_error("CSR v2 truncado: " + path);
+    check_v2(h, size, path);
+
+    CSR g;
+    apply_meta_v2(h, g);
+    auto get = [&](uint64_t off, auto& arr, uint64_t count){
+        arr.resize(count);
+        f.seekg((std::streamoff)off);
+        f.read((char*)arr.data(), sizeof(arr[0]) * count);
+    };
+    get(h.off_row_ptr, g.row_ptr, (uint64_t)g.N + 1);
+    get(h.off_col_ind, g.col_ind, (uint64_t)g.M);
+    get(h.off_w,       g.w,       (uint64_t)g.M);
+    if(g.has_coords){
+        get(h.off_x, g.x, (uint64_t)g.N);
+        get(h.off_y, g.y, (uint64_t)g.N);
+    }
+    if(!f) throw std::runtime_error("CSR v2 truncado: " + path);
+    return g;
+}
+
+// Escritura de un v2 por secciones, desde varios hilos a la vez (pwrite en
+// offsets fijos): los generadores no necesitan tener el CSR entero en
+// memoria. 'meta' solo aporta N, M y flags; la cabecera se escribe al final,
+// cuando ya se conoce la clase de los pesos.
+class V2Writer {
+    int fd = -1;
+    HeaderV2 h{};
+    std::string path;
+
+public:
+    V2Writer(const std::string& p, const CSR& meta) : h(layout_v2(meta)), path(p) {
+        fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0) throw std::runtime_error("No se puede abrir para escribir: " + p);
+        if(::ftruncate(fd, (off_t)h.file_size) != 0){ ::close(fd); throw std::runtime_error("Error escribiendo: " + p); }
+    }
+    ~V2Writer(){ if(fd >= 0) ::close(fd); }
+    const HeaderV2& header() const { return h; }
+
+    void put(uint64_t off, const void* data, uint64_t bytes){
+        const char* c = (const char*)data;
+        while(bytes > 0){
+            ssize_t k = ::pwrite(fd, c, bytes, (off_t)off);
+            if(k <= 0) throw std::runtime_error("Error escribiendo: " + path);
+            c += k; off += (uint64_t)k; bytes -= (uint64_t)k;
+        }
+    }
+    void finish(int wmin_int, int wmax_int){
+        h.wmin_int = wmin_int; h.wmax_int = wmax_int;
+        put(0, &h, sizeof(h));
+        if(::close(fd) != 0){ fd = -1; throw std::runtime_error("Error escribiendo: " + path); }
+        fd = -1;
+    }
+};
+
+// -------- Generación en paralelo --------
+// RNG por contador: cada valor depende solo de (seed, ctr), así el grafo es
+// el mismo con cualquier número de hilos o tamaño de bloque (SplitMix64 en
+// la posición ctr).
+inline uint64_t mix64(uint64_t x){
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
 }
+inline uint64_t rng_at(uint64_t seed, uint64_t ctr){
+    return mix64(mix64(seed) + (ctr + 1) * 0x9E3779B97F4A7C15ull);
+}
+inline float uniform_at(uint64_t seed, uint64_t ctr, float lo, float hi){
+    if(lo == hi) return lo;
+    float u = (float)(rng_at(seed, ctr) >> 40) * (1.0f / 16777216.0f); // [0, 1)
+    return lo + (hi - lo) * u;
+}
+inline int index_at(uint64_t seed, uint64_t ctr, int n){
+    return (int)(((unsigned __int128)rng_at(seed, ctr) * (uint64_t)n) >> 64);
+}
+
+int gen_threads(int threads){
+    return threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+}
+
+// fn(k) para k en [0, n), repartido dinámicamente entre 'threads' hilos
+template<class F> void parallel_chunks(long long n, int threads, F fn){
+    threads = (int)std::max(1LL, std::min<long long>(threads, n));
+    std::atomic<long long> next{0};
+    auto worker = [&]{ for(long long k; (k = next.fetch_add(1)) < n; ) fn(k); };
+    std::vector<std::thread> pool;
+    for(int i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+    for(auto& th : pool) th.join();
+}
+
+// Rango de los pesos generados, para wmin_int/wmax_int sin otra pasada
+struct WeightStats {
+    float lo = 0.0f, hi = 0.0f;
+    bool any = false, integral = true;
+    void add(const float* w, size_t n){
+        for(size_t i = 0; i < n; ++i){
+            float x = w[i];
+            if(!any){ lo = hi = x; any = true; }
+            lo = std::min(lo, x); hi = std::max(hi, x);
+            if(!(x >= 0.0f && x <= (float)(1 << 20)) || x != std::floor(x)) integral = false;
+        }
+    }
+    void merge(const WeightStats& o){
+        if(!o.any) return;
+        if(!any){ *this = o; return; }
+        lo = std::min(lo, o.lo); hi = std::max(hi, o.hi);
+        integral = integral && o.integral;
+    }
+    // Mismo criterio que classify_weights
+    void apply(int& wmin_int, int& wmax_int) const {
+        if(!integral){ wmin_int = wmax_int = -1; return; }
+        wmin_int = any ? (int)lo : 0;
+        wmax_int = any ? (int)hi : 0;
+    }
+};
+
+// Grid rows x cols: el grado de cada celda se conoce sin recorrer, así
+// cualquier bloque de filas sabe dónde empiezan sus aristas. El peso de la
+// arista e es uniform_at(seed, e).
+struct GridGen {
+    int rows, cols;
+    bool diag8;
+    float wmin, wmax;
+    uint64_t seed;
+    std::vector<std::pair<int,int>> nbrs;
+    std::vector<long long> rowStart; // primera arista de cada fila (rows+1)
+
+    GridGen(int r, int c, bool d8, float lo, float hi, unsigned sd)
+        : rows(r), cols(c), diag8(d8), wmin(lo), wmax(hi), seed(sd) {
+        nbrs = {{ 1, 0},{-1, 0},{ 0, 1},{ 0,-1}};
+        if(diag8){
+            nbrs.push_back({ 1, 1}); nbrs.push_back({ 1,-1});
+            nbrs.push_back({-1, 1}); nbrs.push_back({-1,-1});
+        }
+        rowStart.assign((size_t)rows + 1, 0);
+        for(int rr = 0; rr < rows; ++rr){
+            long long deg = 0;
+            for(auto [dr, dc] : nbrs)
+                if(rr + dr >= 0 && rr + dr < rows) deg += std::max(0, cols - std::abs(dc));
+            rowStart[rr + 1] = rowStart[rr] + deg;
+        }
+    }
+    long long N() const { return 1LL * rows * cols; }
+    long long M() const { return rowStart[rows]; }
+
+    CSR meta() const {
+        CSR g; g.N = (int)N(); g.M = M();
+        g.has_coords = true; g.rows = rows; g.cols = cols; g.diag8 = diag8;
+        return g;
+    }
+
+    // Filas [r0, r1): row_ptr, aristas y coordenadas desde el inicio de cada arreglo
+    void fill(int r0, int r1, long long* rp, int* col, float* w, float* x, float* y) const {
+        const long long u0 = 1LL * r0 * cols, e0 = rowStart[r0];
+        long long e = e0;
+        for(int r = r0; r < r1; ++r) for(int c = 0; c < cols; ++c){
+            const long long u = 1LL * r * cols + c;
+            rp[u - u0] = e;
+            x[u - u0] = (float)c;
+            y[u - u0] = (float)r;
+            for(auto [dr, dc] : nbrs){
+                int rr = r + dr, cc = c + dc;
+                if(rr >= 0 && rr < rows && cc >= 0 && cc < cols){
+                    col[e - e0] = id_from_rc(rr, cc, cols);
+                    w[e - e0] = uniform_at(seed, (uint64_t)e, wmin, wmax);
+                    ++e;
+                }
+            }
+        }
+    }
+
+    // Bloques de filas con ~'edges' aristas cada uno
+    int rows_per_block(long long edges) const {
+        long long perRow = std::max<long long>(1, rows ? M() / rows : 1);
+        return (int)std::max<long long>(1, std::min<long long>(rows, edges / perRow));
+    }
+};
+
+// Erdős–Rényi: la muestra i elige (u, v) con u != v y su peso; en no
+// dirigido agrega también v->u con otro peso. Todo sale de rng_at con el
+// contador i*32 + ranura, así cada hilo puede recalcular cualquier muestra.
+struct ErGen {
+    int n;
+    long long draws;
+    bool directed;
+    float wmin, wmax;
+    uint64_t seed;
+
+    static constexpr int TRIES = 14; // ranuras 0..27: pares (u, v) a probar
+
+    void draw(long long i, int& u, int& v) const {
+        const uint64_t base = (uint64_t)i * 32;
+        for(int a = 0; a < TRIES; ++a){
+            u = index_at(seed, base + 2*a, n);
+            v = index_at(seed, base + 2*a + 1, n);
+            if(u != v) return;
+        }
+        v = (u + 1) % n; // 14 empates seguidos: prob. n^-14
+    }
+    float weight(long long i, int k) const { return uniform_at(seed, (uint64_t)i * 32 + 30 + k, wmin, wmax); }
+
+    long long M() const { return directed ? draws : 2 * draws; }
+
+    // Grado de salida de cada nodo -> row_ptr (N+1)
+    void offsets(long long* rp, int threads) const {
+        std::unique_ptr<std::atomic<int>[]> deg(new std::atomic<int>[n]);
+        for(int u = 0; u < n; ++u) deg[u].store(0, std::memory_order_relaxed);
+        const long long block = 1 << 16;
+        parallel_chunks((draws + block - 1) / block, threads, [&](long long k){
+            for(long long i = k * block, e = std::min(draws, i + block); i < e; ++i){
+                int u, v; draw(i, u, v);
+                deg[u].fetch_add(1, std::memory_order_relaxed);
+                if(!directed) deg[v].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        rp[0] = 0;
+        for(int u = 0; u < n; ++u) rp[u + 1] = rp[u] + deg[u].load(std::memory_order_relaxed);
+    }
+
+    // Aristas con origen en [a, b) a col/w (índice 0 = row_ptr[a]). Cada fila
+    // queda ordenada por (destino, peso): el resultado no depende del reparto.
+    void fill(int a, int b, const long long* rp, int* col, float* w, int threads) const {
+        std::unique_ptr<std::atomic<int>[]> cur(new std::atomic<int>[b - a]);
+        for(int u = a; u < b; ++u) cur[u - a].store(0, std::memory_order_relaxed);
+        const long long e0 = rp[a];
+        auto put = [&](int from, int to, float wt){
+            if(from < a || from >= b) return;
+            long long pos = rp[from] - e0 + cur[from - a].fetch_add(1, std::memory_order_relaxed);
+            col[pos] = to; w[pos] = wt;
+        };
+        const long long block = 1 << 16;
+        parallel_chunks((draws + block - 1) / block, threads, [&](long long k){
+            for(long long i = k * block, e = std::min(draws, i + block); i < e; ++i){
+                int u, v; draw(i, u, v);
+                put(u, v, weight(i, 0));
+                if(!directed) put(v, u, weight(i, 1));
+            }
+        });
+        const int rowsPerTask = 4096;
+        parallel_chunks(((long long)(b - a) + rowsPerTask - 1) / rowsPerTask, threads, [&](long long k){
+            std::vector<std::pair<int,float>> row;
+            for(int u = a + (int)k * rowsPerTask, e = std::min(b, u + rowsPerTask); u < e; ++u){
+                long long lo = rp[u] - e0, hi = rp[u + 1] - e0;
+                row.clear();
+                for(long long j = lo; j < hi; ++j) row.push_back({col[j], w[j]});
+                std::sort(row.begin(), row.end());
+                for(long long j = lo; j < hi; ++j){ col[j] = row[j - lo].first; w[j] = row[j - lo].second; }
+            }
+        });
+    }
+};
+
+ErGen make_er(int N, long long M, float wmin, float wmax, unsigned seed, bool directed){
+    if(N < 2 && M > 0) throw std::runtime_error("gen_er: hacen falta al menos 2 nodos");
+    // No dirigido: cada muestra agrega dos aristas (M impar -> M+1)
+    return ErGen{N, directed ? M : (M + 1) / 2, directed, wmin, wmax, seed};
+}
+
+// Aristas por bloque al generar a disco (col_ind + w: 8 bytes por arista)
+constexpr long long STREAM_BLOCK_EDGES = 1LL << 22;
+// ER a disco: aristas de origen en memoria por pasada
+constexpr long long STREAM_ER_EDGES = 1LL << 26;
+} // namespace
 
 // -------------------- E/S binaria --------------------
-void save_csr_bin(const CSR& g, const std::string& path){
+int csr_bin_version(const std::string& path){
+    std::ifstream f(path, std::ios::binary);
+    if(!f) throw std::runtime_error("No se puede abrir para leer: " + path);
+    char magic[8] = {};
+    f.read(magic, 8);
+    return (f && std::memcmp(magic, V2_MAGIC, 8) == 0) ? 2 : 1;
+}
+
+void save_csr_bin(const CSR& g, const std::string& path, int version){
+    if(version == 2){ save_csr_bin_v2(g, path); return; }
+    if(version != 1) throw std::runtime_error("Versión de CSR desconocida: " + std::to_string(version));
+
     std::ofstream f(path, std::ios::binary);
     if(!f) throw std::runtime_error("No se puede abrir para escribir: " + path);
 
@@ -31,6 +415,11 @@ void save_csr_bin(const CSR& g, const std::string& path){
 }
 
 CSR load_csr_bin(const std::string& path){
+    if(csr_bin_version(path) == 2){
+        std::ifstream f(path, std::ios::binary);
+        return load_csr_bin_v2(f, path);
+    }
+
     std::ifstream f(path, std::ios::binary);
     if(!f) throw std::runtime_error("No se puede abrir para leer: " + path);
 
@@ -56,105 +445,209 @@ CSR load_csr_bin(const std::string& path){
             f.read((char*)g.y.data(), sizeof(float)*g.N);
         }
     }
+    classify_weights(g);
     return g;
 }
 
-// -------------------- Generador Grid --------------------
-CSR gen_grid(int rows, int cols, bool diag8,
-             float wmin, float wmax, unsigned seed){
-    const long long N = 1LL*rows*cols;
+// mmap del archivo completo (MAP_PRIVATE: escribir en los pesos no toca el
+// archivo) y los arreglos del CSR apuntan a sus secciones
+CSR map_csr_bin(const std::string& path){
+    if(csr_bin_version(path) != 2) return load_csr_bin(path);
 
-    std::vector<std::pair<int,int>> nbrs = {{ 1, 0},{-1, 0},{ 0, 1},{ 0,-1}};
-    if(diag8){
-        nbrs.push_back({ 1, 1}); nbrs.push_back({ 1,-1});
-        nbrs.push_back({-1, 1}); nbrs.push_back({-1,-1});
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("No se puede abrir para leer: " + path);
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(HeaderV2)){
+        ::close(fd);
+        throw std::runtime_error("CSR v2 truncado: " + path);
     }
+    size_t size = (size_t)st.st_size;
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd); // el mapeo sigue válido sin el descriptor
+    if(base == MAP_FAILED) throw std::runtime_error("mmap falló: " + path);
+    std::shared_ptr<const void> mapping(base, [size](const void* p){ ::munmap(const_cast<void*>(p), size); });
+
+    HeaderV2 h;
+    std::memcpy(&h, base, sizeof(h));
+    check_v2(h, size, path);
 
-    std::vector<long long> deg(N, 0);
-    for(int r=0;r<rows;++r) for(int c=0;c<cols;++c){
-        for(auto [dr,dc] : nbrs){
-            int rr=r+dr, cc=c+dc;
-            if(rr>=0 && rr<rows && cc>=0 && cc<cols)
-                deg[id_from_rc(r,c,cols)]++;
+    CSR g;
+    apply_meta_v2(h, g);
+    char* b = (char*)base;
+    g.row_ptr.borrow((long long*)(b + h.off_row_ptr), (size_t)g.N + 1);
+    g.col_ind.borrow((int*)(b + h.off_col_ind), (size_t)g.M);
+    g.w.borrow((float*)(b + h.off_w), (size_t)g.M);
+    if(g.has_coords){
+        g.x.borrow((float*)(b + h.off_x), (size_t)g.N);
+        g.y.borrow((float*)(b + h.off_y), (size_t)g.N);
+    }
+    g.mapping = std::move(mapping);
+    return g;
+}
+
+// Pesos enteros pequeños => colas por cubetas (bucket_queue.hpp)
+void classify_weights(CSR& g){
+    int lo = 1 << 20, hi = 0;
+    for(float w : g.w){
+        if(!(w >= 0.0f && w <= (float)(1 << 20)) || w != std::floor(w)){
+            g.wmin_int = g.wmax_int = -1;
+            return;
         }
+        lo = std::min(lo, (int)w);
+        hi = std::max(hi, (int)w);
     }
+    g.wmin_int = g.w.empty() ? 0 : lo;
+    g.wmax_int = hi;
+}
 
-    CSR g; g.N = (int)N;
-    g.row_ptr.assign(N+1, 0);
-    for(long long i=0;i<N;++i) g.row_ptr[i+1] = g.row_ptr[i] + deg[i];
+// -------------------- Grafo inverso --------------------
+ReverseCSR build_reverse(const CSR& g){
+    ReverseCSR r; r.N = g.N;
+    r.row_ptr.assign(r.N+1, 0);
 
-    g.M = g.row_ptr.back();
-    g.col_ind.resize(g.M);
-    g.w.resize(g.M);
+    // contar indegrees
+    for(int u=0; u<g.N; ++u){
+        for(long long e=g.row_ptr[u]; e<g.row_ptr[u+1]; ++e){
+            int v = g.col_ind[e];
+            r.row_ptr[v+1]++; // un pred más para v
+        }
+    }
+    // prefijos
+    for(int i=0;i<r.N;i++) r.row_ptr[i+1]+=r.row_ptr[i];
+    long long M = r.row_ptr.back();
+    r.col_ind.assign(M, 0);
+    r.w.assign(M, 0.0f);
 
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<float> U(wmin, wmax);
-
-    for(int r=0;r<rows;++r) for(int c=0;c<cols;++c){
-        const int u = id_from_rc(r,c,cols);
-        long long off = g.row_ptr[u];
-        for(auto [dr,dc] : nbrs){
-            int rr=r+dr, cc=c+dc;
-            if(rr>=0 && rr<rows && cc>=0 && cc<cols){
-                int v = id_from_rc(rr,cc,cols);
-                g.col_ind[off] = v;
-                g.w[off]       = U(rng);
-                ++off;
-            }
+    // relleno: necesitamos offsets temporales
+    std::vector<long long> off = r.row_ptr;
+    for(int u=0; u<g.N; ++u){
+        for(long long e=g.row_ptr[u]; e<g.row_ptr[u+1]; ++e){
+            int v = g.col_ind[e];
+            float ww = g.w[e];
+            long long pos = off[v]++;
+            r.col_ind[pos] = u; // u es pred de v
+            r.w[pos]       = ww;
         }
     }
+    return r;
+}
 
-    // Coordenadas para heurística (A*)
-    g.has_coords = true;
+// -------------------- Generador Grid --------------------
+CSR gen_grid(int rows, int cols, bool diag8,
+             float wmin, float wmax, unsigned seed, int threads){
+    GridGen gen(rows, cols, diag8, wmin, wmax, seed);
+    CSR g = gen.meta();
+    const long long N = gen.N();
+    g.row_ptr.resize(N + 1);
+    g.col_ind.resize(g.M);
+    g.w.resize(g.M);
     g.x.resize(N); g.y.resize(N);
-    for(int r=0;r<rows;++r) for(int c=0;c<cols;++c){
-        int u = id_from_rc(r,c,cols);
-        g.x[u] = static_cast<float>(c);
-        g.y[u] = static_cast<float>(r);
-    }
-    g.rows = rows; g.cols = cols; g.diag8 = diag8;
+
+    // Bloques de filas en paralelo, cada uno directo a su tramo del CSR
+    const int per = gen.rows_per_block(STREAM_BLOCK_EDGES);
+    const long long blocks = ((long long)rows + per - 1) / per;
+    std::vector<WeightStats> st(blocks);
+    parallel_chunks(blocks, gen_threads(threads), [&](long long k){
+        int r0 = (int)k * per, r1 = std::min(rows, r0 + per);
+        long long u0 = 1LL * r0 * cols, e0 = gen.rowStart[r0];
+        gen.fill(r0, r1, &g.row_ptr[u0], g.col_ind.data() + e0, g.w.data() + e0, &g.x[u0], &g.y[u0]);
+        st[k].add(g.w.data() + e0, (size_t)(gen.rowStart[r1] - e0));
+    });
+    g.row_ptr[N] = g.M;
+
+    WeightStats all;
+    for(const WeightStats& x : st) all.merge(x);
+    all.apply(g.wmin_int, g.wmax_int);
     return g;
 }
 
+void gen_grid_to_file(const std::string& path, int rows, int cols, bool diag8,
+                      float wmin, float wmax, unsigned seed, int threads){
+    GridGen gen(rows, cols, diag8, wmin, wmax, seed);
+    V2Writer out(path, gen.meta());
+    const HeaderV2& h = out.header();
+
+    // Cada bloque se arma en buffers propios del hilo y va a su offset
+    const int per = gen.rows_per_block(STREAM_BLOCK_EDGES);
+    const long long blocks = ((long long)rows + per - 1) / per;
+    std::vector<WeightStats> st(blocks);
+    parallel_chunks(blocks, gen_threads(threads), [&](long long k){
+        int r0 = (int)k * per, r1 = std::min(rows, r0 + per);
+        long long u0 = 1LL * r0 * cols, nu = 1LL * (r1 - r0) * cols;
+        long long e0 = gen.rowStart[r0], ne = gen.rowStart[r1] - e0;
+        std::vector<long long> rp(nu);
+        std::vector<int> col(ne);
+        std::vector<float> w(ne), x(nu), y(nu);
+        gen.fill(r0, r1, rp.data(), col.data(), w.data(), x.data(), y.data());
+        st[k].add(w.data(), w.size());
+        out.put(h.off_row_ptr + sizeof(long long) * u0, rp.data(), sizeof(long long) * nu);
+        out.put(h.off_col_ind + sizeof(int) * e0, col.data(), sizeof(int) * ne);
+        out.put(h.off_w + sizeof(float) * e0, w.data(), sizeof(float) * ne);
+        out.put(h.off_x + sizeof(float) * u0, x.data(), sizeof(float) * nu);
+        out.put(h.off_y + sizeof(float) * u0, y.data(), sizeof(float) * nu);
+    });
+    const long long M = gen.M();
+    out.put(h.off_row_ptr + sizeof(long long) * gen.N(), &M, sizeof(M));
+
+    WeightStats all;
+    for(const WeightStats& x : st) all.merge(x);
+    int lo, hi;
+    all.apply(lo, hi);
+    out.finish(lo, hi);
+}
+
 // -------------------- Generador Erdős–Rényi --------------------
-CSR gen_er(int N, long long M, float wmin, float wmax, unsigned seed, bool directed){
-    std::mt19937 rng(seed);
-    std::uniform_int_distribution<int> U(0, N-1);
-    std::uniform_real_distribution<float> W(wmin, wmax);
-
-    std::vector<std::vector<std::pair<int,float>>> adj(N);
-    long long added = 0;
-    while(added < M){
-        int u = U(rng), v = U(rng);
-        if(u==v) continue;
-        float w = W(rng);
-        adj[u].push_back({v, w}); added++;
-        if(!directed){
-            adj[v].push_back({u, W(rng)}); added++;
-        }
-    }
+CSR gen_er(int N, long long M, float wmin, float wmax, unsigned seed, bool directed, int threads){
+    ErGen gen = make_er(N, M, wmin, wmax, seed, directed);
+    threads = gen_threads(threads);
 
     CSR g; g.N = N;
-    g.row_ptr.assign(N+1, 0);
-    for(int u=0; u<N; ++u) g.row_ptr[u+1] = g.row_ptr[u] + (long long)adj[u].size();
-
-    g.M = g.row_ptr.back();
+    g.row_ptr.resize((size_t)N + 1);
+    gen.offsets(g.row_ptr.data(), threads);
+    g.M = g.row_ptr[N];
     g.col_ind.resize(g.M);
     g.w.resize(g.M);
+    gen.fill(0, N, g.row_ptr.data(), g.col_ind.data(), g.w.data(), threads);
 
-    for(int u=0; u<N; ++u){
-        long long off = g.row_ptr[u];
-        for(auto &e : adj[u]){
-            g.col_ind[off] = e.first;
-            g.w[off]       = e.second;
-            ++off;
-        }
-    }
     g.has_coords = false;
     g.rows = 0; g.cols = 0; g.diag8 = false;
+    classify_weights(g);
     return g;
 }
 
+void gen_er_to_file(const std::string& path, int N, long long M, float wmin, float wmax,
+                    unsigned seed, bool directed, int threads){
+    ErGen gen = make_er(N, M, wmin, wmax, seed, directed);
+    threads = gen_threads(threads);
+
+    std::vector<long long> rp((size_t)N + 1);
+    gen.offsets(rp.data(), threads);
+    CSR meta; meta.N = N; meta.M = rp[N];
+    V2Writer out(path, meta);
+    const HeaderV2& h = out.header();
+    out.put(h.off_row_ptr, rp.data(), sizeof(long long) * rp.size());
+
+    // Pasadas por rangos de origen con a lo sumo STREAM_ER_EDGES aristas
+    // (o un solo nodo si tiene más): cada una vuelve a sortear todas las muestras
+    WeightStats all;
+    std::vector<int> col;
+    std::vector<float> w;
+    for(int a = 0; a < N; ){
+        int b = a + 1;
+        while(b < N && rp[b + 1] - rp[a] <= STREAM_ER_EDGES) ++b;
+        long long e0 = rp[a], ne = rp[b] - e0;
+        col.resize(ne); w.resize(ne);
+        gen.fill(a, b, rp.data(), col.data(), w.data(), threads);
+        all.add(w.data(), w.size());
+        out.put(h.off_col_ind + sizeof(int) * e0, col.data(), sizeof(int) * ne);
+        out.put(h.off_w + sizeof(float) * e0, w.data(), sizeof(float) * ne);
+        a = b;
+    }
+    int lo, hi;
+    all.apply(lo, hi);
+    out.finish(lo, hi);
+}
+
 // -------------------- Ruta --------------------
 int path_length(int s, int t, const std::vector<int>& parent){
     if(s==t) return 1;
@@ -2,35 +2,148 @@
 #include <vector>
 #include <string>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <tuple>
+
+// -------- Arreglo del CSR: propio o prestado --------
+// Se usa como std::vector (operator[], size, data, begin/end, resize, assign).
+// Propio: los datos viven en un vector. Prestado (borrow): apunta a memoria
+// ajena, p.ej. un archivo mapeado con map_csr_bin; el CSR guarda el mapeo
+// vivo. resize/assign sobre uno prestado primero lo copia a memoria propia.
+template<class T>
+class CsrArray {
+    std::vector<T> own;
+    T* p = nullptr;
+    size_t n = 0;
+    bool ext = false;
+
+    void sync(){ p = own.data(); n = own.size(); ext = false; }
+    void materialize(){ if(ext){ own.assign(p, p + n); sync(); } }
+
+public:
+    CsrArray() = default;
+    CsrArray(const CsrArray& o){ *this = o; }
+    CsrArray(CsrArray&& o) noexcept { *this = std::move(o); }
+    CsrArray& operator=(const CsrArray& o){
+        if(this == &o) return *this;
+        if(o.ext){ own.clear(); p = o.p; n = o.n; ext = true; }
+        else { own = o.own; sync(); }
+        return *this;
+    }
+    CsrArray& operator=(CsrArray&& o) noexcept {
+        if(this == &o) return *this;
+        if(o.ext){ own.clear(); p = o.p; n = o.n; ext = true; }
+        else { own = std::move(o.own); sync(); }
+        o.own.clear(); o.sync();
+        return *this;
+    }
+
+    void borrow(T* ptr, size_t count){ own.clear(); own.shrink_to_fit(); p = ptr; n = count; ext = true; }
+    bool borrowed() const { return ext; }
+
+    size_t size()  const { return n; }
+    bool   empty() const { return n == 0; }
+    T*       data()       { return p; }
+    const T* data() const { return p; }
+    T&       operator[](size_t i)       { return p[i]; }
+    const T& operator[](size_t i) const { return p[i]; }
+    T*       begin()       { return p; }
+    T*       end()         { return p + n; }
+    const T* begin() const { return p; }
+    const T* end()   const { return p + n; }
+    const T& back()  const { return p[n-1]; }
+
+    void resize(size_t k){ materialize(); own.resize(k); sync(); }
+    void assign(size_t k, const T& v){ own.assign(k, v); sync(); }
+    template<class It> void assign(It first, It last){ own.assign(first, last); sync(); }
+};
 
 // -------- Representación del grafo (CSR) --------
 struct CSR {
     int N = 0;                  // # vértices
     long long M = 0;            // # aristas
-    std::vector<long long> row_ptr; // tamaño N+1
-    std::vector<int>        col_ind; // tamaño M
-    std::vector<float>      w;       // tamaño M
+    CsrArray<long long> row_ptr; // tamaño N+1
+    CsrArray<int>       col_ind; // tamaño M
+    CsrArray<float>     w;       // tamaño M
 
     // (Opcional) coordenadas para heurística en A*/grid
     bool has_coords = false;
-    std::vector<float> x, y;    // tamaño N cuando has_coords=true
+    CsrArray<float> x, y;       // tamaño N cuando has_coords=true
 
     // (Opcional) metadatos de grid
     int  rows = 0, cols = 0;
     bool diag8 = false;
+
+    // (Derivado) si todos los pesos son enteros en [0, 2^20]: el menor y el
+    // mayor; -1 si no. Lo rellena classify_weights (carga y generadores) y
+    // decide la cola de prioridad (bucket_queue.hpp).
+    int wmin_int = -1, wmax_int = -1;
+
+    // Archivo mapeado del que se prestan los arreglos (map_csr_bin); nulo si
+    // el grafo es propio. Las copias del CSR lo comparten.
+    std::shared_ptr<const void> mapping;
+
+    // Interfaz de grafo de los algoritmos templados (ver graphs.hpp)
+    template<class F> void for_each_out(int u, F&& f) const {
+        for(long long e = row_ptr[u]; e < row_ptr[u+1]; ++e) f(col_ind[e], w[e]);
+    }
+    float heuristic(int u, int t) const; // = heuristic_grid(*this, u, t)
+    void coord_delta(int u, int t, float& dx, float& dy) const { // |x[u]-x[t]|, |y[u]-y[t]| (requiere coords)
+        dx = x[u] > x[t] ? x[u] - x[t] : x[t] - x[u];
+        dy = y[u] > y[t] ? y[u] - y[t] : y[t] - y[u];
+    }
+    size_t bytes() const {
+        return row_ptr.size()*sizeof(long long) + col_ind.size()*sizeof(int)
+             + (w.size() + x.size() + y.size())*sizeof(float);
+    }
+};
+
+// -------- Grafo inverso (predecesores) --------
+// Para cada x, lista de p con p->x y el peso de esa arista. Lo usan D* Lite y
+// las búsquedas bidireccionales (lado hacia atrás desde t).
+struct ReverseCSR {
+    int N=0;
+    std::vector<long long> row_ptr; // N+1
+    std::vector<int>       col_ind; // predecesores
+    std::vector<float>     w;       // pesos p->x
 };
+ReverseCSR build_reverse(const CSR& g);
 
 // -------- Utilidades de E/S --------
-void save_csr_bin(const CSR& g, const std::string& path);
+// Formatos en disco:
+//   v1: N, M, row_ptr, col_ind, w y metadatos opcionales, todo seguido
+//   v2: cabecera con versión y offsets de cada sección, secciones alineadas
+//       a 64 bytes: se puede mapear (mmap) y usar sin copiar
+// load_csr_bin lee ambos copiando a memoria; map_csr_bin mapea un v2 (y si el
+// archivo es v1, cae a load_csr_bin). Los pesos mapeados son copy-on-write:
+// modificarlos no toca el archivo.
+void save_csr_bin(const CSR& g, const std::string& path, int version=2);
 CSR  load_csr_bin(const std::string& path);
+CSR  map_csr_bin(const std::string& path);
+int  csr_bin_version(const std::string& path); // 1 o 2
+void classify_weights(CSR& g);
 
 // -------- Generadores --------
+// En paralelo (threads <= 0 -> hardware_concurrency) y con un RNG por
+// contador: el grafo depende solo de los parámetros y la semilla, no del
+// número de hilos. Las filas de gen_er quedan ordenadas por destino.
 CSR gen_grid(int rows, int cols, bool diag8,
-             float wmin=1.0f, float wmax=1.0f, unsigned seed=42);
+             float wmin=1.0f, float wmax=1.0f, unsigned seed=42, int threads=0);
 
 CSR gen_er(int N, long long M,
            float wmin=1.0f, float wmax=10.0f,
-           unsigned seed=42, bool directed=true);
+           unsigned seed=42, bool directed=true, int threads=0);
+
+// Igual, pero escriben el v2 directo al archivo por bloques sin armar el CSR
+// en memoria (gen_er solo guarda row_ptr y un tramo de aristas por pasada).
+// El archivo es idéntico a save_csr_bin(gen_*(...), path, 2).
+void gen_grid_to_file(const std::string& path, int rows, int cols, bool diag8,
+                      float wmin=1.0f, float wmax=1.0f, unsigned seed=42, int threads=0);
+void gen_er_to_file(const std::string& path, int N, long long M,
+                    float wmin=1.0f, float wmax=10.0f,
+                    unsigned seed=42, bool directed=true, int threads=0);
 
 // -------- Temporizador --------
 struct Timer {
@@ -46,9 +159,59 @@ struct Timer {
 int   path_length(int s, int t, const std::vector<int>& parent);
 float path_cost(int s, int t, const CSR& g, const std::vector<int>& parent); // opcional
 
+// -------- Consultas en lote (batch.cpp) --------
+struct Query { int s = -1, t = -1; };
+
+// Archivo de texto: "s t" por línea; '#' comenta
+std::vector<Query> load_queries(const std::string& path);
+void               save_queries(const std::vector<Query>& qs, const std::string& path);
+std::vector<Query> gen_queries(int N, int count, unsigned seed=42); // pares uniformes
+
+// Una consulta s->t; debe ser segura para llamarse desde varios hilos a la vez.
+// 'ws' es el workspace del hilo; 'parent' debe quedar con el camino s->t.
+struct SearchWorkspace; // workspace.hpp
+using QueryFn = std::function<bool(int s, int t, SearchWorkspace& ws, std::vector<int>& parent)>;
+
+struct BatchResult {
+    int threads = 0;
+    long long queries = 0, ok = 0;   // ok = consultas con ruta
+    double wall_ms = 0, qps = 0;     // tiempo de pared del lote y throughput
+    double p50 = 0, p95 = 0, p99 = 0, max_ms = 0; // latencia por consulta (ms)
+};
+
+// Percentil por rango más cercano sobre un vector ya ordenado
+double percentile(const std::vector<double>& sorted, double p);
+
+// Reparte 'qs' entre 'threads' hilos (<= 0 -> hardware_concurrency)
+BatchResult run_batch(int N, const std::vector<Query>& qs, int threads, const QueryFn& fn);
+
 // -------- Heurística (A*) --------
 // Si el grafo no tiene coords, devuelve 0 (A* -> Dijkstra).
 float heuristic_grid(const CSR& g, int u, int t);
+inline float CSR::heuristic(int u, int t) const { return heuristic_grid(*this, u, t); }
+
+// -------- Contraction Hierarchies (ch.cpp) --------
+// Grafo aumentado con atajos, separado en dos grafos "ascendentes" por rango:
+//   up : aristas u->v con rank[v] > rank[u]     (búsqueda hacia adelante desde s)
+//   dn : aristas u->v con rank[u] > rank[v], guardadas en v como (u, w)
+//        (búsqueda hacia atrás desde t)
+// mid = nodo contraído que reemplaza el atajo (-1 si es arista original).
+// Los 'core' nodos de mayor rango no se contraen; sus aristas internas están en
+// up y dn a la vez.
+struct CHGraph {
+    int N = 0;
+    std::vector<int> rank;
+    std::vector<long long> up_ptr, dn_ptr; // tamaño N+1
+    std::vector<int>   up_to,  dn_from;
+    std::vector<float> up_w,   dn_w;
+    std::vector<int>   up_mid, dn_mid;
+    int core = 0;
+    long long shortcuts = 0;
+};
+
+CHGraph ch_build(const CSR& g);
+void    save_ch_bin(const CHGraph& ch, const std::string& path);
+CHGraph load_ch_bin(const std::string& path);
 
 // -------- Firmas de algoritmos (se implementan en sus .cpp) --------
 // Deben llenar 'parent' y devolver true si existe ruta s->t.
@@ -56,3 +219,158 @@ bool dijkstra_run(const CSR& g, int s, int t, std::vector<int>& parent);
 bool astar_run   (const CSR& g, int s, int t, std::vector<int>& parent);
 bool bmssp_run   (const CSR& g, int s, int t, float B, std::vector<int>& parent);
 bool dstar_lite_run_static(const CSR& g, int s, int t, std::vector<int>& parent);
+// Con workspace reutilizable (sin O(N) por consulta): predecesores en ws.parent,
+// ws.export_path(s, t, parent) los pasa a vector<int> (workspace.hpp).
+// Son templados sobre el grafo G: CSR, CompactCSR<float|uint16_t|uint8_t> o
+// ImplicitGrid (graphs.hpp; instanciados en sus .cpp). La heurística de A* y
+// D* Lite se fija por consulta como política (with_heuristic, graphs.hpp).
+template<class G> bool dijkstra_run(const G& g, int s, int t, SearchWorkspace& ws);
+template<class G> bool astar_run   (const G& g, int s, int t, SearchWorkspace& ws);
+template<class G> bool bmssp_run   (const G& g, int s, int t, float B, SearchWorkspace& ws);
+// BMSSP del paper: FindPivots + estructura de bloques D + recursión por niveles (bmssp_duan.cpp)
+template<class G> bool bmssp_duan_run(const G& g, int s, int t, SearchWorkspace& ws);
+template<class G> bool dstar_lite_run_static(const G& g, int s, int t, SearchWorkspace& ws);
+// D* Lite con cambios de peso (u, v, w) aplicados tras el plan inicial
+bool dstar_lite_run_dynamic(const CSR& g, int s, int t,
+                            const std::vector<std::tuple<int,int,float>>& updates,
+                            std::vector<int>& parent);
+bool jps_run     (const CSR& g, int s, int t, std::vector<int>& parent); // grid 4-dir, pesos 1
+// Δ-stepping paralelo: threads <= 0 -> hardware_concurrency, delta <= 0 -> automático.
+// Con 'ws' el Δ, los arreglos y el pool de hilos se reutilizan entre consultas
+bool delta_stepping_par_run(const CSR& g, int s, int t, int threads, float delta, SearchWorkspace& ws);
+bool delta_stepping_par_run(const CSR& g, int s, int t, int threads, float delta,
+                            std::vector<int>& parent);
+// Bidireccionales: 'rg' = build_reverse(g), construido una vez fuera de la consulta
+bool bidijkstra_run(const CSR& g, const ReverseCSR& rg, int s, int t, std::vector<int>& parent);
+bool biastar_run   (const CSR& g, const ReverseCSR& rg, int s, int t, std::vector<int>& parent);
+// CH: 'parent' con tamaño N (si no, se crea en -1); solo se escriben las entradas del camino
+bool ch_run      (const CHGraph& ch, int s, int t, std::vector<int>& parent);
+
+// -------- D* Lite incremental (dstar_lite.cpp) --------
+// Cambio de peso de la arista u->v (la primera u->v del CSR)
+struct EdgeUpdate { int u = -1, v = -1; float w = 0.0f; };
+
+// Conserva g/rhs y el open-set entre ticks: el agente se mueve y cambian
+// pesos, y plan() solo repara lo afectado. update_edge modifica 'g' (la
+// primera arista u->v); 'g' debe vivir más que la sesión. update_edges
+// aplica un lote entero y repara una sola vez.
+class DStarLiteSession {
+public:
+    DStarLiteSession(CSR& g, int s, int t);
+    ~DStarLiteSession();
+    bool plan();                              // repara; ruta s->t en workspace().parent
+    void move_to(int s);                      // nuevo start del agente
+    bool update_edge(int u, int v, float w);  // false si no existe o w < 0
+    int  update_edges(const std::vector<EdgeUpdate>& ups); // lote, una reparación;
+                                                           // devuelve los aplicados
+    SearchWorkspace& workspace();             // contadores expanded/relaxed acumulados
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// -------- Escenarios dinámicos (dynamic.cpp) --------
+
+// Un tick: el agente ya está en 's', llegan 'updates' y se replanifica
+struct DynamicTick { int s = -1; std::vector<EdgeUpdate> updates; };
+struct DynamicStream { int s = -1, t = -1; std::vector<DynamicTick> ticks; };
+
+// Flujo reproducible (misma semilla -> mismos ticks). Modelos de cambio:
+//   random    : aristas uniformes en todo el grafo
+//   clustered : aristas de un BFS alrededor de un nodo al azar por tick
+//   path      : aristas de la ruta actual por delante del agente
+// Cada cambio alterna la arista entre su peso original y original*factor.
+// El agente avanza 'step' nodos por tick sobre la ruta de un Dijkstra de
+// referencia; el flujo termina antes si llega a t. 'g' queda como estaba.
+DynamicStream gen_dynamic_stream(CSR& g, int s, int t, const std::string& model,
+                                 int ticks, int changes, int step, float factor,
+                                 unsigned seed=42);
+
+struct DynamicResult {
+    long long ticks = 0, ok = 0;      // ok = ticks con ruta
+    double init_ms = 0;               // plan inicial (antes del primer tick)
+    double mean_ms = 0, p50 = 0, p95 = 0, p99 = 0, max_ms = 0; // por tick
+    double expanded = 0, relaxed = 0; // nodos/aristas tocados, promedio por tick
+    double cost = 0;                  // costo medio de la ruta en ticks con ruta
+};
+
+// Reproduce el flujo replanificando de cero con 'fn' o con D* Lite
+// incremental. Aplican los cambios sobre 'g' y al final lo restauran.
+DynamicResult run_dynamic_scratch(CSR& g, const DynamicStream& st, const QueryFn& fn);
+DynamicResult run_dynamic_dstar  (CSR& g, const DynamicStream& st);
+
+// -------- Mapas con obstáculos y terreno (maps.cpp) --------
+// Grilla de celdas: cost <= 0 bloqueada; si no, costo de entrar a la celda
+struct CellMap {
+    int rows = 0, cols = 0;
+    std::vector<float> cost; // rows*cols, id = r*cols + c
+};
+
+// Misma semilla -> mismo mapa
+CellMap gen_map_random (int rows, int cols, double obstacles, unsigned seed=42);
+CellMap gen_map_maze   (int rows, int cols, double loops, unsigned seed=42);  // loops: fracción de paredes que se abren
+CellMap gen_map_rooms  (int rows, int cols, int roomSize, unsigned seed=42);  // habitaciones de hasta roomSize de lado
+CellMap gen_map_terrain(int rows, int cols, float maxCost, double water,
+                        float scale=0, unsigned seed=42); // scale <= 0 -> max(rows, cols)/8
+
+// MovingAI (movingai.com/benchmarks): '.', 'G', 'S' transitables. 'octile'
+// queda en true si el mapa es "type octile" (8 direcciones).
+CellMap load_movingai_map(const std::string& path, bool* octile=nullptr);
+
+// Consultas del mapa; optimal (vacío si se desconoce) = longitud de referencia
+struct MapScenario {
+    std::vector<Query> queries;
+    std::vector<double> optimal;
+};
+MapScenario load_movingai_scen(const std::string& path, const CellMap& m);
+
+// rows*cols nodos con coords; las celdas bloqueadas quedan aisladas
+CSR map_to_csr(const CellMap& m, bool diag8);
+
+// Pares s->t al azar dentro de una misma componente conexa (todos con ruta)
+MapScenario gen_map_scenario(const CSR& g, int count, unsigned seed=42);
+
+// "s t [óptimo]" por línea, legible por load_queries
+void save_scenario(const MapScenario& sc, const std::string& path);
+
+// -------- Suite de benchmarks (suite.cpp) --------
+// Una celda: 'reps' pasadas medidas del conjunto de consultas tras 'warmup'
+// pasadas descartadas, en un hilo. Tiempos en ms por pasada completa.
+struct BenchStats {
+    int warmup = 0, reps = 0;
+    long long queries = 0, ok = 0;
+    std::vector<double> samples;          // una por repetición
+    double mean_ms = 0, median_ms = 0, stddev_ms = 0, min_ms = 0, max_ms = 0;
+    double expanded = 0, relaxed = 0;     // promedio por consulta
+    double cost = 0;                      // suma de costos de las rutas
+    long peak_rss_kb = 0;
+};
+BenchStats run_bench(const CSR& g, const std::vector<Query>& qs, int warmup, int reps, const QueryFn& fn);
+
+struct BenchCell {
+    std::string graph, queries, algo;
+    int N = 0; long long M = 0;
+    BenchStats stats;
+};
+
+// Máquina y build en los que corrió la suite
+struct BenchMachine {
+    std::string cpu, arch, os, host, governor, compiler, flags, timestamp;
+    int threads = 0;
+    std::vector<std::string> features; // NDEBUG, AVX2, ... vistos al compilar
+};
+BenchMachine bench_machine();
+void save_bench_json(const std::string& path, const BenchMachine& m, const std::vector<BenchCell>& cells);
+
+// Costo de cada consulta de 'fn' contra 'ref' (Dijkstra): cuenta las que
+// difieren en existencia de ruta o en costo (tolerancia relativa 1e-5)
+struct VerifyResult {
+    long long queries = 0, ok = 0, mismatches = 0;
+    double max_abs_err = 0;
+    std::vector<std::string> examples; // las primeras, "s->t: costo vs esperado"
+};
+VerifyResult verify_queries(const CSR& g, const std::vector<Query>& qs, const QueryFn& ref, const QueryFn& fn);
+
+// Pico de RSS en KB (VmHWM); reset_peak_rss lo reinicia si el kernel lo permite
+void reset_peak_rss();
+long peak_rss_kb();
@@ -0,0 +1,159 @@
+#pragma once
+#include "utils.hpp"
+#include "bucket_queue.hpp"
+#include "graphs.hpp"
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#include <memory>
+
+/*
+  Espacio de trabajo reutilizable entre consultas (dijkstra, astar, bmssp,
+  dstar). Evita reservar y llenar arreglos de tamaño N en cada búsqueda:
+
+  - StampedArray<T>: cada celda guarda (época, valor); si su época no es la
+    actual, vale el valor por defecto. reset() solo sube la época, O(1)
+    (salvo al cambiar N o cuando la época da la vuelta a 2^32).
+  - StampSet: conjunto de nodos con el mismo truco (closed, visitados).
+  - Las colas (Dial, radix, heap binario) conservan su memoria entre
+    consultas; el grafo inverso de D* Lite se arma una vez por grafo.
+  - expanded / relaxed: nodos expandidos y aristas examinadas en la última
+    consulta.
+
+  Un workspace no se comparte entre hilos: uno por hilo (thread_workspace()
+  o el que tiene cada hilo del batch).
+
+  Tras dijkstra_run/astar_run/bmssp_run/dstar_lite_run_static(..., ws),
+  ws.parent tiene los predecesores de la última búsqueda (-1 si no hay) y
+  export_path() los copia a un vector<int> como esperan path_length/path_cost.
+*/
+
+template<class T>
+class StampedArray {
+    struct Slot { uint32_t stamp; T val; };
+    std::vector<Slot> a;
+    uint32_t epoch = 1;
+    T def{};
+
+public:
+    // N celdas, todas con valor 'd'; conserva la memoria si N no cambia
+    void reset(int N, const T& d){
+        def = d;
+        if((int)a.size() != N){ a.assign(N, Slot{0, d}); epoch = 1; return; }
+        if(++epoch == 0){ for(auto& s : a) s.stamp = 0; epoch = 1; }
+    }
+
+    int  size() const { return (int)a.size(); }
+    bool touched(int v) const { return a[v].stamp == epoch; }
+    T    get(int v) const { return a[v].stamp == epoch ? a[v].val : def; }
+
+    void set(int v, const T& x){ a[v].stamp = epoch; a[v].val = x; }
+
+    // Referencia escribible; la celda toma 'def' si venía de otra época
+    T& operator[](int v){
+        Slot& s = a[v];
+        if(s.stamp != epoch){ s.stamp = epoch; s.val = def; }
+        return s.val;
+    }
+};
+
+class StampSet {
+    std::vector<uint32_t> st;
+    uint32_t epoch = 1;
+
+public:
+    void reset(int N){
+        if((int)st.size() != N){ st.assign(N, 0); epoch = 1; return; }
+        if(++epoch == 0){ std::fill(st.begin(), st.end(), 0); epoch = 1; }
+    }
+    bool has(int v) const { return st[v] == epoch; }
+    void insert(int v){ st[v] = epoch; }
+    void erase(int v){ st[v] = 0; }   // 0 nunca es una época válida
+};
+
+struct DeltaParState; // delta_par.cpp
+
+struct SearchWorkspace {
+    // Dos arreglos de claves por tipo: dist / g y f (A*), g y rhs (D* Lite)
+    template<class K> struct Keys { StampedArray<K> a, b; };
+    Keys<uint32_t> ki;
+    Keys<float>    kf;
+
+    StampedArray<int> parent;
+    StampSet closed;
+
+    // D* Lite: clave vigente y pertenencia al open-set
+    StampedArray<std::pair<float,float>> keyOf;
+    StampSet inOpen;
+
+    // Colas reutilizadas
+    DialQueue              dial;
+    RadixHeap              radix;
+    BinaryHeapQueue<float> heap;
+
+    // Estadísticas de la última consulta
+    long long expanded = 0, relaxed = 0;
+
+    // bmssp: nodos que tocó la última búsqueda acotada (sin repetidos) y
+    // cuántos se particionaron en cada nivel de la recursión
+    std::vector<int> touched;
+    std::vector<long long> levelTouched;
+
+    // delta_par: Δ, arreglos atómicos, cubetas y pool de hilos por grafo
+    std::shared_ptr<DeltaParState> deltaPar;
+
+    template<class K> Keys<K>& keys(){
+        if constexpr(std::is_same_v<K, float>) return kf;
+        else return ki;
+    }
+
+    // Inicio de una consulta sobre un grafo de N nodos: O(1)
+    void begin(int N){
+        parent.reset(N, -1);
+        expanded = relaxed = 0;
+        levelTouched.clear();
+    }
+
+    // Grafo inverso de 'g', construido la primera vez y guardado. El CSR se
+    // reconoce por sus aristas; los demás tipos, por la dirección del objeto.
+    template<class G> const ReverseCSR& reverse_of(const G& g){
+        const void* id = &g;
+        if constexpr(std::is_same_v<G, CSR>) id = g.col_ind.data();
+        if(revOf != id || rev.N != g.N || (long long)rev.col_ind.size() != g.M){
+            rev = build_reverse(g);
+            revOf = id;
+        }
+        return rev;
+    }
+
+    // Copia el camino s->t a 'out' (solo esas entradas; el resto no se toca).
+    // 'out' se dimensiona a N si hace falta.
+    void export_path(int s, int t, std::vector<int>& out) const {
+        int N = parent.size();
+        if((int)out.size() != N) out.assign(N, -1);
+        if(s < 0 || s >= N || t < 0 || t >= N) return;
+        out[s] = -1;
+        for(int v = t, guard = 0; v != s && v != -1 && guard <= N; ++guard){
+            out[v] = parent.get(v);
+            v = out[v];
+        }
+    }
+
+    // Copia todo el árbol de predecesores (O(N), para las firmas antiguas)
+    void export_tree(std::vector<int>& out) const {
+        int N = parent.size();
+        out.resize(N);
+        for(int v = 0; v < N; ++v) out[v] = parent.get(v);
+    }
+
+private:
+    const void* revOf = nullptr;
+    ReverseCSR rev;
+};
+
+// Workspace propio del hilo, compartido por las firmas que reciben vector<int>
+inline SearchWorkspace& thread_workspace(){
+    thread_local SearchWorkspace ws;
+    return ws;
+}
@@ -48,6 +48,10 @@ export default function Controls({
           <option value="astar">A*</option>
           <option value="dijkstra">Dijkstra</option>
           <option value="bmssp">BMSSP</option>
+          <option value="jps">JPS</option>
+          <option value="hpa">HPA* (aproximado)</option>
+          <option value="bidijkstra">Dijkstra bidireccional</option>
+          <option value="biastar">A* bidireccional</option>
         </select>
       </label>
 
@@ -59,6 +63,10 @@ export default function Controls({
             <option value="astar">A*</option>
             <option value="dijkstra">Dijkstra</option>
             <option value="bmssp">BMSSP</option>
+            <option value="jps">JPS</option>
+            <option value="hpa">HPA* (aproximado)</option>
+            <option value="bidijkstra">Dijkstra bidireccional</option>
+            <option value="biastar">A* bidireccional</option>
           </select>
         </label>
       )}
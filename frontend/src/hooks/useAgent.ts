@@ -1,7 +1,7 @@
 import { useEffect, useRef, useState } from "react";
 import type { AlgoKey, Cell, Layers, Pt } from "../lib/state";
 import { idx } from "../lib/state";
-import { buildBody, dstarInit, dstarMove, dstarUpdate, runOneShot } from "../lib/pathApi";
+import { buildRequestBody, dstarInit, dstarMove, dstarUpdate, runOneShot, runOneShotStream } from "../lib/pathApi";
 
 type UseAgentParams = {
   grid: Cell[];
@@ -96,7 +96,7 @@ export function useAgent({
 
       paintFuture(plan.slice(k + 1));
 
-      if (algo === "dstar") { try { await dstarMove(next.r, next.c); } catch { } }
+      if (algo === "dstar") { try { await dstarMove(next.r, next.c, cols); } catch { } }
 
       planIdxRef.current = k + 1;
       timerRef.current = window.setTimeout(tick, Math.max(0, speedMs));
@@ -122,7 +122,7 @@ export function useAgent({
     agentRef.current = { ...start };
     markAgentCellAsDone(start);
 
-    const body = buildBody(rows, cols, start.r, start.c, goal.r, goal.c, grid);
+    const body = buildRequestBody(rows, cols, start.r, start.c, goal.r, goal.c, grid);
 
     try {
       if (algo === "dstar") {
@@ -137,9 +137,15 @@ export function useAgent({
 
         setStatus(`D*Lite listo: ${out.path.length} nodos`);
       } else {
-        const out = await runOneShot(algo, body, cols);
+        // Exploración por streaming: se pinta a lo sumo una vez por frame
         const visited = new Array(rows * cols).fill(false);
-        out.visited.forEach(p => visited[idx(p.r, p.c, cols)] = true);
+        let frame = 0;
+        const paint = () => { frame = 0; setLayers(l => ({ ...l, visited: visited.slice() })); };
+        const out = await runOneShotStream(algo, body, cols, ids => {
+          for (const id of ids) visited[id] = true;
+          if (!frame) frame = requestAnimationFrame(paint);
+        });
+        if (frame) cancelAnimationFrame(frame);
         setLayers(l => ({ ...l, visited }));
 
         planRef.current = out.path;
@@ -182,7 +188,7 @@ export function useAgent({
       setIsPlaying(false);
       setStatus("D*Lite UPDATE+PLAN...");
 
-      try { await dstarMove(agentRef.current.r, agentRef.current.c); } catch { }
+      try { await dstarMove(agentRef.current.r, agentRef.current.c, cols); } catch { }
 
       const batch = changes.map(ch => `${ch.r} ${ch.c} ${ch.blocked ? 1e9 : 1}`).join("\n") + "\n";
       try {
@@ -210,7 +216,7 @@ export function useAgent({
     setIsPlaying(false);
     setStatus("Replanificando (agente→goal)...");
     const a = agentRef.current;
-    const body = buildBody(rows, cols, a.r, a.c, goal.r, goal.c, grid);
+    const body = buildRequestBody(rows, cols, a.r, a.c, goal.r, goal.c, grid);
     try {
       const out = await runOneShot(algo as Exclude<AlgoKey, "dstar">, body, cols);
       const visited = new Array(rows * cols).fill(false);
@@ -1,6 +1,13 @@
-import { API_BASE } from "./state";
+import { API_BASE, USE_BINARY } from "./state";
 import type { Cell, Pt } from "./state";
 
+// pathFrom solo en respuestas delta de D* Lite: path es la cabeza nueva y la
+// ruta sigue con la anterior desde pathFrom (ver applyDStarPlan)
+type PlanOutput = { visited: Pt[]; path: Pt[]; parents: Map<number, number>; pathFrom?: number };
+type Body = string | ArrayBuffer;
+
+const OCTET = "application/octet-stream";
+
 // Construye el cuerpo de entrada para los binarios
 export function buildBody(
   rows: number,
@@ -21,21 +28,138 @@ export function buildBody(
   return lines.join("\n");
 }
 
+// === Protocolo binario opcional (VITE_ENGINE_PROTOCOL=binary, ver backend/src/wire.js) ===
+
+// Payload: tipo (1 byte) + int32 little-endian
+function intsFrame(type: string, ints: number[], extraBytes = 0) {
+  const buf = new ArrayBuffer(1 + 4 * ints.length + extraBytes);
+  const dv = new DataView(buf);
+  dv.setUint8(0, type.charCodeAt(0));
+  ints.forEach((v, i) => dv.setInt32(1 + 4 * i, v, true));
+  return buf;
+}
+
+// 'G': rows cols sr sc er ec + grilla empaquetada (bit c%8 del byte c/8 = obstáculo)
+export function buildGridFrame(
+  rows: number,
+  cols: number,
+  sr: number,
+  sc: number,
+  er: number,
+  ec: number,
+  cells: Cell[]
+) {
+  const rb = (cols + 7) >> 3;
+  const buf = intsFrame("G", [rows, cols, sr, sc, er, ec], rows * rb);
+  const bits = new Uint8Array(buf, 25);
+  for (let r = 0; r < rows; r++) {
+    for (let c = 0; c < cols; c++) {
+      if (cells[r * cols + c]) bits[r * rb + (c >> 3)] |= 1 << (c & 7);
+    }
+  }
+  return buf;
+}
+
+// Cuerpo de petición según el protocolo configurado
+export function buildRequestBody(
+  rows: number,
+  cols: number,
+  sr: number,
+  sc: number,
+  er: number,
+  ec: number,
+  cells: Cell[]
+): Body {
+  return USE_BINARY
+    ? buildGridFrame(rows, cols, sr, sc, er, ec, cells)
+    : buildBody(rows, cols, sr, sc, er, ec, cells);
+}
+
+// 'R': nVisited + ids, nParents + (id, pid), nPath + ids
+// 'D': igual pero nParents solo cambiados y from + nHead + ids
+export function parseResultFrame(buf: ArrayBuffer, cols: number): PlanOutput {
+  const dv = new DataView(buf);
+  let off = 1;
+  const next = () => { const v = dv.getInt32(off, true); off += 4; return v; };
+  const pt = (id: number): Pt => ({ r: Math.floor(id / cols), c: id % cols });
+
+  const visited: Pt[] = [];
+  const path: Pt[] = [];
+  const parents = new Map<number, number>();
+
+  const nv = next();
+  for (let i = 0; i < nv; i++) visited.push(pt(next()));
+  const np = next();
+  for (let i = 0; i < np; i++) { const id = next(); parents.set(id, next()); }
+  const pathFrom = dv.getUint8(0) === "D".charCodeAt(0) ? next() : undefined;
+  const nq = next();
+  for (let i = 0; i < nq; i++) path.push(pt(next()));
+  return { visited, path, parents, pathFrom };
+}
+
+async function readPlan(resp: Response, cols: number): Promise<PlanOutput> {
+  if (!resp.ok) throw new Error(`HTTP ${resp.status}`);
+  if ((resp.headers.get("Content-Type") || "").includes(OCTET)) {
+    return parseResultFrame(await resp.arrayBuffer(), cols);
+  }
+  return parseOutput(await resp.text(), cols);
+}
+
+// Sesión de D* Lite de esta pestaña: el backend mantiene un motor (mapa, g/rhs,
+// agente) por sesión, así varias pestañas o agentes no se pisan
+const DSTAR_SESSION =
+  globalThis.crypto?.randomUUID?.() ?? `${Date.now().toString(36)}-${Math.random().toString(36).slice(2)}`;
+
+function post(path: string, body: Body, headers: Record<string, string> = {}) {
+  return fetch(`${API_BASE}${path}`, {
+    method: "POST",
+    headers: { "Content-Type": typeof body === "string" ? "text/plain" : OCTET, ...headers },
+    body,
+  });
+}
+
+const postDStar = (path: string, body: Body) => post(path, body, { "X-Session-Id": DSTAR_SESSION });
+
+// Último plan completo de la sesión: move/update piden ?delta=1 y solo
+// traen lo que cambió, que se aplica aquí en el orden de llegada
+let dstarPlan: PlanOutput = { visited: [], path: [], parents: new Map() };
+
+function applyDStarPlan(out: PlanOutput): PlanOutput {
+  if (out.pathFrom === undefined) {
+    dstarPlan = out;
+  } else {
+    for (const [id, pid] of out.parents) dstarPlan.parents.set(id, pid);
+    dstarPlan = {
+      visited: out.visited,
+      path: out.path.concat(dstarPlan.path.slice(out.pathFrom)),
+      parents: dstarPlan.parents,
+    };
+  }
+  return dstarPlan;
+}
+
 // Parsea salida "Visited/Parents/Path"
 export function parseOutput(
   text: string,
   cols: number
-): { visited: Pt[]; path: Pt[]; parents: Map<number, number> } {
+): PlanOutput {
   const lines = text.trim().split(/\r?\n/);
   const visited: Pt[] = [];
   const path: Pt[] = [];
   const parents = new Map<number, number>();
+  let pathFrom: number | undefined;
 
   let mode: "none" | "visited" | "parents" | "path" = "none";
   for (const ln of lines) {
     if (ln.startsWith("Visited:")) { mode = "visited"; continue; }
     if (ln.startsWith("Parents:")) { mode = "parents"; continue; }
-    if (ln.startsWith("Path:")) { mode = "path"; continue; }
+    if (ln.startsWith("Path:")) {
+      // "Path: k" = respuesta delta (PLAN DELTA)
+      mode = "path";
+      const k = parseInt(ln.slice(5), 10);
+      if (!Number.isNaN(k)) pathFrom = k;
+      continue;
+    }
     const parts = ln.trim().split(/\s+/);
     if (!parts[0]) continue;
 
@@ -55,47 +179,85 @@ export function parseOutput(
       if (!Number.isNaN(r) && !Number.isNaN(c)) path.push({ r, c });
     }
   }
-  return { visited, path, parents };
+  return { visited, path, parents, pathFrom };
 }
 
 // === Fetchers ===
 
-// Dijkstra / A* / BMSSP
-export async function runOneShot(algo: "dijkstra" | "astar" | "bmssp", body: string, cols: number) {
-  const resp = await fetch(`${API_BASE}/api/${algo}`, {
-    method: "POST",
-    headers: { "Content-Type": "text/plain" },
-    body,
-  });
-  if (!resp.ok) throw new Error(`HTTP ${resp.status}`);
-  return parseOutput(await resp.text(), cols);
+// El visualizador dibuja Visited y Path; Parents no se usa, así que no se pide
+// (?verbosity=, ver backend/engines/wire.hpp)
+const VERBOSITY = "verbosity=visited";
+
+// Dijkstra / A* / BMSSP / JPS / HPA* / bidireccionales
+export async function runOneShot(algo: "dijkstra" | "astar" | "bmssp" | "jps" | "hpa" | "bidijkstra" | "biastar", body: Body, cols: number) {
+  return readPlan(await post(`/api/${algo}?${VERBOSITY}`, body), cols);
+}
+
+// Igual que runOneShot pero por Server-Sent Events (?stream=1): las celdas
+// expandidas llegan por lotes mientras el motor busca (onVisited, ids r*cols+c)
+export async function runOneShotStream(
+  algo: "dijkstra" | "astar" | "bmssp" | "jps" | "hpa" | "bidijkstra" | "biastar",
+  body: Body,
+  cols: number,
+  onVisited: (ids: number[]) => void
+): Promise<PlanOutput> {
+  const resp = await post(`/api/${algo}?stream=1&${VERBOSITY}`, body);
+  if (!resp.ok || !resp.body) throw new Error(`HTTP ${resp.status}`);
+  const pt = (id: number): Pt => ({ r: Math.floor(id / cols), c: id % cols });
+  const visited: Pt[] = [];
+  const take = (ids: number[]) => {
+    for (const id of ids) visited.push(pt(id));
+    onVisited(ids);
+  };
+
+  const reader = resp.body.pipeThrough(new TextDecoderStream()).getReader();
+  let buf = "";
+  for (;;) {
+    const { value, done } = await reader.read();
+    if (done) break;
+    buf += value;
+    let sep: number;
+    while ((sep = buf.indexOf("\n\n")) !== -1) {
+      const msg = buf.slice(0, sep);
+      buf = buf.slice(sep + 2);
+      let event = "message", data = "";
+      for (const ln of msg.split("\n")) {
+        if (ln.startsWith("event: ")) event = ln.slice(7);
+        else if (ln.startsWith("data: ")) data += ln.slice(6);
+      }
+      const payload = JSON.parse(data);
+      if (event === "visited") take(payload);
+      else if (event === "error") throw new Error(payload);
+      else if (event === "result") {
+        take(payload.visited);
+        return { visited, path: payload.path.map(pt), parents: new Map(payload.parents) };
+      }
+    }
+  }
+  throw new Error("stream interrumpido");
 }
 
 // D* Lite
-export async function dstarInit(body: string, cols: number) {
-  const resp = await fetch(`${API_BASE}/api/dstar/init`, {
-    method: "POST",
-    headers: { "Content-Type": "text/plain" },
-    body,
-  });
-  if (!resp.ok) throw new Error(`HTTP ${resp.status}`);
-  return parseOutput(await resp.text(), cols);
+export async function dstarInit(body: Body, cols: number) {
+  return applyDStarPlan(await readPlan(await postDStar(`/api/dstar/init?${VERBOSITY}`, body), cols));
 }
 
-export async function dstarMove(r: number, c: number) {
-  await fetch(`${API_BASE}/api/dstar/move`, {
-    method: "POST",
-    headers: { "Content-Type": "text/plain" },
-    body: `${r} ${c}`,
-  });
+export async function dstarMove(r: number, c: number, cols: number) {
+  const body = USE_BINARY ? intsFrame("M", [r, c]) : `${r} ${c}`;
+  return applyDStarPlan(await readPlan(await postDStar(`/api/dstar/move?delta=1&${VERBOSITY}`, body), cols));
 }
 
+// batch: líneas "r c cost" (cost >= 1e9 bloquea)
 export async function dstarUpdate(batch: string, cols: number) {
-  const resp = await fetch(`${API_BASE}/api/dstar/update`, {
-    method: "POST",
-    headers: { "Content-Type": "text/plain" },
-    body: batch,
-  });
-  if (!resp.ok) throw new Error(`HTTP ${resp.status}`);
-  return parseOutput(await resp.text(), cols);
+  let body: Body = batch;
+  if (USE_BINARY) {
+    const triples: number[] = [];
+    for (const ln of batch.split(/\r?\n/)) {
+      const [r, c, cost] = ln.trim().split(/\s+/).map(Number);
+      if (Number.isNaN(r) || Number.isNaN(c)) continue;
+      triples.push(r, c, cost >= 5e8 ? 1 : 0);
+    }
+    body = intsFrame("U", [triples.length / 3, ...triples]);
+  }
+  return applyDStarPlan(await readPlan(await postDStar(`/api/dstar/update?delta=1&${VERBOSITY}`, body), cols));
 }
@@ -2,7 +2,7 @@
 
 export type Cell = 0 | 1;
 export type Pt = { r: number; c: number };
-export type AlgoKey = "dijkstra" | "astar" | "dstar" | "bmssp";
+export type AlgoKey = "dijkstra" | "astar" | "dstar" | "bmssp" | "jps" | "hpa" | "bidijkstra" | "biastar";
 export type EditMode = "toggleObstacle" | "moveStart" | "moveGoal";
 
 export type Layers = {
@@ -31,3 +31,6 @@ export const COLORS = {
 
 // Base de API
 export const API_BASE = import.meta.env.VITE_API_BASE || "http://localhost:4000";
+
+// Protocolo con el backend: "text" (por defecto) o "binary" (frames empaquetados)
+export const USE_BINARY = import.meta.env.VITE_ENGINE_PROTOCOL === "binary";